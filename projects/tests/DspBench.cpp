@@ -0,0 +1,278 @@
+// Times the fixed point primitives the render kernels are built from, next to
+// the alternatives they could use instead, and prints time per operation and
+// worst case error against an exact reference. Timings are for the machine
+// it runs on, so compare numbers from the same machine and build only
+//
+// usage: dsp_bench
+
+#include "Application/Utils/fixed.h"
+#include "HostPlatform.h"
+#include "Services/Audio/AudioMixer.h"
+
+#define DSP_BENCH_SIZE 1024 // operands per pass
+#define DSP_BENCH_PASSES 1024
+
+static int a_[DSP_BENCH_SIZE];
+static int b_[DSP_BENCH_SIZE];
+static int out_[DSP_BENCH_SIZE];
+
+// 32x32->32 multiply for a Q15 value by a gain pre-shifted to Q8. Avoids the
+// 64 bit product (a library call on the M0+) at the cost of the 7 low bits
+// of the gain and 8 low bits of the value
+
+#define MUL_Q8(x, g8) (((x) >> 8) * (g8))
+
+// Every pass computes the same thing, the barrier keeps the compiler from
+// noticing and dropping all but the last one
+
+#define BENCH_LOOP(body)                                                       \
+  {                                                                            \
+    unsigned long start = System::GetInstance()->GetMicros();                  \
+    for (int pass = 0; pass < DSP_BENCH_PASSES; pass++) {                      \
+      for (int i = 0; i < DSP_BENCH_SIZE; i++) {                               \
+        body;                                                                  \
+      }                                                                        \
+      asm volatile("" : : : "memory");                                         \
+    }                                                                          \
+    elapsed = System::GetInstance()->GetMicros() - start;                      \
+  }
+
+#define BENCH_MASK (DSP_BENCH_SIZE - 1)
+
+// a_ holds 16 bit samples in Q15, b_ gains in ]0,1] that also serve as
+// interpolation positions and divisors. Values are pseudo random so
+// runs can be compared
+
+static void fill() {
+  unsigned int seed = 0x1234567;
+  for (int i = 0; i < DSP_BENCH_SIZE; i++) {
+    seed = seed * 1664525 + 1013904223;
+    a_[i] = i2fp(short(seed >> 16));
+    seed = seed * 1664525 + 1013904223;
+    b_[i] = (FP_ONE >> 6) + (seed >> 17) % (FP_ONE - (FP_ONE >> 6));
+  }
+}
+
+static void report(const char *name, unsigned long micros, int maxError) {
+  double ns = micros * 1000.0 / (DSP_BENCH_SIZE * DSP_BENCH_PASSES);
+  printf("%-14s %7.2f ns/op  max error %d\n", name, ns, maxError);
+}
+
+static void benchMul() {
+  unsigned long elapsed;
+  int err;
+
+  BENCH_LOOP(out_[i] = fp_mul(a_[i], b_[i]));
+  report("fp_mul", elapsed, 0);
+
+  BENCH_LOOP(out_[i] = MUL_Q8(a_[i], b_[i] >> 7));
+  err = 0;
+  for (int i = 0; i < DSP_BENCH_SIZE; i++) {
+    int d = out_[i] - fp_mul(a_[i], b_[i]);
+    d = (d < 0) ? -d : d;
+    err = (d > err) ? d : err;
+  }
+  report("mul q8", elapsed, err);
+}
+
+static void benchInterpolation() {
+  unsigned long elapsed;
+  int err;
+
+  // What the linear kernel does today: two products per channel
+
+  BENCH_LOOP(fixed eta = b_[i] & (FP_ONE - 1);
+             out_[i] = fp_mul(a_[i], FP_ONE - eta) +
+                       fp_mul(a_[(i + 1) & BENCH_MASK], eta));
+  err = 0;
+  for (int i = 0; i < DSP_BENCH_SIZE; i++) {
+    fixed eta = b_[i] & (FP_ONE - 1);
+    fixed s1 = a_[i];
+    fixed s2 = a_[(i + 1) & BENCH_MASK];
+    int d = out_[i] - (s1 + fixed(((long long)(s2 - s1) * eta) >> 15));
+    d = (d < 0) ? -d : d;
+    err = (d > err) ? d : err;
+  }
+  report("lerp 2 mul", elapsed, err);
+
+  BENCH_LOOP(fixed s1 = a_[i];
+             out_[i] = s1 + fp_mul(a_[(i + 1) & BENCH_MASK] - s1,
+                                   b_[i] & (FP_ONE - 1)));
+  report("lerp 1 mul", elapsed, 0);
+}
+
+// Inner loop of the sample instrument's filter for one channel
+
+static void benchFilter() {
+  unsigned long elapsed;
+  fixed mix = fl2fp(0.3f);
+  fixed mixInv = FP_ONE - mix;
+  fixed parm1 = fl2fp(0.2f); // cutoff
+  fixed parm2 = fl2fp(0.7f); // resonance
+  fixed speed = 0, height = 0, delay = 0;
+
+  BENCH_LOOP(fixed s = a_[i]; fixed lpin = fp_mul(s, mixInv);
+             fixed hpin = -fp_mul(s, mix); fixed difr = lpin - height;
+             speed = fp_mul(speed, parm2); speed += fp_mul(difr, parm1);
+             height += speed; height += delay - hpin; delay = hpin;
+             out_[i] = height);
+  report("filter", elapsed, 0);
+
+  // Same recursion with the coefficients pre-shifted. Error is measured on
+  // the last pass, as the state carries over
+
+  static int ref[DSP_BENCH_SIZE];
+  memcpy(ref, out_, DSP_BENCH_SIZE * sizeof(int));
+
+  int mix8 = mix >> 7, mixInv8 = mixInv >> 7;
+  int parm18 = parm1 >> 7, parm28 = parm2 >> 7;
+  speed = height = delay = 0;
+  BENCH_LOOP(fixed s = a_[i]; fixed lpin = MUL_Q8(s, mixInv8);
+             fixed hpin = -MUL_Q8(s, mix8); fixed difr = lpin - height;
+             speed = MUL_Q8(speed, parm28); speed += MUL_Q8(difr, parm18);
+             height += speed; height += delay - hpin; delay = hpin;
+             out_[i] = height);
+  int err = 0;
+  for (int i = 0; i < DSP_BENCH_SIZE; i++) {
+    int d = out_[i] - ref[i];
+    d = (d < 0) ? -d : d;
+    err = (d > err) ? d : err;
+  }
+  report("filter q8", elapsed, err);
+}
+
+static void benchCrush() {
+  unsigned long elapsed;
+  int drive = 0xC0;
+  fixed mask = 0xFFFFFFFF << (FIXED_SHIFT + 16 - 8); // crush 8
+  fixed fpdrive = fl2fp(drive / 255.0F);
+
+  BENCH_LOOP(out_[i] = fp_mul(a_[i], fpdrive) & mask);
+  report("crush", elapsed, 0);
+
+  // The drive is already an 8 bit value
+
+  BENCH_LOOP(out_[i] = MUL_Q8(a_[i], drive) & mask);
+  int err = 0;
+  for (int i = 0; i < DSP_BENCH_SIZE; i++) {
+    int d = out_[i] - (fp_mul(a_[i], fpdrive) & mask);
+    d = (d < 0) ? -d : d;
+    err = (d > err) ? d : err;
+  }
+  report("crush q8", elapsed, err);
+}
+
+static void benchPan() {
+  unsigned long elapsed;
+  fixed panl = fl2fp(0.8f);
+  fixed panr = fl2fp(0.6f);
+
+  // Left and right land in neighbouring slots like in an interleaved buffer
+
+  BENCH_LOOP(out_[i] = fp_mul(a_[i], panl);
+             out_[i ^ 1] = fp_mul(a_[i], panr));
+  report("pan", elapsed, 0);
+
+  int panl8 = panl >> 7, panr8 = panr >> 7;
+  BENCH_LOOP(out_[i] = MUL_Q8(a_[i], panl8);
+             out_[i ^ 1] = MUL_Q8(a_[i], panr8));
+  report("pan q8", elapsed, 0);
+}
+
+// x/y in Q15. On the pico the 32 bit division in fp_div goes to the SIO
+// hardware divider through the SDK's division wrappers, which this doesn't
+// show
+
+static void benchDiv() {
+  unsigned long elapsed;
+  int err;
+
+  // 1/m for m in [128,255] with 24 fractional bits
+
+  int recip[128];
+  for (int m = 0; m < 128; m++) {
+    recip[m] = (1 << 24) / (m + 128);
+  }
+
+  // Dividends are kept small enough for fp_div's shifts not to overflow
+
+  BENCH_LOOP(out_[i] = fixed(((long long)(a_[i] >> 8) << FIXED_SHIFT) / b_[i]));
+  report("div 64", elapsed, 0);
+
+  BENCH_LOOP(out_[i] = fp_div(a_[i] >> 8, b_[i]));
+  err = 0;
+  for (int i = 0; i < DSP_BENCH_SIZE; i++) {
+    int d = out_[i] - fixed(((long long)(a_[i] >> 8) << FIXED_SHIFT) / b_[i]);
+    d = (d < 0) ? -d : d;
+    err = (d > err) ? d : err;
+  }
+  report("fp_div", elapsed, err);
+
+  // Normalise the divisor to 8 bits and multiply by its reciprocal
+
+  BENCH_LOOP(int s = 24 - __builtin_clz(b_[i]);
+             int m = b_[i] >> s; out_[i] = fixed(
+                 ((long long)(a_[i] >> 8) * recip[m - 128]) >> (9 + s)));
+  err = 0;
+  for (int i = 0; i < DSP_BENCH_SIZE; i++) {
+    int d = out_[i] - fixed(((long long)(a_[i] >> 8) << FIXED_SHIFT) / b_[i]);
+    d = (d < 0) ? -d : d;
+    err = (d > err) ? d : err;
+  }
+  report("div recip", elapsed, err);
+}
+
+// Mixer output stage with level metering off and on. The source hands out
+// the samples as a render would, the volume is below unity so both paths do
+// a pass over the buffer and the difference is what metering costs
+
+#define MIX_FRAMES 128
+#define MIX_BUFFERS 256
+
+class BenchSource : public AudioModule {
+public:
+  virtual bool Render(fixed *buffer, int samplecount) {
+    memcpy(buffer, a_, samplecount * 2 * sizeof(fixed));
+    return true;
+  };
+};
+
+static unsigned long benchMixer(AudioMixer &mixer, bool metering) {
+  static fixed buffer[MIX_FRAMES * 2];
+  AudioMixer::EnableMetering(metering);
+  unsigned long start = System::GetInstance()->GetMicros();
+  for (int i = 0; i < MIX_BUFFERS; i++) {
+    mixer.Render(buffer, MIX_FRAMES);
+  }
+  return System::GetInstance()->GetMicros() - start;
+}
+
+static void benchMetering() {
+  BenchSource source;
+  AudioMixer mixer("bench");
+  mixer.Insert(source);
+  mixer.SetVolume(fl2fp(0.7f));
+
+  unsigned long off = benchMixer(mixer, false);
+  unsigned long on = benchMixer(mixer, true);
+  AudioMixer::EnableMetering(false);
+
+  double frames = MIX_FRAMES * MIX_BUFFERS;
+  printf("%-14s %7.2f ns/frame\n", "mix", off * 1000.0 / frames);
+  printf("%-14s %7.2f ns/frame  peak %d rms %d\n", "mix metered",
+         on * 1000.0 / frames, mixer.GetPeak(0), mixer.GetRms(0));
+}
+
+int main(int argc, char **argv) {
+  InstallHostPlatform();
+  fill();
+  printf("%d ops x %d passes\n", DSP_BENCH_SIZE, DSP_BENCH_PASSES);
+  benchMul();
+  benchInterpolation();
+  benchFilter();
+  benchCrush();
+  benchPan();
+  benchDiv();
+  benchMetering();
+  return 0;
+}
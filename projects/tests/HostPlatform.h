@@ -0,0 +1,65 @@
+#ifndef _HOST_PLATFORM_H_
+#define _HOST_PLATFORM_H_
+
+// Minimal headless platform shared by the host checks and benches
+
+#include "Adapters/Unix/FileSystem/UnixFileSystem.h"
+#include "Services/Audio/Audio.h"
+#include "System/Console/Trace.h"
+#include "System/System/System.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+class HostSystem : public System {
+public:
+  virtual unsigned long GetClock() { return GetMicros() / 1000; };
+  virtual unsigned long GetMicros() {
+    return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  };
+  virtual int GetBatteryLevel() { return -1; };
+  virtual void *Malloc(unsigned size) { return malloc(size); };
+  virtual void Free(void *ptr) { free(ptr); };
+  virtual void Memset(void *addr, char value, int size) {
+    memset(addr, value, size);
+  };
+  virtual void *Memcpy(void *s1, const void *s2, int n) {
+    return memcpy(s1, s2, n);
+  };
+  virtual void PostQuitMessage(){};
+  virtual unsigned int GetMemoryUsage() { return 0; };
+};
+
+class HostAudio : public Audio {
+public:
+  HostAudio(AudioSettings &settings) : Audio(settings){};
+  virtual void Init(){};
+  virtual void Close(){};
+};
+
+class QuietLogger : public Trace::Logger {
+public:
+  virtual void AddLine(const char *line) {
+    if (strstr(line, "*ERROR*")) {
+      fprintf(stderr, "%s\n", line);
+    }
+  };
+};
+
+// Installs the platform services. The logger goes first so nothing logged
+// while the others start ends up on stdout
+
+inline void InstallHostPlatform() {
+  Trace::GetInstance()->SetLogger(*(new QuietLogger()));
+  System::Install(new HostSystem());
+  FileSystem::Install(new UnixFileSystem());
+  AudioSettings settings;
+  settings.bufferSize_ = 0;
+  settings.preBufferCount_ = 0;
+  Audio::Install(new HostAudio(settings));
+}
+
+#endif
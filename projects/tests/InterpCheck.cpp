@@ -0,0 +1,135 @@
+// Checks the software model of the SIO interpolators, set up the way the
+// USE_INTERPOLATOR render loop in SampleInstrument sets them up, against the
+// plain fixed point code it replaces:
+//
+// - interp1 stepping must give the same sample steps and fractions as
+//   fp_add/fp2i/fp_sub, including when the speed changes on the way
+// - interp0 blending must stay within |next - current| / 256 of the two
+//   fp_mul linear interpolation, plus the truncation of the 8 bit blend
+//
+// usage: interp_check
+
+#include "Application/Utils/fixed.h"
+#include "Application/Utils/interp.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define STEP_COUNT 1000000
+#define BLEND_COUNT 1000000
+
+static unsigned int seed = 12345;
+
+static unsigned int nextRandom() {
+  seed = seed * 1664525 + 1013904223;
+  return seed >> 8;
+}
+
+// A playback speed up to 8 samples per output sample, either direction
+
+static fixed randomSpeed() {
+  fixed speed = fixed(nextRandom() % (8 * FP_ONE)) + 1;
+  return (nextRandom() & 1) ? -speed : speed;
+}
+
+static void setupStepper(fixed fpPos, fixed fpSpeed) {
+  interp_config cfg = interp_default_config();
+  interp_config_set_mask(&cfg, 0, FIXED_SHIFT - 1);
+  interp_set_config(interp1, 0, &cfg);
+  cfg = interp_default_config();
+  interp_config_set_cross_input(&cfg, true);
+  interp_config_set_shift(&cfg, FIXED_SHIFT);
+  interp_config_set_mask(&cfg, 0, 31 - FIXED_SHIFT);
+  interp_config_set_signed(&cfg, true);
+  interp_set_config(interp1, 1, &cfg);
+  interp_set_base(interp1, 0, fpSpeed);
+  interp_set_base(interp1, 1, 0);
+  interp_set_accumulator(interp1, 0, fpPos + fpSpeed);
+}
+
+static void setupBlender() {
+  interp_config cfg = interp_default_config();
+  interp_config_set_blend(&cfg, true);
+  interp_set_config(interp0, 0, &cfg);
+  cfg = interp_default_config();
+  interp_config_set_shift(&cfg, FIXED_SHIFT - 8);
+  interp_config_set_mask(&cfg, 0, 7);
+  interp_config_set_signed(&cfg, true);
+  interp_set_config(interp0, 1, &cfg);
+}
+
+static int checkSteps() {
+  fixed fpSpeed = randomSpeed();
+  fixed interpSpeed = fpSpeed;
+  fixed fpPos = 0;
+  setupStepper(fpPos, fpSpeed);
+
+  for (int i = 0; i < STEP_COUNT; i++) {
+
+    // Change the speed now and then, like loops and k-rate updates do
+
+    if ((nextRandom() & 0xFF) == 0) {
+      fpSpeed = randomSpeed();
+      fixed position = interp_get_accumulator(interp1, 0) - interpSpeed;
+      interp_set_base(interp1, 0, fpSpeed);
+      interp_set_accumulator(interp1, 0, position + fpSpeed);
+      interpSpeed = fpSpeed;
+    }
+
+    fixed interpPos = interp_get_accumulator(interp1, 0) - fpSpeed;
+    int interpDelta = int(interp_pop_lane_result(interp1, 1));
+
+    fixed expectedPos = fpPos;
+    fpPos = fp_add(fpPos, fpSpeed);
+    int delta = fp2i(fpPos);
+    fpPos = fp_sub(fpPos, i2fp(delta));
+
+    if ((interpPos != expectedPos) || (interpDelta != delta)) {
+      fprintf(stderr,
+              "step %d, speed %d: position %d step %d, expected %d step %d\n",
+              i, fpSpeed, interpPos, interpDelta, expectedPos, delta);
+      return 1;
+    }
+  }
+  printf("steps: %d match\n", STEP_COUNT);
+  return 0;
+}
+
+static int checkBlend() {
+  setupBlender();
+  long long worst = 0;
+
+  for (int i = 0; i < BLEND_COUNT; i++) {
+    fixed s1 = i2fp(short(nextRandom()));
+    fixed s2 = i2fp(short(nextRandom()));
+    fixed fpPos = fixed(nextRandom() % FP_ONE);
+
+    interp_set_accumulator(interp0, 1, fpPos);
+    interp_set_base(interp0, 0, s1 >> 8);
+    interp_set_base(interp0, 1, s2 >> 8);
+    fixed blend = fixed(interp_peek_lane_result(interp0, 1)) << 8;
+
+    fixed lerp = fp_mul(s1, fp_sub(FP_ONE, fpPos)) + fp_mul(s2, fpPos);
+
+    // The blend drops the 7 low bits of the position and truncates its
+    // result to 7 fractional bits, fp_mul truncates twice
+
+    long long error = llabs((long long)blend - lerp);
+    long long bound = llabs((long long)s2 - s1) / 256 + 256 + 2;
+    if (error > bound) {
+      fprintf(stderr, "blend %d/%d at %d: %d, expected %d\n", s1, s2, fpPos,
+              blend, lerp);
+      return 1;
+    }
+    if (error > worst) {
+      worst = error;
+    }
+  }
+  printf("blend: %d within bound, worst error %lld\n", BLEND_COUNT, worst);
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  int failures = checkSteps();
+  failures += checkBlend();
+  return failures ? 1 : 0;
+}
@@ -0,0 +1,448 @@
+// Renders a fixed set of sample instrument scenarios and compares the
+// checksum of each render with the one stored in the expected file. Every
+// loop mode, interpolation and instrument command gets its own scenario so a
+// change in the render path shows up as the scenario it broke. The last
+// scenario plays through the mixer service, so buses, sends and metering are
+// covered too. Each scenario's render time is printed next to its result.
+//
+// usage: render_check <expected file> [--update] [--keep]
+//                     [--tolerance <n> <reference dir>]
+//
+// With --update the expected file is rewritten with the current checksums.
+// Renders go to a work directory that is removed at the end, --keep leaves
+// it there. With --tolerance, a scenario whose checksum changed still passes
+// if no sample is more than n away from the same render in the reference
+// directory, for instance the work directory kept from a previous build
+
+#include "Application/Instruments/CommandList.h"
+#include "Application/Instruments/SampleInstrument.h"
+#include "Application/Instruments/SamplePool.h"
+#include "Application/Instruments/WavFileWriter.h"
+#include "Application/Mixer/MixerService.h"
+#include "Application/Player/PlayerChannel.h"
+#include "Application/Player/SyncMaster.h"
+#include "HostPlatform.h"
+#include "Services/Audio/AudioDriver.h"
+#include <filesystem>
+#include <map>
+#include <string>
+
+// Output the mixer service renders into, a buffer per trigger, copied to
+// the writer of the scenario being rendered
+
+class HostAudioOut : public AudioOut {
+public:
+  HostAudioOut() : writer_(0), sampleCount_(0) { SetOwnership(false); };
+  virtual bool Init() { return true; };
+  virtual void Close(){};
+  virtual bool Start() { return true; };
+  virtual void Stop(){};
+  virtual void Trigger() {
+    sampleCount_ = getPlaySampleCount();
+    if (!AudioMixer::Render(buffer_, sampleCount_)) {
+      memset(buffer_, 0, sampleCount_ * 2 * sizeof(fixed));
+    }
+    if (writer_) {
+      writer_->AddBuffer(buffer_, sampleCount_);
+    }
+  };
+  virtual int GetSampleCount() { return sampleCount_; };
+  virtual bool Clipped() { return false; };
+  virtual int GetPlayedBufferPercentage() { return 0; };
+  virtual std::string GetAudioAPI() { return "Host"; };
+  virtual std::string GetAudioDevice() { return "Host"; };
+  virtual int GetAudioBufferSize() { return 0; };
+  virtual int GetAudioRequestedBufferSize() { return 0; };
+  virtual int GetAudioPreBufferCount() { return 0; };
+  virtual double GetStreamTime() { return 0; };
+
+  void SetWriter(WavFileWriter *writer) { writer_ = writer; };
+
+private:
+  WavFileWriter *writer_;
+  int sampleCount_;
+  fixed buffer_[MAX_SAMPLE_COUNT * 2];
+};
+
+// Test samples. Integer only so they come out the same everywhere
+
+#define SAMPLE_FRAMES 8820
+
+static void writeSample(const char *path, int channelCount) {
+  short *data = new short[SAMPLE_FRAMES * channelCount];
+  unsigned int random = 12345;
+  for (int i = 0; i < SAMPLE_FRAMES; i++) {
+    int decay = SAMPLE_FRAMES - i;
+    for (int c = 0; c < channelCount; c++) {
+      int period = 100 + 37 * c;
+      int phase = i % period;
+      int triangle = (phase < period / 2) ? phase : period - phase;
+      triangle = triangle * 4 * 16000 / period - 16000;
+      random = random * 1664525 + 1013904223;
+      int noise = int(random >> 20) - 2048;
+      data[i * channelCount + c] =
+          short((triangle + noise) * (long long)decay / SAMPLE_FRAMES);
+    }
+  }
+  WavFileWriter writer(path, channelCount);
+  writer.AddBuffer(data, SAMPLE_FRAMES);
+  writer.Close();
+  delete[] data;
+}
+
+// Scenarios. Filter state carries over from one voice to the next like it
+// does in the player, so new scenarios go at the end. Commands are sent
+// before the slice they're scheduled on, and the note can be started again
+// there without a clean start, like a note with no instrument number does.
+// Slices count from 1 so that unused (zeroed) commands never go out
+
+#define SLICE_COUNT 48
+#define MAX_COMMANDS 4
+
+struct Command {
+  int slice;
+  FourCC cc;
+  ushort value;
+};
+
+struct Scenario {
+  const char *name;
+  int sample; // 0 mono, 1 stereo
+  int loopMode;
+  int interpolation;
+  int note;
+  Command commands[MAX_COMMANDS];
+  int retrigger; // slice the note starts again on, 0 for none
+};
+
+static const Scenario scenarios[] = {
+    {"oneshot_linear", 0, SILM_ONESHOT, SIIP_LINEAR, 67},
+    {"oneshot_none", 0, SILM_ONESHOT, SIIP_NONE, 67},
+    {"oneshot_cubic", 0, SILM_ONESHOT, SIIP_CUBIC, 67},
+    {"oneshot_sinc", 0, SILM_ONESHOT, SIIP_SINC, 67},
+    {"oneshot_stereo", 1, SILM_ONESHOT, SIIP_LINEAR, 55},
+    {"loop", 0, SILM_LOOP, SIIP_LINEAR, 60},
+    {"loop_stereo", 1, SILM_LOOP, SIIP_LINEAR, 64},
+    {"osc", 0, SILM_OSC, SIIP_LINEAR, 48},
+    {"loopsync", 0, SILM_LOOPSYNC, SIIP_LINEAR, 60},
+    {"cmd_lpof", 0, SILM_LOOP, SIIP_LINEAR, 60, {{13, I_CMD_LPOF, 0x0100}}},
+    {"cmd_plof", 0, SILM_ONESHOT, SIIP_LINEAR, 60, {{7, I_CMD_PLOF, 0x4000}}},
+    {"cmd_arpg", 0, SILM_LOOP, SIIP_LINEAR, 60, {{1, I_CMD_ARPG, 0x0370}}},
+    {"cmd_volm", 0, SILM_LOOP, SIIP_LINEAR, 60, {{7, I_CMD_VOLM, 0x1010}}},
+    {"cmd_pan", 1, SILM_LOOP, SIIP_LINEAR, 60, {{7, I_CMD_PAN_, 0x10F0}}},
+    {"cmd_fcut",
+     0,
+     SILM_LOOP,
+     SIIP_LINEAR,
+     60,
+     {{1, I_CMD_FLTR, 0xFF80}, {7, I_CMD_FCUT, 0x1020}}},
+    {"cmd_fres",
+     0,
+     SILM_LOOP,
+     SIIP_LINEAR,
+     60,
+     {{1, I_CMD_FLTR, 0x60FF}, {7, I_CMD_FRES, 0x10C0}}},
+    {"cmd_ptch", 0, SILM_LOOP, SIIP_LINEAR, 60, {{7, I_CMD_PTCH, 0x200C}}},
+    {"cmd_lega",
+     0,
+     SILM_LOOP,
+     SIIP_LINEAR,
+     60,
+     {{7, I_CMD_LEGA, 0x10F4}, {25, I_CMD_LEGA, 0x0000}}},
+    {"cmd_pfin", 0, SILM_LOOP, SIIP_LINEAR, 60, {{7, I_CMD_PFIN, 0x1040}}},
+    {"cmd_envl",
+     0,
+     SILM_LOOP,
+     SIIP_LINEAR,
+     60,
+     {{1, I_CMD_ENVL, 0x24A6}, {31, I_CMD_ENVL, 0x0000}}},
+    {"cmd_lfo_volume", 0, SILM_LOOP, SIIP_LINEAR, 60, {{1, I_CMD_LFO, 0x0808}}},
+    {"cmd_lfo_cutoff",
+     0,
+     SILM_LOOP,
+     SIIP_LINEAR,
+     60,
+     {{1, I_CMD_FLTR, 0x8060}, {1, I_CMD_LFO, 0x5F10}}},
+    {"cmd_lfo_pan", 1, SILM_LOOP, SIIP_LINEAR, 60, {{1, I_CMD_LFO, 0xAC06}}},
+    {"cmd_lfo_pitch", 0, SILM_LOOP, SIIP_CUBIC, 60, {{1, I_CMD_LFO, 0xF40C}}},
+    {"cmd_rtrg", 0, SILM_ONESHOT, SIIP_LINEAR, 60, {{1, I_CMD_RTRG, 0x0203}}},
+    {"cmd_fltr", 0, SILM_LOOP, SIIP_LINEAR, 60, {{7, I_CMD_FLTR, 0x40C0}}},
+    {"cmd_crsh", 0, SILM_LOOP, SIIP_LINEAR, 60, {{7, I_CMD_CRSH, 0x8004}}},
+    {"cmd_envl_retrigger",
+     0,
+     SILM_LOOP,
+     SIIP_LINEAR,
+     60,
+     {{1, I_CMD_ENVL, 0x1101}, {7, I_CMD_ENVL, 0x0000}},
+     13},
+    {"cmd_emod_cutoff",
+     0,
+     SILM_LOOP,
+     SIIP_LINEAR,
+     60,
+     {{1, I_CMD_FLTR, 0x2060},
+      {1, I_CMD_EMOD, 0x0000},
+      {1, I_CMD_EMOD, 0x1060},
+      {1, I_CMD_ENVL, 0x0680}}},
+    {"cmd_emod_pitch",
+     0,
+     SILM_LOOP,
+     SIIP_LINEAR,
+     60,
+     {{1, I_CMD_EMOD, 0x30C0}, {1, I_CMD_ENVL, 0x08F0}}},
+};
+
+#define SCENARIO_COUNT int(sizeof(scenarios) / sizeof(scenarios[0]))
+
+static void render(const Scenario &scenario, WavFileWriter &writer) {
+
+  SampleInstrument instrument;
+  instrument.FindVariable(SIP_SAMPLE)->SetInt(scenario.sample);
+  instrument.FindVariable(SIP_LOOPMODE)->SetInt(scenario.loopMode);
+  instrument.FindVariable(SIP_INTERPOLATION)->SetInt(scenario.interpolation);
+  instrument.FindVariable(SIP_LOOPSTART)->SetInt(1000);
+  instrument.FindVariable(SIP_END)->SetInt(5000);
+  instrument.Init();
+
+  SyncMaster *sync = SyncMaster::GetInstance();
+  sync->SetTempo(138);
+  sync->Start();
+
+  static fixed buffer[MAX_SAMPLE_COUNT * 2];
+  instrument.Start(0, scenario.note);
+  for (int slice = 0; slice < SLICE_COUNT; slice++) {
+    for (int i = 0; i < MAX_COMMANDS; i++) {
+      const Command &command = scenario.commands[i];
+      if (command.slice == slice + 1) {
+        instrument.ProcessCommand(0, command.cc, command.value);
+      }
+    }
+    if (scenario.retrigger == slice + 1) {
+      instrument.Start(0, scenario.note, false);
+    }
+    int count = int(sync->GetPlaySampleCount());
+    if (!instrument.Render(0, buffer, count, sync->TableSlice())) {
+      memset(buffer, 0, count * 2 * sizeof(fixed));
+    }
+    writer.AddBuffer(buffer, count);
+    sync->NextSlice();
+  }
+  instrument.Stop(0);
+}
+
+// Two channels on their own bus through the mixer service, the second one
+// sending to the delay and reverb and stopping halfway so the tails play
+// out, with metering on as it is on the mixer screen
+
+#define MIXER_SCENARIO "mixer_buses_send"
+
+static void renderMixer(HostAudioOut &out, WavFileWriter &writer) {
+
+  SampleInstrument lead;
+  lead.FindVariable(SIP_SAMPLE)->SetInt(0);
+  lead.FindVariable(SIP_LOOPMODE)->SetInt(SILM_LOOP);
+  lead.FindVariable(SIP_LOOPSTART)->SetInt(1000);
+  lead.FindVariable(SIP_END)->SetInt(5000);
+  lead.Init();
+  SampleInstrument stab;
+  stab.FindVariable(SIP_SAMPLE)->SetInt(1);
+  stab.Init();
+
+  MixerService *ms = MixerService::GetInstance();
+  ms->SetMasterVolume(80);
+  SyncMaster *sync = SyncMaster::GetInstance();
+  sync->SetTempo(138);
+  sync->Start();
+  int slice = int(sync->GetPlaySampleCount());
+  ms->GetSendFx()->SetParameters(3 * slice, 0x80, 0x60);
+
+  PlayerChannel lower(0);
+  PlayerChannel upper(1);
+  lower.SetMixBus(0);
+  upper.SetMixBus(1);
+  upper.SetSend(0x80);
+  AudioMixer::EnableMetering(true);
+
+  out.SetWriter(&writer);
+  lower.StartInstrument(&lead, 48, true);
+  upper.StartInstrument(&stab, 67, true);
+  AudioDriver::Event event(AudioDriver::Event::ADET_BUFFERNEEDED);
+  for (int i = 0; i < SLICE_COUNT; i++) {
+    if (i == SLICE_COUNT / 2) {
+      upper.StopInstrument();
+    }
+    PlayerChannel::StartSlice();
+    ms->Update(out, &event);
+    sync->NextSlice();
+  }
+  out.SetWriter(0);
+
+  AudioMixer::EnableMetering(false);
+  lower.StopInstrument();
+  lower.Reset();
+  upper.Reset();
+}
+
+static std::map<std::string, unsigned int> readExpected(const char *path) {
+  std::map<std::string, unsigned int> expected;
+  I_File *file = FileSystem::GetInstance()->Open(path, "r");
+  if (!file) {
+    return expected;
+  }
+  std::string line;
+  int c;
+  do {
+    c = file->GetC();
+    if ((c != '\n') && (c != EOF)) {
+      line += char(c);
+      continue;
+    }
+    char name[128];
+    unsigned int checksum;
+    if ((line[0] != '#') &&
+        (sscanf(line.c_str(), "%127s %x", name, &checksum) == 2)) {
+      expected[name] = checksum;
+    }
+    line.clear();
+  } while (c != EOF);
+  file->Close();
+  delete file;
+  return expected;
+}
+
+// Compares a finished render with the expected checksum, or with the
+// reference render when there is a tolerance. Returns true when it passes
+
+static bool check(const char *name, WavFileWriter &writer,
+                  std::map<std::string, unsigned int> &expected, int tolerance,
+                  unsigned long micros) {
+  unsigned int checksum = writer.GetChecksum();
+  std::map<std::string, unsigned int>::iterator it = expected.find(name);
+  if ((it != expected.end()) && (it->second == checksum)) {
+    printf("ok      %-20s %08X %8lu us\n", name, checksum, micros);
+    return true;
+  }
+  if ((tolerance >= 0) && writer.HasReference() &&
+      (writer.GetMaxDifference() <= tolerance)) {
+    printf("close   %-20s %08X %8lu us, max difference %d\n", name, checksum,
+           micros, writer.GetMaxDifference());
+    return true;
+  }
+  if (it == expected.end()) {
+    printf("MISSING %-20s %08X %8lu us\n", name, checksum, micros);
+  } else {
+    printf("FAIL    %-20s %08X %8lu us, expected %08X\n", name, checksum,
+           micros, it->second);
+  }
+  if ((tolerance >= 0) && writer.HasReference()) {
+    printf("        max difference %d > %d\n", writer.GetMaxDifference(),
+           tolerance);
+  }
+  return false;
+}
+
+int main(int argc, char **argv) {
+
+  const char *expectedPath = 0;
+  const char *referenceDir = 0;
+  bool update = false;
+  bool keep = false;
+  int tolerance = -1;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--update")) {
+      update = true;
+    } else if (!strcmp(argv[i], "--keep")) {
+      keep = true;
+    } else if (!strcmp(argv[i], "--tolerance") && (i + 2 < argc)) {
+      tolerance = atoi(argv[++i]);
+      referenceDir = argv[++i];
+    } else if (!expectedPath && (argv[i][0] != '-')) {
+      expectedPath = argv[i];
+    } else {
+      expectedPath = 0;
+      break;
+    }
+  }
+  if (!expectedPath) {
+    fprintf(stderr,
+            "usage: %s <expected file> [--update] [--keep] "
+            "[--tolerance <n> <reference dir>]\n",
+            argv[0]);
+    return 2;
+  }
+
+  InstallHostPlatform();
+  HostAudioOut out;
+  Audio::GetInstance()->Insert(out);
+
+  char workDir[] = "/tmp/render_check.XXXXXX";
+  if (!mkdtemp(workDir)) {
+    perror("mkdtemp");
+    return 2;
+  }
+  if (keep) {
+    printf("Rendering in %s\n", workDir);
+  }
+  Path::SetAlias("bin", workDir);
+  Path::SetAlias("root", workDir);
+  Path::SetAlias("samples", workDir);
+
+  std::string dir = workDir;
+  writeSample((dir + "/a_mono.wav").c_str(), 1);
+  writeSample((dir + "/b_stereo.wav").c_str(), 2);
+  SamplePool::GetInstance()->Load();
+  MixerService::GetInstance()->Init();
+
+  std::map<std::string, unsigned int> expected = readExpected(expectedPath);
+
+  I_File *expectedOut = 0;
+  if (update) {
+    expectedOut = FileSystem::GetInstance()->Open(expectedPath, "w");
+    if (!expectedOut) {
+      fprintf(stderr, "Can't write %s\n", expectedPath);
+      return 2;
+    }
+    expectedOut->Printf("# Checksums of the render_check scenarios, "
+                        "regenerate with render_check <this file> --update\n");
+  }
+
+  int failures = 0;
+  int count = SCENARIO_COUNT + 1;
+  System *system = System::GetInstance();
+  for (int i = 0; i < count; i++) {
+    const char *name = (i < SCENARIO_COUNT) ? scenarios[i].name
+                                            : MIXER_SCENARIO;
+    std::string file = std::string("/") + name + ".wav";
+    WavFileWriter writer((dir + file).c_str());
+    if (referenceDir) {
+      writer.SetReference((referenceDir + file).c_str());
+    }
+    unsigned long start = system->GetMicros();
+    if (i < SCENARIO_COUNT) {
+      render(scenarios[i], writer);
+    } else {
+      renderMixer(out, writer);
+    }
+    unsigned long micros = system->GetMicros() - start;
+    writer.Close();
+    if (expectedOut) {
+      expectedOut->Printf("%s %08X\n", name, writer.GetChecksum());
+    } else if (!check(name, writer, expected, tolerance, micros)) {
+      failures++;
+    }
+  }
+
+  MixerService::GetInstance()->Close();
+  if (!keep) {
+    std::filesystem::remove_all(workDir);
+  }
+
+  if (expectedOut) {
+    expectedOut->Close();
+    delete expectedOut;
+    printf("Wrote %d checksums to %s\n", count, expectedPath);
+    return 0;
+  }
+  printf("%d/%d scenarios match\n", count - failures, count);
+  return (failures == 0) ? 0 : 1;
+}
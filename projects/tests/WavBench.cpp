@@ -0,0 +1,242 @@
+// Measures the two halves of a sample load: reading the file the way the
+// flash loader does, a flash page worth of frames per seek and read through
+// the FileSystem, and converting the formats that have to be reduced to 16
+// bit. Conversion is done a read buffer at a time like the loaders do, and
+// the result is checked against the 16 bit source. The files are read right
+// after being written, so the read figures are for the file layer on a warm
+// cache rather than for the storage itself.
+//
+// usage: wav_bench
+
+#include "Application/Instruments/WavFile.h"
+#include "HostPlatform.h"
+#include <math.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#define SAMPLE_FRAMES (44100 * 4)
+#define CHANNEL_COUNT 2
+#define CHUNK_SIZE 512 // the loaders' read buffer
+#define PAGE_SIZE 256  // flash page, what the flash loader reads at a time
+#define PASS_COUNT 5
+
+struct Format {
+  const char *name;
+  int bytePerSample;
+  bool isFloat;
+};
+
+static const Format formats[] = {
+    {"16 bit", 2, false},
+    {"24 bit", 3, false},
+    {"32 bit", 4, false},
+    {"float", 4, true},
+};
+
+#define FORMAT_COUNT int(sizeof(formats) / sizeof(formats[0]))
+
+static std::vector<short> source;
+
+static void makeSource() {
+  unsigned int random = 12345;
+  source.resize(SAMPLE_FRAMES * CHANNEL_COUNT);
+  for (unsigned int i = 0; i < source.size(); i++) {
+    random = random * 1664525 + 1013904223;
+    int noise = int(random >> 20) - 2048;
+    source[i] = short(20000 * sin(i * 0.01) + noise);
+  }
+}
+
+// Encodes the source in the given format, little endian like a wav file
+
+static std::vector<unsigned char> encode(const Format &format) {
+  std::vector<unsigned char> data;
+  for (unsigned int i = 0; i < source.size(); i++) {
+    int value = source[i];
+    if (format.isFloat) {
+      float f = value / 32768.0f;
+      memcpy(&value, &f, 4);
+    } else {
+      value <<= 8 * (format.bytePerSample - 2);
+    }
+    for (int b = 0; b < format.bytePerSample; b++) {
+      data.push_back((unsigned char)(value >> (8 * b)));
+    }
+  }
+  return data;
+}
+
+#define WAV_HEADER_SIZE 44
+
+static void writeWord(FILE *file, unsigned int value, int size) {
+  for (int b = 0; b < size; b++) {
+    fputc((value >> (8 * b)) & 0xFF, file);
+  }
+}
+
+static bool writeWav(const char *path, const Format &format,
+                     const std::vector<unsigned char> &data) {
+  FILE *file = fopen(path, "wb");
+  if (!file) {
+    return false;
+  }
+  int blockAlign = CHANNEL_COUNT * format.bytePerSample;
+  fwrite("RIFF", 4, 1, file);
+  writeWord(file, WAV_HEADER_SIZE - 8 + data.size(), 4);
+  fwrite("WAVEfmt ", 8, 1, file);
+  writeWord(file, 16, 4);
+  writeWord(file, format.isFloat ? WAVE_FORMAT_IEEE_FLOAT : WAVE_FORMAT_PCM,
+            2);
+  writeWord(file, CHANNEL_COUNT, 2);
+  writeWord(file, 44100, 4);
+  writeWord(file, 44100 * blockAlign, 4);
+  writeWord(file, blockAlign, 2);
+  writeWord(file, 8 * format.bytePerSample, 2);
+  fwrite("data", 4, 1, file);
+  writeWord(file, data.size(), 4);
+  fwrite(&data[0], data.size(), 1, file);
+  fclose(file);
+  return true;
+}
+
+// Dither may move a reduced sample by one step either way
+
+static bool matchesSource(const short *converted, const char *what) {
+  for (unsigned int i = 0; i < source.size(); i++) {
+    if (abs(converted[i] - source[i]) > 1) {
+      fprintf(stderr, "%s: sample %u is %d, expected %d\n", what, i,
+              converted[i], source[i]);
+      return false;
+    }
+  }
+  return true;
+}
+
+static unsigned long bestReadTime(const char *path, const Format &format) {
+  System *system = System::GetInstance();
+  FileSystem *fs = FileSystem::GetInstance();
+  int frameSize = CHANNEL_COUNT * format.bytePerSample;
+  int pageFrames = PAGE_SIZE / (2 * CHANNEL_COUNT);
+  unsigned char chunk[CHUNK_SIZE];
+  unsigned long best = 0;
+  for (int pass = 0; pass < PASS_COUNT; pass++) {
+    I_File *file = fs->Open(path, "r");
+    if (!file) {
+      return 0;
+    }
+    unsigned long start = system->GetMicros();
+    for (int frame = 0; frame < SAMPLE_FRAMES; frame += pageFrames) {
+      int count = SAMPLE_FRAMES - frame;
+      if (count > pageFrames) {
+        count = pageFrames;
+      }
+      file->Seek(WAV_HEADER_SIZE + frame * frameSize, SEEK_SET);
+      file->Read(chunk, count * frameSize, 1);
+    }
+    unsigned long elapsed = system->GetMicros() - start;
+    file->Close();
+    delete file;
+    if ((pass == 0) || (elapsed < best)) {
+      best = elapsed;
+    }
+  }
+  return best;
+}
+
+static unsigned long kbPerSecond(int bytes, unsigned long micros) {
+  return micros ? (unsigned long)((long long)bytes * 1000000 / 1024 / micros)
+                : 0;
+}
+
+static unsigned long bestConvertTime(const Format &format,
+                                     const std::vector<unsigned char> &data,
+                                     std::vector<short> &converted) {
+  System *system = System::GetInstance();
+  int frameSize = CHANNEL_COUNT * format.bytePerSample;
+  int chunkFrames = CHUNK_SIZE / (CHANNEL_COUNT * ((format.bytePerSample > 2)
+                                                       ? format.bytePerSample
+                                                       : 2));
+  unsigned char chunk[CHUNK_SIZE];
+  unsigned long best = 0;
+  for (int pass = 0; pass < PASS_COUNT; pass++) {
+    unsigned long elapsed = 0;
+    for (int frame = 0; frame < SAMPLE_FRAMES; frame += chunkFrames) {
+      int count = SAMPLE_FRAMES - frame;
+      if (count > chunkFrames) {
+        count = chunkFrames;
+      }
+      memcpy(chunk, &data[frame * frameSize], count * frameSize);
+      unsigned long start = system->GetMicros();
+      WavFile::ConvertSamples(chunk, count * CHANNEL_COUNT,
+                              format.bytePerSample, format.isFloat);
+      elapsed += system->GetMicros() - start;
+      memcpy(&converted[frame * CHANNEL_COUNT], chunk,
+             count * CHANNEL_COUNT * sizeof(short));
+    }
+    if ((pass == 0) || (elapsed < best)) {
+      best = elapsed;
+    }
+  }
+  return best;
+}
+
+// Goes through WavFile::Open and LoadInMemory to check the header parsing
+// picks the right conversion
+
+static bool checkLoad(const char *path, const Format &format) {
+  WavFile *wav = WavFile::Open(path);
+  if (!wav || !wav->LoadInMemory()) {
+    fprintf(stderr, "%s: can't load %s\n", format.name, path);
+    delete wav;
+    return false;
+  }
+  bool ok = (wav->GetSize(-1) == SAMPLE_FRAMES) &&
+            matchesSource((short *)wav->GetSampleBuffer(-1), format.name);
+  delete wav;
+  return ok;
+}
+
+int main(int argc, char **argv) {
+
+  InstallHostPlatform();
+  makeSource();
+
+  char workDir[] = "/tmp/wav_bench.XXXXXX";
+  if (!mkdtemp(workDir)) {
+    perror("mkdtemp");
+    return 2;
+  }
+
+  int failures = 0;
+  std::vector<short> converted(source.size());
+  printf("%-8s %8s %8s %8s %10s %8s\n", "format", "bytes", "read us", "KB/s",
+         "convert us", "KB/s");
+  for (int i = 0; i < FORMAT_COUNT; i++) {
+    const Format &format = formats[i];
+    std::vector<unsigned char> data = encode(format);
+    std::string path = std::string(workDir) + "/" + char('a' + i) + ".wav";
+    if (!writeWav(path.c_str(), format, data)) {
+      fprintf(stderr, "Can't write %s\n", path.c_str());
+      return 2;
+    }
+
+    int bytes = (int)data.size();
+    unsigned long readMicros = bestReadTime(path.c_str(), format);
+    unsigned long convertMicros = bestConvertTime(format, data, converted);
+    printf("%-8s %8d %8lu %8lu %10lu %8lu\n", format.name, bytes, readMicros,
+           kbPerSecond(bytes, readMicros), convertMicros,
+           kbPerSecond(bytes, convertMicros));
+
+    if (!matchesSource(&converted[0], format.name) ||
+        !checkLoad(path.c_str(), format)) {
+      failures++;
+    }
+    remove(path.c_str());
+  }
+  rmdir(workDir);
+
+  printf("%d/%d formats convert correctly\n", FORMAT_COUNT - failures,
+         FORMAT_COUNT);
+  return (failures == 0) ? 0 : 1;
+}
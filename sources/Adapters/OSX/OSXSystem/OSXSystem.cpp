@@ -17,7 +17,7 @@
 #include "Application/Model/Config.h"
 #include "System/Console/Logger.h"
 #include "System/Console/Trace.h"
-#include <CoreFoundation/CoreFoundation.h>
+#include <SDL.h>
 #include <memory.h>
 #include <sys/time.h>
 #include <time.h>
@@ -97,27 +97,15 @@ void OSXSystem::Shutdown() {}
 void OSXSystem::installAliases() {
   // aliases
 
-  char path[1024];
-  CFBundleRef mainBundle = CFBundleGetMainBundle();
-  NAssert(mainBundle);
+  // SDL knows where the executable lives on every desktop platform
 
-  CFURLRef mainBundleURL = CFBundleCopyBundleURL(mainBundle);
-  NAssert(mainBundleURL);
-
-  CFStringRef cfStringRef =
-      CFURLCopyFileSystemPath(mainBundleURL, kCFURLPOSIXPathStyle);
-  NAssert(cfStringRef);
-
-  CFStringGetCString(cfStringRef, path, 1024, kCFStringEncodingASCII);
-
-  CFRelease(mainBundleURL);
-  CFRelease(cfStringRef);
-
-  std::string asciiPath = path;
-
-  // get the package directory:
-  std::string::size_type pos = asciiPath.find_last_of('/');
-  std::string directoryPath(asciiPath, 0, pos);
+  char *basePath = SDL_GetBasePath();
+  NAssert(basePath);
+  std::string directoryPath(basePath);
+  SDL_free(basePath);
+  if ((directoryPath.size() > 1) && (directoryPath.back() == '/')) {
+    directoryPath.pop_back();
+  }
 
   // set the bin path alias:
   std::string binPath = directoryPath;
@@ -144,6 +132,19 @@ unsigned long OSXSystem::GetClock() {
 
 //------------------------------------------------------------------------------
 
+unsigned long OSXSystem::GetMicros() {
+
+  struct timeval tp;
+
+  gettimeofday(&tp, NULL);
+  if (!secbase) {
+    secbase = tp.tv_sec;
+  }
+  return (unsigned long)(tp.tv_sec - secbase) * 1000000 + tp.tv_usec;
+}
+
+//------------------------------------------------------------------------------
+
 void OSXSystem::Sleep(int millisec) {
 /*	if (millisec>0)
 		::Sleep(millisec) ;
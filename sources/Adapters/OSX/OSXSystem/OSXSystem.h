@@ -15,6 +15,7 @@ public:
 
 public: // System implementation
   virtual unsigned long GetClock();
+  virtual unsigned long GetMicros();
   virtual void Sleep(int millisec);
   virtual void *Malloc(unsigned size);
   virtual void Free(void *);
@@ -17,7 +17,7 @@ SDLAudioDriverThread::SDLAudioDriverThread(SDLAudioDriver *driver) {
 bool SDLAudioDriverThread::Execute() {
   while (!shouldTerminate()) {
     semaphore_->Wait();
-    driver_->OnNewBufferNeeded();
+    driver_->RenderAhead();
   };
   SysSemaphore *semaphore = semaphore_;
   semaphore_ = 0;
@@ -42,19 +42,19 @@ void SDLAudioDriverThread::RequestTermination() {
 //-------------------------------------------------------------------------------------------------
 
 SDLAudioDriver::SDLAudioDriver(AudioSettings &settings)
-    : AudioDriver(settings), unalignedMain_(0), miniBlank_(0) {
+    : AudioDriver(settings), device_(0) {
   isPlaying_ = false;
   thread_ = 0;
 }
 
 SDLAudioDriver::~SDLAudioDriver() {}
 
-struct SDL_AudioSpec input;
-struct SDL_AudioSpec returned;
-
 bool SDLAudioDriver::InitDriver() {
 
-  // set sound
+  SDL_AudioSpec input;
+  SDL_AudioSpec returned;
+
+  SDL_zero(input);
   input.freq = 44100;
   input.format = AUDIO_S16SYS;
   input.channels = 2;
@@ -62,64 +62,50 @@ bool SDLAudioDriver::InitDriver() {
   input.samples = settings_.bufferSize_;
   input.userdata = this;
 
-  if (SDL_OpenAudio(&input, &returned) < 0) {
+  if (!SDL_WasInit(SDL_INIT_AUDIO) && (SDL_InitSubSystem(SDL_INIT_AUDIO) < 0)) {
+    Trace::Error("Couldn't init sdl audio: %s\n", SDL_GetError());
+    return false;
+  }
+
+  device_ = SDL_OpenAudioDevice(NULL, 0, &input, &returned, 0);
+  if (device_ == 0) {
     Trace::Error("Couldn't open sdl audio: %s\n", SDL_GetError());
     return false;
   }
-  char bufferName[256];
-  SDL_AudioDriverName(bufferName, 256);
 
   fragSize_ = returned.size;
-  // TODO: is it needed to align memory? crash in OSX
-  // Allocates a rotating sound buffer
-  // unalignedMain_=(char *)SYS_MALLOC(fragSize_+SOUND_BUFFER_MAX) ;
-  // Make sure the buffer is aligned.
-  // mainBuffer_=(char *)((((int)unalignedMain_)+1)&(0xFFFFFFFC)) ;
-  mainBuffer_ = (char *)SYS_MALLOC(fragSize_ + SOUND_BUFFER_MAX);
-
-  Trace::Log("AUDIO", "%s successfully opened with %d samples", bufferName,
-             fragSize_ / 4);
 
-  // Create mini blank buffer in case of underruns
+  // Fragments are small, start shallow and let underruns deepen the ring
+  depth_ = AUDIO_DEPTH_MIN;
 
-  miniBlank_ = (char *)malloc(fragSize_);
-  SYS_MEMSET(miniBlank_, 0, fragSize_);
+  Trace::Log("AUDIO", "%s successfully opened with %d samples",
+             SDL_GetCurrentAudioDriver(), fragSize_ / 4);
 
   return true;
 };
 
 void SDLAudioDriver::CloseDriver() {
-
-  if (miniBlank_) {
-    SYS_FREE(miniBlank_);
-    miniBlank_ = 0;
+  if (device_) {
+    SDL_CloseAudioDevice(device_);
+    device_ = 0;
   }
-
-  if (unalignedMain_) {
-    SYS_FREE(unalignedMain_);
-    unalignedMain_ = 0;
-  };
-  SDL_CloseAudio();
 };
 
 bool SDLAudioDriver::StartDriver() {
 
-  thread_ = new SDLAudioDriverThread(this);
-  thread_->Start();
+  // Start with preBufferCount_ fragments of silence in the ring
 
-  short blank[4000];
-  SYS_MEMSET(blank, 0, 4000);
-  bufferPos_ = 0;
-  bufferSize_ = 0;
+  writePos_ = 0;
+  readPos_ = 0;
+  int preBuffer = MIN(settings_.preBufferCount_ * fragSize_, SDL_RING_SIZE / 2);
+  SYS_MEMSET(ring_, 0, preBuffer);
+  writePos_ = preBuffer;
 
-  for (int i = 0; i < settings_.preBufferCount_; i++) {
-    AddBuffer((short *)miniBlank_, fragSize_ / 4);
-  }
-  if (settings_.preBufferCount_ == 0) {
-    thread_->Notify();
-  }
+  thread_ = new SDLAudioDriverThread(this);
+  thread_->Start();
+  thread_->Notify();
 
-  SDL_PauseAudio(0);
+  SDL_PauseAudioDevice(device_, 0);
   startTime_ = SDL_GetTicks();
 
   return 1;
@@ -130,7 +116,7 @@ void SDLAudioDriver::StopDriver() {
     thread_->RequestTermination();
     SysThread *thread = thread_;
     thread_ = 0;
-    SDL_PauseAudio(1);
+    SDL_PauseAudioDevice(device_, 1);
     delete thread;
   };
 };
@@ -139,38 +125,58 @@ double SDLAudioDriver::GetStreamTime() {
   return (SDL_GetTicks() - startTime_) / 1000.0;
 }
 
-void SDLAudioDriver::OnChunkDone(Uint8 *stream, int len) {
-
-  // Look if we have enough data in main buffer
-
-  while (bufferSize_ - bufferPos_ < len) {
-
-    // First move remaining bytes at the front
-    memcpy(mainBuffer_,mainBuffer_+bufferPos_,bufferSize_-bufferPos_) ;
+int SDLAudioDriver::ringFill() {
+  return int(writePos_.load(std::memory_order_acquire) -
+             readPos_.load(std::memory_order_acquire));
+}
 
-    // then get next queued buffer and copy data from it
-    if (pool_[poolPlayPosition_].empty_) {
-      SYS_MEMCPY(mainBuffer_+bufferSize_-bufferPos_, miniBlank_,len);
-      bufferSize_=bufferSize_-bufferPos_+len ;
-      bufferPos_=0 ;
-    } else {
-      memcpy(mainBuffer_ + bufferSize_ - bufferPos_,
-             pool_[poolPlayPosition_].buffer_, pool_[poolPlayPosition_].size_);
+void SDLAudioDriver::writeRing(const char *data, int len) {
+  unsigned int pos = writePos_.load(std::memory_order_relaxed);
+  int offset = pos & (SDL_RING_SIZE - 1);
+  int first = MIN(len, SDL_RING_SIZE - offset);
+  SYS_MEMCPY(ring_ + offset, data, first);
+  SYS_MEMCPY(ring_, data + first, len - first);
+  writePos_.store(pos + len, std::memory_order_release);
+}
 
-      // Adapt buffer variables
-      bufferSize_=bufferSize_-bufferPos_+pool_[poolPlayPosition_].size_ ;
-      bufferPos_=0 ;
+// Runs on the render thread: renders buffers and moves them from the pool
+// to the ring until the ring holds the current depth in fragments
+
+void SDLAudioDriver::RenderAhead() {
+  while (isPlaying_ && (ringFill() < depth_ * fragSize_) &&
+         (SDL_RING_SIZE - ringFill() >= SOUND_BUFFER_MAX)) {
+    OnNewBufferNeeded();
+    while (!pool_[poolPlayPosition_].empty_) {
+      AudioBufferData &data = pool_[poolPlayPosition_];
+      writeRing(data.buffer_, data.size_);
+      data.empty_ = true;
+      poolPlayPosition_ = (poolPlayPosition_ + 1) % SOUND_BUFFER_COUNT;
+    }
+  }
+}
 
-      pool_[poolPlayPosition_].empty_ = true;
-      poolPlayPosition_=(poolPlayPosition_+1)%SOUND_BUFFER_COUNT ;
-      if (thread_) thread_->Notify() ;
+// Runs on the SDL audio thread and never waits: whatever is missing from
+// the ring is played as silence
 
-    }
+void SDLAudioDriver::OnChunkDone(Uint8 *stream, int len) {
+  unsigned int pos = readPos_.load(std::memory_order_relaxed);
+  int available = int(writePos_.load(std::memory_order_acquire) - pos);
+  adaptDepth(available / fragSize_);
+
+  int count = MIN(len, available);
+  int offset = pos & (SDL_RING_SIZE - 1);
+  int first = MIN(count, SDL_RING_SIZE - offset);
+  SYS_MEMCPY(stream, ring_ + offset, first);
+  SYS_MEMCPY(stream + first, ring_, count - first);
+  if (count < len) {
+    SYS_MEMSET(stream + count, 0, len - count);
   }
-  // Now dump audio to the device
-  SYS_MEMCPY(stream,(short *)(mainBuffer_+bufferPos_), len); 
+  readPos_.store(pos + count, std::memory_order_release);
+
   onAudioBufferTick();
-  bufferPos_+=len ;
+  if (thread_) {
+    thread_->Notify();
+  }
 }
 
 int SDLAudioDriver::GetPlayedBufferPercentage() {
@@ -3,7 +3,13 @@
 
 #include "Services/Audio/AudioDriver.h"
 #include "System/Process/Process.h"
-#include <SDL/SDL.h>
+#include <SDL.h>
+#include <atomic>
+
+// Bytes of rendered audio between the render thread and the SDL callback.
+// Must be a power of two
+
+#define SDL_RING_SIZE (1 << 18)
 
 class SDLAudioDriver;
 
@@ -36,16 +42,22 @@ public:
   virtual double GetStreamTime();
   // Additional
   void OnChunkDone(Uint8 *stream, int len);
+  void RenderAhead();
 
 private:
+  int ringFill();
+  void writeRing(const char *data, int len);
+
   int fragSize_; // Actual fragsize used by the driver
-  char *unalignedMain_;
-  char *mainBuffer_;
-  char *miniBlank_;
-  int bufferPos_;
-  int bufferSize_;
+  SDL_AudioDeviceID device_;
   SDLAudioDriverThread *thread_;
   Uint32 startTime_;
+
+  // Single producer (render thread), single consumer (SDL callback). Each
+  // position is only written by its own side and never wraps back
+  char ring_[SDL_RING_SIZE];
+  std::atomic<unsigned int> writePos_;
+  std::atomic<unsigned int> readPos_;
 };
 
 #endif
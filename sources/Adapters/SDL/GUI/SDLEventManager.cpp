@@ -19,7 +19,6 @@ bool SDLEventManager::Init() {
     return false;
   }
 
-  SDL_EnableUNICODE(1);
   SDL_ShowCursor(SDL_DISABLE);
 
   atexit(SDL_Quit);
@@ -57,10 +56,6 @@ bool SDLEventManager::Init() {
     hatCS_[i] = new HatControllerSource(sourceName);
   }
 
-  for (int i = 0; i < SDLK_LAST; i++) {
-    keyname_[i] = SDL_GetKeyName((SDLKey)i);
-  }
-
   return true;
 }
 
@@ -72,17 +67,23 @@ int SDLEventManager::MainLoop() {
     if (SDL_WaitEvent(&event)) {
       switch (event.type) {
       case SDL_KEYDOWN:
+        // Auto repeat is handled by the application
+        if (event.key.repeat) {
+          break;
+        }
         if (dumpEvent_) {
-          Trace::Log("EVENT", "key(%s):%d", keyname_[event.key.keysym.sym], 1);
+          Trace::Log("EVENT", "key(%s):%d",
+                     SDL_GetScancodeName(event.key.keysym.scancode), 1);
         }
-        keyboardCS_->SetKey((int)event.key.keysym.sym, true);
+        keyboardCS_->SetKey((int)event.key.keysym.scancode, true);
         break;
 
       case SDL_KEYUP:
         if (dumpEvent_) {
-          Trace::Log("EVENT", "key(%s):%d", keyname_[event.key.keysym.sym], 0);
+          Trace::Log("EVENT", "key(%s):%d",
+                     SDL_GetScancodeName(event.key.keysym.scancode), 0);
         }
-        keyboardCS_->SetKey((int)event.key.keysym.sym, false);
+        keyboardCS_->SetKey((int)event.key.keysym.scancode, false);
         break;
 
       case SDL_JOYBUTTONDOWN:
@@ -128,9 +129,10 @@ int SDLEventManager::MainLoop() {
       case SDL_QUIT:
         sdlWindow->ProcessQuit();
         break;
-      case SDL_VIDEOEXPOSE:
-        sdlWindow->ProcessExpose();
-
+      case SDL_WINDOWEVENT:
+        if (event.window.event == SDL_WINDOWEVENT_EXPOSED) {
+          sdlWindow->ProcessExpose();
+        }
         break;
       case SDL_USEREVENT:
         sdlWindow->ProcessUserEvent(event);
@@ -146,11 +148,10 @@ void SDLEventManager::PostQuitMessage() {
   finished_ = true;
 };
 
+// Keys are identified by scancode, whose names match the SDL 1.2 key names
+// used in mapping files apart from the case
+
 int SDLEventManager::GetKeyCode(const char *key) {
-  for (int i = 0; i < SDLK_LAST; i++) {
-    if (!strcmp(key, keyname_[i])) {
-      return i;
-    }
-  }
-  return -1;
+  SDL_Scancode code = SDL_GetScancodeFromName(key);
+  return (code == SDL_SCANCODE_UNKNOWN) ? -1 : int(code);
 }
@@ -7,7 +7,7 @@
 #include "Services/Controllers/JoystickControllerSource.h"
 #include "Services/Controllers/KeyboardControllerSource.h"
 #include "UIFramework/SimpleBaseClasses/EventManager.h"
-#include <SDL/SDL.h>
+#include <SDL.h>
 
 #include <string>
 
@@ -26,7 +26,6 @@ public:
 private:
   static bool finished_;
   static bool dumpEvent_;
-  const char *keyname_[SDLK_LAST];
   SDL_Joystick *joystick_[MAX_JOY_COUNT];
   ButtonControllerSource *buttonCS_[MAX_JOY_COUNT];
   JoystickControllerSource *joystickCS_[MAX_JOY_COUNT];
@@ -2,12 +2,12 @@
 #define SDL_GUI_WINDOW_H_
 
 #include "UIFramework/Interfaces/I_GUIWindowImp.h"
-#include <SDL/SDL.h>
+#include <SDL.h>
 
-bool ProcessDEBEvent(SDL_Event &event);
-void ProcessButtonChange(unsigned short, unsigned short);
+// user.code of the SDL_USEREVENTs we post to ourselves
 
-#define MAX_OVERLAYS 250
+#define SDL_CODE_GUIEVENT 0
+#define SDL_CODE_EXPOSE 1
 
 struct SDLCreateWindowParams : public GUICreateWindowParams {
   SDLCreateWindowParams() : cacheFonts_(true), framebuffer_(false){};
@@ -15,6 +15,11 @@ struct SDLCreateWindowParams : public GUICreateWindowParams {
   bool framebuffer_;
 };
 
+// Characters are drawn in an app sized shadow buffer. Flush uploads the
+// rectangle that changed since the last flush to a streaming texture which is
+// then scaled to the window by the renderer. AppWindow already only sends the
+// cells that differ from what's on screen so the uploads stay small
+
 class SDLGUIWindowImp : public I_GUIWindowImp {
 
 public:
@@ -42,33 +47,20 @@ public: // Added functionality
   void ProcessUserEvent(SDL_Event &event);
 
 protected:
-  void prepareFonts();
-  void prepareFullFonts();
-  void prepareBPP1Fonts();
-  void prepareBitmaps();
-  void transform(const GUIRect &srcRect, SDL_Rect *dstRect);
-  void transform(const GUIPoint &srcPoint, int *x, int *y);
-#ifdef _SHOW_GP2X_
-  void drawGP2X();
-  void drawGP2XOverlay();
-  void drawSub(int which);
-  SDL_Surface *load_image(int which, char *filename, int x, int y);
-#endif
+  Uint32 mapColor(GUIColor &c);
+  void drawGlyph(unsigned char c, int x, int y, bool invert);
+  void fillRect(int x, int y, int w, int h, Uint32 color);
+  void addDirty(int x, int y, int w, int h);
+
 private:
-  SDL_Surface *screen_;
-  //	SDL_Surface *offscreen_ ;
-  GUIRect screenRect_;
-  unsigned int currentColor_;
-  unsigned int backgroundColor_;
-  unsigned int foregroundColor_;
-  int bitDepth_;
-  bool cacheFonts_;
-  bool framebuffer_;
-  bool windowed_;
-  SDL_Rect updateRects_[MAX_OVERLAYS];
-  int updateCount_;
-  int appAnchorX_;
-  int appAnchorY_;
+  SDL_Window *window_;
+  SDL_Renderer *renderer_;
+  SDL_Texture *texture_;
+  Uint32 *pixels_;
+  SDL_Rect dirty_; // empty when w is 0
+  Uint32 currentColor_;
+  Uint32 backgroundColor_;
   int mult_;
+  SDL_atomic_t exposePending_;
 };
 #endif
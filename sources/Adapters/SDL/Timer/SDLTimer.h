@@ -1,8 +1,8 @@
 #ifndef _SDL_TIMER_H_
 #define _SDL_TIMER_H_
 
-#include "SDL/SDL.h"
 #include "System/Timer/Timer.h"
+#include <SDL.h>
 
 class SDLTimer : public I_Timer {
 public:
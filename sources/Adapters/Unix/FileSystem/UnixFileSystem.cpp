@@ -13,6 +13,75 @@
 
 UnixDir::UnixDir(const char *path) : I_Dir(path){};
 
+UnixPagedDir::UnixPagedDir(const char *path) : path_(path), dirCount_(0){};
+
+void UnixPagedDir::GetContent(const char *mask) {
+  names_.clear();
+  dirCount_ = 0;
+
+  DIR *directory = opendir(path_.c_str());
+  if (directory == NULL) {
+    Trace::Error("PagedDir GetContent Failed to open %s", path_.c_str());
+    return;
+  }
+
+  std::vector<std::string> files;
+  struct dirent *entry;
+  while ((entry = readdir(directory)) != NULL) {
+    if ((!strcmp(entry->d_name, ".")) || (!strcmp(entry->d_name, ".."))) {
+      continue;
+    }
+    std::string fullpath = path_ + "/" + entry->d_name;
+    struct stat attributes;
+    if ((stat(fullpath.c_str(), &attributes) == 0) &&
+        S_ISDIR(attributes.st_mode)) {
+      names_.push_back(entry->d_name);
+      continue;
+    }
+    std::string lower = entry->d_name;
+    for (char &c : lower) {
+      c = tolower(c);
+    }
+    if (wildcardfit(mask, lower.c_str())) {
+      files.push_back(entry->d_name);
+    }
+  }
+  closedir(directory);
+
+  dirCount_ = names_.size();
+  names_.insert(names_.end(), files.begin(), files.end());
+}
+
+std::string UnixPagedDir::getFullName(int index) {
+  if ((index < 0) || (index >= int(names_.size()))) {
+    return std::string("");
+  }
+  return names_[index];
+}
+
+void UnixPagedDir::getFileList(int startOffset,
+                               std::vector<FileListItem> *fileList) {
+  static const int MAX_ITEMS = 15;
+  bool addedParentDirEntry = false;
+
+  if (startOffset == 0 && (path_ != std::string(SAMPLE_LIB_PATH))) {
+    fileList->push_back(FileListItem("..", 0, true));
+    addedParentDirEntry = true;
+  }
+
+  for (unsigned int i = startOffset;
+       (i < names_.size()) && (fileList->size() < MAX_ITEMS); i++) {
+    bool isDir = i < dirCount_;
+    // truncated like on the device, dirs get surrounding "[]"
+    std::string name = names_[i].substr(0, isDir ? 22 : 24);
+    fileList->push_back(FileListItem(name.c_str(), i, isDir));
+  }
+
+  fileCount_ = names_.size() + (addedParentDirEntry ? 1 : 0);
+}
+
+int UnixPagedDir::size() { return fileCount_; }
+
 void UnixDir::GetContent(const char *mask) {
 
   Empty();
@@ -160,6 +229,10 @@ I_File *UnixFileSystem::Open(const char *path, const char *mode) {
 
 I_Dir *UnixFileSystem::Open(const char *path) { return new UnixDir(path); };
 
+I_PagedDir *UnixFileSystem::OpenPaged(const char *path) {
+  return new UnixPagedDir(path);
+}
+
 FileType UnixFileSystem::GetFileType(const char *path) {
 
   struct stat attributes;
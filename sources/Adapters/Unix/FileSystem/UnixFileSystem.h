@@ -4,6 +4,8 @@
 
 #include "System/FileSystem/FileSystem.h"
 #include <stdio.h>
+#include <string>
+#include <vector>
 
 class UnixFile : public I_File {
 public:
@@ -29,11 +31,31 @@ public:
   virtual void GetProjectContent();
 };
 
+// Entries are listed once by GetContent, directories first. Indexes handed
+// to the UI are positions in that list
+
+class UnixPagedDir : public I_PagedDir {
+public:
+  UnixPagedDir(const char *path);
+  virtual ~UnixPagedDir(){};
+  virtual void GetContent(const char *mask);
+  virtual std::string getFullName(int index);
+  virtual void getFileList(int startIndex,
+                           std::vector<FileListItem> *fileList);
+  virtual int size();
+
+private:
+  const std::string path_;
+  std::vector<std::string> names_;
+  unsigned int dirCount_;
+};
+
 class UnixFileSystem : public FileSystem {
 public:
   UnixFileSystem();
   virtual I_File *Open(const char *path, const char *mode);
   virtual I_Dir *Open(const char *path);
+  virtual I_PagedDir *OpenPaged(const char *path);
   virtual Result MakeDir(const char *path);
   virtual void Delete(const char *path);
   virtual FileType GetFileType(const char *path);
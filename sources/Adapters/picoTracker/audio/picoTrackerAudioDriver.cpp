@@ -22,6 +22,10 @@ char picoTrackerAudioDriver::miniBlank_[MINI_BLANK_SIZE * 2 * sizeof(short)];
 picoTrackerAudioDriver *picoTrackerAudioDriver::instance_ = NULL;
 semaphore_t core1_audio;
 
+// The SD card drivers claim DMA channels dynamically before audio starts, so
+// we take whichever channel is left instead of a fixed one
+static int audioDma = -1;
+
 static volatile unsigned long picoTracker_sound_pausei, picoTracker_exit;
 
 void picoTracker_sound_pause(int yes) { picoTracker_sound_pausei = yes; }
@@ -29,8 +33,8 @@ void picoTracker_sound_pause(int yes) { picoTracker_sound_pausei = yes; }
 // This calls comes after the call to the same function name in the pico audio
 // driver
 void __isr __time_critical_func(audio_i2s_dma_irq_handler)() {
-  if (dma_irqn_get_channel_status(AUDIO_DMA_IRQ, AUDIO_DMA)) {
-    dma_irqn_acknowledge_channel(AUDIO_DMA_IRQ, AUDIO_DMA);
+  if (dma_irqn_get_channel_status(AUDIO_DMA_IRQ, audioDma)) {
+    dma_irqn_acknowledge_channel(AUDIO_DMA_IRQ, audioDma);
     picoTrackerAudioDriver::IRQHandler();
   }
 }
@@ -94,14 +98,14 @@ bool picoTrackerAudioDriver::InitDriver() {
   audio_i2s_program_init(AUDIO_PIO, AUDIO_SM, offset, AUDIO_SDATA, AUDIO_BCLK);
 
   // Claim and configure DMA
-  dma_channel_claim(AUDIO_DMA);
+  audioDma = dma_claim_unused_channel(true);
   dma_channel_config dma_config =
-      dma_channel_get_default_config(AUDIO_DMA);
+      dma_channel_get_default_config(audioDma);
 
   channel_config_set_dreq(&dma_config, DREQ_PIO0_TX0 + AUDIO_SM);
   channel_config_set_transfer_data_size(&dma_config, DMA_SIZE_32);
   channel_config_set_read_increment(&dma_config, true);
-  dma_channel_configure(AUDIO_DMA, &dma_config,
+  dma_channel_configure(audioDma, &dma_config,
                         &AUDIO_PIO->txf[AUDIO_SM], // dest
                         NULL,                               // src
                         0,                                  // count
@@ -110,7 +114,7 @@ bool picoTrackerAudioDriver::InitDriver() {
 
   // Add our own callback func to run after the i2s irq func (priority 0x80)
   irq_set_exclusive_handler(DMA_IRQ_0 + AUDIO_DMA_IRQ, audio_i2s_dma_irq_handler);
-  dma_irqn_set_channel_enabled(AUDIO_DMA_IRQ, AUDIO_DMA, true);
+  dma_irqn_set_channel_enabled(AUDIO_DMA_IRQ, audioDma, true);
 
   // Set PIO frequency
   uint32_t system_clock_frequency = clock_get_hz(clk_sys);
@@ -126,14 +130,14 @@ bool picoTrackerAudioDriver::InitDriver() {
 
   // Enable audio
   irq_set_enabled(DMA_IRQ_0 + AUDIO_DMA_IRQ, true);
-  dma_channel_transfer_from_buffer_now(AUDIO_DMA, miniBlank_,
+  dma_channel_transfer_from_buffer_now(audioDma, miniBlank_,
                                        MINI_BLANK_SIZE);
   pio_sm_set_enabled(AUDIO_PIO, AUDIO_SM, true);
 
   // Set Audio render thread on core1
   multicore_reset_core1();
   multicore_launch_core1(AudioThread);
-  sem_init(&core1_audio, 0, SOUND_BUFFER_COUNT - 1);
+  sem_init(&core1_audio, 0, SOUND_BUFFER_COUNT);
 
   volume_ = 65;
   Config *config = Config::GetInstance();
@@ -157,10 +161,11 @@ void picoTrackerAudioDriver::CloseDriver(){
 
   pio_sm_set_enabled(AUDIO_PIO, AUDIO_SM, false);
   irq_set_enabled(DMA_IRQ_0 + AUDIO_DMA_IRQ, false);
-  dma_irqn_set_channel_enabled(AUDIO_DMA_IRQ, AUDIO_DMA,
+  dma_irqn_set_channel_enabled(AUDIO_DMA_IRQ, audioDma,
                                false);
   irq_remove_handler(DMA_IRQ_0 + AUDIO_DMA_IRQ, audio_i2s_dma_irq_handler);
-  dma_channel_unclaim(AUDIO_DMA);
+  dma_channel_unclaim(audioDma);
+  audioDma = -1;
   pio_sm_unclaim(AUDIO_PIO, AUDIO_SM);
   pio_clear_instruction_memory(AUDIO_PIO);
 };
@@ -168,10 +173,8 @@ void picoTrackerAudioDriver::CloseDriver(){
 bool picoTrackerAudioDriver::StartDriver() {
   isPlaying_ = true;
 
-  // Start filling up as many buffers as we have
-  for (int i = 0; i < SOUND_BUFFER_COUNT - 1; i++) {
-    sem_release(&core1_audio);
-  }
+  // Start filling up the current depth
+  requestBuffers();
 
   // Set MIDI delay
   // TODO: placeholder, check what's the right value
@@ -204,18 +207,27 @@ void picoTrackerAudioDriver::OnChunkDone() {
     // Otherwise, we send a small blank buffer and wait for the other thread to finish
     pool_[poolPlayPosition_].empty_ = true;
 
+    adaptDepth(queuedBuffers());
+
     int next = (poolPlayPosition_ + 1) % SOUND_BUFFER_COUNT;
     if (pool_[next].empty_) {
       dma_channel_transfer_from_buffer_now(
-          AUDIO_DMA, miniBlank_, MINI_BLANK_SIZE);
+          audioDma, miniBlank_, MINI_BLANK_SIZE);
     } else {
       poolPlayPosition_ = next;
       dma_channel_transfer_from_buffer_now(
-          AUDIO_DMA, pool_[poolPlayPosition_].buffer_,
+          audioDma, pool_[poolPlayPosition_].buffer_,
           pool_[poolPlayPosition_].size_ / 4);
     }
 
-    // Finally we allow core1 to calculate an additional buffer
+    // Finally we allow core1 to calculate what's missing to reach the depth
+    requestBuffers();
+  }
+}
+
+void picoTrackerAudioDriver::requestBuffers() {
+  while (queuedBuffers() + pendingBuffers() < depth_) {
+    requested_++;
     sem_release(&core1_audio);
   }
 }
@@ -30,6 +30,8 @@ public:
   static void BufferNeeded();
 
 private:
+  void requestBuffers();
+
   static picoTrackerAudioDriver *instance_;
 
   AudioSettings settings_;
@@ -75,19 +75,38 @@ void mode0_putc(char c, bool invert) {
 }
 
 void mode0_print(const char *str, bool invert) {
-  char c;
-  while ((c = *str++)) {
-    mode0_putc(c, invert);
-  }
+  mode0_write(str, strlen(str), invert);
 }
 
+// Writes a run of characters sharing the same colors starting at the
+// cursor, which is left after the last character. The run is clipped to the
+// current line
+
 void mode0_write(const char *str, int len, bool invert) {
-  for (int i = 0; i < len; i++) {
-    mode0_putc(*str++, invert);
+  if (cursor_y >= TEXT_HEIGHT || cursor_x >= TEXT_WIDTH) {
+    return;
+  }
+  if (len > TEXT_WIDTH - cursor_x) {
+    len = TEXT_WIDTH - cursor_x;
   }
+  uint8_t color;
+  if (invert) {
+    color = ((screen_bg_color & 0xf) << 4) | (screen_fg_color & 0xf);
+  } else {
+    color = ((screen_fg_color & 0xf) << 4) | (screen_bg_color & 0xf);
+  }
+  int idx = cursor_y * TEXT_WIDTH + cursor_x;
+  for (int i = 0; i < len; i++, idx++) {
+    char c = str[i];
+    if (c >= 32 && c <= 127) {
+      screen[idx] = c - 32;
+      colors[idx] = color;
+      SetBit(changed, idx);
+    }
+  }
+  cursor_x += len;
 }
 
-
 void mode0_draw_region(uint8_t x, uint8_t y, uint8_t width, uint8_t height) {
 
   int remainder = height;
@@ -149,6 +168,11 @@ inline void mode0_draw_sub_region(uint8_t x, uint8_t y, uint8_t width, uint8_t h
 
 void mode0_draw_changed() {
   for (int idx = 0; idx < TEXT_HEIGHT * TEXT_WIDTH; idx++) {
+    // most of the screen is usually untouched, skip it a byte at a time
+    if ((idx % 8) == 0 && changed[idx / 8] == 0) {
+      idx += 7;
+      continue;
+    }
     if (TestBit(changed, idx)) {
       ClearBit(changed, idx);
       // check adjacent in order to find bigger rectangle
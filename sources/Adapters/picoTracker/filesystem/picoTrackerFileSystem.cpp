@@ -221,6 +221,18 @@ picoTrackerFileSystem::picoTrackerFileSystem() {
     return;
   }
 
+#ifdef SD_FALLBACK_CONFIG
+  // The card didn't come up in 4 bit mode, try again in SPI mode
+  if (!SD_.card() || SD_.sdErrorCode() != 0) {
+    Trace::Log("FILESYSTEM", "SDIO init failed, falling back to SPI");
+    if (SD_.begin(SD_FALLBACK_CONFIG)) {
+      Trace::Log("FILESYSTEM",
+                 "Mounted SD Card FAT Filesystem from first partition");
+      return;
+    }
+  }
+#endif
+
   // Do we have any kind of card?
   if (!SD_.card() || SD_.sdErrorCode() != 0) {
     Trace::Log("FILESYSTEM", "No SD Card present");
@@ -2,6 +2,10 @@
 #include "Adapters/picoTracker/system/input.h"
 #include "Adapters/picoTracker/utils/utils.h"
 #include "Application/Application.h"
+#ifdef PICOSTATS
+#include "Application/Player/RenderBudget.h"
+#endif
+#include "hardware/sync.h"
 #include "picoTrackerGUIWindowImp.h"
 
 bool picoTrackerEventManager::finished_ = false;
@@ -13,14 +17,11 @@ unsigned long picoTrackerEventManager::time_ = 0;
 unsigned int picoTrackerEventManager::keyRepeat_ = 25;
 unsigned int picoTrackerEventManager::keyDelay_ = 500;
 unsigned int picoTrackerEventManager::keyKill_ = 5;
-repeating_timer_t picoTrackerEventManager::timer_ = repeating_timer_t();
-
-uint16_t gTime_ = 0;
 
-bool timerHandler(repeating_timer_t *rt) {
-  gTime_++;
-  return true;
-}
+alarm_id_t picoTrackerEventManager::alarm_ = 0;
+// Pick up buttons already held at startup
+volatile bool picoTrackerEventManager::inputPending_ = true;
+volatile bool picoTrackerEventManager::redrawPending_ = false;
 
 picoTrackerEventManager::picoTrackerEventManager() {}
 
@@ -31,36 +32,63 @@ bool picoTrackerEventManager::Init() {
 
   keyboardCS_ = new KeyboardControllerSource("keyboard");
 
-  // TODO: fix this, there is a timer service that should be used. Also all of
-  // this keyRepeat logic is already implemented in the eventdispatcher
-  // Application/Commands/EventDispatcher.cpp
-  add_repeating_timer_ms(1, timerHandler, NULL, &timer_);
+  // TODO: all of this keyRepeat logic is already implemented in the
+  // eventdispatcher Application/Commands/EventDispatcher.cpp
+  enableKeyInterrupts(onKeyEdge);
   return true;
 }
 
+// Both run in interrupt context, waking the main loop up on return
+
+void picoTrackerEventManager::onKeyEdge(uint gpio, uint32_t events) {
+  inputPending_ = true;
+}
+
+int64_t picoTrackerEventManager::onKeyTimer(alarm_id_t id, void *data) {
+  inputPending_ = true;
+  return 0;
+}
+
+void picoTrackerEventManager::RequestRedraw() {
+  redrawPending_ = true;
+  // Wakes core 0 up if the request comes from the audio core
+  __sev();
+}
+
 int picoTrackerEventManager::MainLoop() {
-  picoTrackerEventQueue *queue = picoTrackerEventQueue::GetInstance();
   int loops = 0;
   int events = 0;
   while (!finished_) {
     loops++;
-    ProcessInputEvent();
-    picoTrackerEvent *event = queue->Pop(true);
-    if (event) {
+    if (inputPending_) {
+      ProcessInputEvent();
+    }
+    if (redrawPending_) {
       events++;
+      redrawPending_ = false; // Requests made while drawing get a new pass
       redrawing_ = true;
-      picoTrackerGUIWindowImp::ProcessEvent(*event);
-      delete event;
-      queue->Empty(); // Avoid duplicates redraw
+      picoTrackerGUIWindowImp::ProcessRedraw();
       redrawing_ = false;
     }
+    // Sleep until a button, the key timer or a redraw request wakes us. One
+    // firing after the checks above leaves the event flag set, so __wfe
+    // returns straight away and nothing is missed
+    if (!inputPending_ && !redrawPending_) {
+      __wfe();
+    }
 #ifdef PICOSTATS
-    if (loops == 100000) {
-      printf("Usage %.1f% CPU\n", ((float)events / loops) * 100);
+    if (loops == 10000) {
+      printf("Redraws on %.1f% of wake ups\n", ((float)events / loops) * 100);
       events = 0;
       loops = 0;
       //      measure_freqs();
       measure_free_mem();
+      RenderBudget *budget = RenderBudget::GetInstance();
+      printf("Audio load %d%%, voice render us:", budget->GetLoad());
+      for (int i = 0; i < SONG_CHANNEL_COUNT; i++) {
+        printf(" %lu", budget->GetVoiceTime(i));
+      }
+      printf(", metering us: %lu\n", budget->GetMeterTime());
     }
 #endif
   }
@@ -81,6 +109,7 @@ void picoTrackerEventManager::ProcessInputEvent() {
   if (redrawing_)
     return;
   bool gotEvent = false;
+  inputPending_ = false;
 
   // Get current mask
   newMask = scanKeys();
@@ -88,7 +117,7 @@ void picoTrackerEventManager::ProcessInputEvent() {
   // compute mask to send
   sendMask = (newMask ^ buttonMask_) |
              (newMask & (KEY_LEFT | KEY_RIGHT | KEY_UP | KEY_DOWN));
-  unsigned long now = gTime_;
+  unsigned long now = millis();
   // see if we're repeating
   if (newMask == buttonMask_) {
     if ((isRepeating_) && ((now - time_) > keyRepeat_)) {
@@ -107,12 +136,31 @@ void picoTrackerEventManager::ProcessInputEvent() {
     }
   }
   if (gotEvent) {
-    time_ = gTime_; // Get time here so delay is independant of processing speed
+    time_ = millis(); // Get time here so delay is independant of processing speed
 
     //                Trace::Debug("Pe") ;
     picoTrackerGUIWindowImp::ProcessButtonChange(sendMask, newMask);
     buttonMask_ = newMask;
-    //            Trace::Debug("%d: mask=%x",gTime_,sendMask) ;
+    //            Trace::Debug("%d: mask=%x",time_,sendMask) ;
     //                Trace::Debug("~Pe") ;
   }
+
+  // The timer only runs while a change is waiting out the debounce delay or
+  // an arrow is held down for repeat
+
+  unsigned int delay = 0;
+  if (newMask != buttonMask_) {
+    delay = keyKill_;
+  } else if (newMask & (KEY_LEFT | KEY_RIGHT | KEY_UP | KEY_DOWN)) {
+    delay = isRepeating_ ? keyRepeat_ : keyDelay_;
+  }
+  if (alarm_) {
+    cancel_alarm(alarm_);
+    alarm_ = 0;
+  }
+  if (delay) {
+    unsigned long elapsed = millis() - time_;
+    delay = (elapsed < delay) ? delay - elapsed + 1 : 1;
+    alarm_ = add_alarm_in_ms(delay, onKeyTimer, NULL, true);
+  }
 }
@@ -18,11 +18,18 @@ public:
   virtual void PostQuitMessage();
   virtual int GetKeyCode(const char *name);
 
+  // Safe to call from either core
+  static void RequestRedraw();
+
 protected:
   static void ProcessInputEvent();
+  static void onKeyEdge(uint gpio, uint32_t events);
+  static int64_t onKeyTimer(alarm_id_t id, void *data);
 
 private:
-  static repeating_timer_t timer_;
+  static alarm_id_t alarm_;
+  static volatile bool inputPending_;
+  static volatile bool redrawPending_;
 
   static bool finished_;
   static bool redrawing_;
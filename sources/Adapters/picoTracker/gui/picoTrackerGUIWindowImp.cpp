@@ -1,4 +1,5 @@
 #include "picoTrackerGUIWindowImp.h"
+#include "picoTrackerEventManager.h"
 #include "Application/Model/Config.h"
 #include "System/Console/Trace.h"
 #include "System/System/System.h"
@@ -44,6 +45,9 @@ static GUIEventPadButtonType *eventMapping = eventMappingPico;
 
 picoTrackerGUIWindowImp *instance_;
 
+uint16_t picoTrackerGUIWindowImp::palette_[16];
+bool picoTrackerGUIWindowImp::paletteSet_[16];
+
 picoTrackerGUIWindowImp::picoTrackerGUIWindowImp(GUICreateWindowParams &p) {
   mode0_init();
   instance_ = this;
@@ -70,8 +74,9 @@ void picoTrackerGUIWindowImp::DrawChar(const char c, GUIPoint &pos,
 
 void picoTrackerGUIWindowImp::DrawString(const char *string, GUIPoint &pos,
                                          GUITextProperties &p, bool overlay) {
-  Trace::Debug("draw string");
-  mode0_set_cursor(pos._x, pos._y);
+  uint8_t x = pos._x / 8;
+  uint8_t y = pos._y / 8;
+  mode0_set_cursor(x, y);
   mode0_print(string, p.invert_);
 };
 
@@ -91,8 +96,13 @@ void picoTrackerGUIWindowImp::ClearRect(GUIRect &r) {
 
 mode0_color_t picoTrackerGUIWindowImp::GetColor(GUIColor &c) {
   // Palette index should always be < 16. Wont check it.
-  // TODO: should not be redefining the palette colors every call
-  mode0_set_palette_color(c._paletteIndex, to_rgb565(c));
+  // Only touch the palette when the theme actually changes a color
+  uint16_t rgb = to_rgb565(c);
+  if (!paletteSet_[c._paletteIndex] || palette_[c._paletteIndex] != rgb) {
+    mode0_set_palette_color(c._paletteIndex, rgb);
+    palette_[c._paletteIndex] = rgb;
+    paletteSet_[c._paletteIndex] = true;
+  }
   return (mode0_color_t)c._paletteIndex;
 }
 
@@ -107,9 +117,7 @@ void picoTrackerGUIWindowImp::Unlock(){};
 void picoTrackerGUIWindowImp::Flush() { mode0_draw_changed(); };
 
 void picoTrackerGUIWindowImp::Invalidate() {
-  picoTrackerEvent *event = new picoTrackerEvent();
-  event->type_ = PICO_REDRAW;
-  picoTrackerEventQueue::GetInstance()->Push(*event);
+  picoTrackerEventManager::RequestRedraw();
 };
 
 void picoTrackerGUIWindowImp::PushEvent(GUIEvent &event) {
@@ -121,17 +129,10 @@ GUIRect picoTrackerGUIWindowImp::GetRect() {
   return GUIRect(0, 0, 320, 240);
 }
 
-void picoTrackerGUIWindowImp::ProcessEvent(picoTrackerEvent &event) {
-  switch (event.type_) {
-  case PICO_REDRAW:
-    //        instance_->currentBuffer_^=0x01 ;
-    instance_->_window->Update();
-    //        gp_setFramebuffer(instance_->framebuffer_[instance_->currentBuffer_],1);
-    break;
-  }
+void picoTrackerGUIWindowImp::ProcessRedraw() {
+  instance_->_window->Update();
 }
 
-
 void picoTrackerGUIWindowImp::ProcessButtonChange(uint16_t changeMask,
                                                   uint16_t buttonMask) {
   int e = 1;
@@ -1,7 +1,6 @@
 #ifndef PICOTRACKERWINDOWIMP_H_
 #define PICOTRACKERWINDOWIMP_H_
 
-#include "picoTrackerEventQueue.h"
 #include "UIFramework/Interfaces/I_GUIWindowImp.h"
 #include "Adapters/picoTracker/display/mode0.h"
 #include <string>
@@ -31,12 +30,14 @@ public: // I_GUIWindowImp implementation
     void ProcessQuit() ;
     void ProcessUserEvent(SDL_Event &event) ;
   */
-  static void ProcessEvent(picoTrackerEvent &event);
+  static void ProcessRedraw();
   static void ProcessButtonChange(uint16_t changeMask, uint16_t buttonMask);
 
 protected:
   static mode0_color_t GetColor(GUIColor &c);
 
 private:
+  static uint16_t palette_[16];
+  static bool paletteSet_[16];
 };
 #endif
@@ -27,8 +27,6 @@
 #define SDIO_PIO     pio1
 #define SDIO_CMD_SM  0
 #define SDIO_DATA_SM 1
-#define SDIO_DMA_CH  4
-#define SDIO_DMA_CHB 5
 #define SDIO_CLK     2
 #define SDIO_CMD     3
 #define SDIO_D0      4
@@ -53,7 +51,6 @@
 
 #define AUDIO_PIO     pio0
 #define AUDIO_SM      0
-#define AUDIO_DMA     0
 #define AUDIO_DMA_IRQ 0
 #define AUDIO_SDATA   17
 #define AUDIO_BCLK    18 // BCLK and LRCLK HAVE to be consecutive
@@ -21,7 +21,7 @@ static uint32_t g_sdio_sector_count;
   ((g_sdio_error = (call)) == SDIO_OK ? true : logSDError(__LINE__))
 static bool logSDError(int line) {
   g_sdio_error_line = line;
-  Trace::Log("SDIO", "SDIO SD card error on line ", line, ", error code ",
+  Trace::Log("SDIO", "SDIO SD card error on line %d, error code %d", line,
              (int)g_sdio_error);
   return false;
 }
@@ -49,8 +49,8 @@ static sd_callback_t get_stream_callback(const uint8_t *buf, uint32_t count,
       m_stream_count += count;
       return m_stream_callback;
     } else {
-      Trace::Debug("SD card ", accesstype, "(", (int)sector,
-                   ") slow transfer, buffer", (uint32_t)buf, " vs. ",
+      Trace::Debug("SD card %s(%d) slow transfer, buffer %x vs. %x",
+                   accesstype, (int)sector, (uint32_t)buf,
                    (uint32_t)(m_stream_buffer + m_stream_count));
       return NULL;
     }
@@ -59,7 +59,9 @@ static sd_callback_t get_stream_callback(const uint8_t *buf, uint32_t count,
   return NULL;
 }
 
-bool SdioCard::begin(SdioConfig sdioConfig) {
+// Brings the card to 4 bit transfer mode. Fails if the card doesn't
+// negotiate, in which case the caller can fall back to SPI
+static bool sdioInitCard() {
   uint32_t reply;
   sdio_status_t status;
 
@@ -120,7 +122,7 @@ bool SdioCard::begin(SdioConfig sdioConfig) {
     return false;
   }
 
-  g_sdio_sector_count = sectorCount();
+  g_sdio_sector_count = g_sdio_csd.capacity();
 
   // Select card
   if (!checkReturnOk(rp2040_sdio_command_R1(CMD7, g_sdio_rca, &reply))) {
@@ -141,6 +143,15 @@ bool SdioCard::begin(SdioConfig sdioConfig) {
   return true;
 }
 
+bool SdioCard::begin(SdioConfig sdioConfig) {
+  if (!sdioInitCard()) {
+    // Give the pins back so SPI can use them
+    rp2040_sdio_deinit();
+    return false;
+  }
+  return true;
+}
+
 uint8_t SdioCard::errorCode() const { return g_sdio_error; }
 
 uint32_t SdioCard::errorData() const { return 0; }
@@ -286,14 +297,25 @@ bool SdioCard::writeSector(uint32_t sector, const uint8_t *src) {
   } while (g_sdio_error == SDIO_BUSY);
 
   if (g_sdio_error != SDIO_OK) {
-    Trace::Log("SDIO", "SdioCard::writeSector(", sector,
-               ") failed: ", (int)g_sdio_error);
+    Trace::Log("SDIO", "SdioCard::writeSector(%d) failed: %d", sector,
+               (int)g_sdio_error);
   }
 
   return g_sdio_error == SDIO_OK;
 }
 
 bool SdioCard::writeSectors(uint32_t sector, const uint8_t *src, size_t n) {
+  if (n > SDIO_MAX_BLOCKS) {
+    // Split in requests the DMA descriptors can hold
+    for (size_t done = 0; done < n; done += SDIO_MAX_BLOCKS) {
+      size_t count = (n - done > SDIO_MAX_BLOCKS) ? SDIO_MAX_BLOCKS : n - done;
+      if (!writeSectors(sector + done, src + 512 * done, count)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
   if (((uint32_t)src & 3) != 0) {
     // Unaligned write, execute sector-by-sector
     for (size_t i = 0; i < n; i++) {
@@ -330,8 +352,8 @@ bool SdioCard::writeSectors(uint32_t sector, const uint8_t *src, size_t n) {
   } while (g_sdio_error == SDIO_BUSY);
 
   if (g_sdio_error != SDIO_OK) {
-    Trace::Log("SDIO", "SdioCard::writeSectors(", sector, ",...,", (int)n,
-               ") failed: ", (int)g_sdio_error);
+    Trace::Log("SDIO", "SdioCard::writeSectors(%d,...,%d) failed: %d", sector,
+               (int)n, (int)g_sdio_error);
     stopTransmission(true);
     return false;
   } else {
@@ -367,8 +389,8 @@ bool SdioCard::readSector(uint32_t sector, uint8_t *dst) {
   } while (g_sdio_error == SDIO_BUSY);
 
   if (g_sdio_error != SDIO_OK) {
-    Trace::Log("SDIO", "SdioCard::readSector(", sector,
-               ") failed: ", (int)g_sdio_error);
+    Trace::Log("SDIO", "SdioCard::readSector(%d) failed: %d", sector,
+               (int)g_sdio_error);
   }
 
   if (dst != real_dst) {
@@ -379,6 +401,17 @@ bool SdioCard::readSector(uint32_t sector, uint8_t *dst) {
 }
 
 bool SdioCard::readSectors(uint32_t sector, uint8_t *dst, size_t n) {
+  if (n > SDIO_MAX_BLOCKS) {
+    // Split in requests the DMA descriptors can hold
+    for (size_t done = 0; done < n; done += SDIO_MAX_BLOCKS) {
+      size_t count = (n - done > SDIO_MAX_BLOCKS) ? SDIO_MAX_BLOCKS : n - done;
+      if (!readSectors(sector + done, dst + 512 * done, count)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
   if (((uint32_t)dst & 3) != 0 || sector + n >= g_sdio_sector_count) {
     // Unaligned read or end-of-drive read, execute sector-by-sector
     for (size_t i = 0; i < n; i++) {
@@ -411,8 +444,8 @@ bool SdioCard::readSectors(uint32_t sector, uint8_t *dst, size_t n) {
   } while (g_sdio_error == SDIO_BUSY);
 
   if (g_sdio_error != SDIO_OK) {
-    Trace::Log("SDIO", "SdioCard::readSectors(", sector, ",...,", (int)n,
-               ") failed: ", (int)g_sdio_error);
+    Trace::Log("SDIO", "SdioCard::readSectors(%d,...,%d) failed: %d", sector,
+               (int)n, (int)g_sdio_error);
     stopTransmission(true);
     return false;
   } else {
@@ -420,11 +453,6 @@ bool SdioCard::readSectors(uint32_t sector, uint8_t *dst, size_t n) {
   }
 }
 
-// These functions are not used for SDIO mode but are needed to avoid build
-// error.
-void sdCsInit(SdCsPin_t pin) {}
-void sdCsWrite(SdCsPin_t pin, bool level) {}
-
 // SDIO configuration for main program
 SdioConfig g_sd_sdio_config(DMA_SDIO);
 
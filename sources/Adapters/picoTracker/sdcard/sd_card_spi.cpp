@@ -3,10 +3,15 @@
 #include "Adapters/picoTracker/platform/platform.h"
 #include <SdFat.h>
 #include <cstdio>
+#include <hardware/dma.h>
 #include <hardware/gpio.h>
 #include <hardware/spi.h>
 
-#ifndef SD_SDIO
+// Always built, with SD_SDIO this is the fallback for cards that don't
+// negotiate 4 bit mode
+
+// Transfers smaller than this aren't worth setting up the DMA for
+#define SD_SPI_DMA_MIN_SIZE 16
 
 class RP2040SPIDriver : public SdSpiBaseClass
 {
@@ -30,12 +35,29 @@ public:
       gpio_set_function(SD_SPI_MISO, GPIO_FUNC_SPI);
       gpio_set_function(SD_SPI_CS, GPIO_FUNC_SIO);
 
+      // Paired channels for block transfers. TX feeds the SPI while RX
+      // drains it, so the FIFOs never over/underflow
+      if (m_dmaTx < 0) {
+        m_dmaTx = dma_claim_unused_channel(true);
+        m_dmaRx = dma_claim_unused_channel(true);
+      }
     }
 
+    // SdFat activates the bus for every transaction, only touch the
+    // peripheral when the clock actually changes
     void activate() {
-      uint baudrate = spi_init(SD_SPI, m_sckfreq);
+      if (m_sckfreq == m_activeFreq) {
+        return;
+      }
+      uint baudrate;
+      if (m_activeFreq == 0) {
+        baudrate = spi_init(SD_SPI, m_sckfreq);
+        spi_set_format(SD_SPI, 8, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
+      } else {
+        baudrate = spi_set_baudrate(SD_SPI, m_sckfreq);
+      }
       printf("SD SPI baudrate: %i\n", baudrate);
-      spi_set_format(SD_SPI, 8, SPI_CPOL_0, SPI_CPHA_0, SPI_MSB_FIRST);
+      m_activeFreq = m_sckfreq;
     }
 
     void deactivate() {
@@ -63,13 +85,24 @@ public:
     // Multiple byte receive
     uint8_t receive(uint8_t* buf, size_t count)
     {
-        spi_read_blocking(SD_SPI, 0xFF, buf, count);
+        if (count < SD_SPI_DMA_MIN_SIZE) {
+          spi_read_blocking(SD_SPI, 0xFF, buf, count);
+          return 0;
+        }
+        static const uint8_t fill = 0xFF;
+        transfer(&fill, false, buf, true, count);
         return 0;
     }
 
     // Multiple byte send
     void send(const uint8_t* buf, size_t count) {
-        spi_write_blocking(SD_SPI, buf, count);
+        if (count < SD_SPI_DMA_MIN_SIZE) {
+          spi_write_blocking(SD_SPI, buf, count);
+          return;
+        }
+        static uint8_t drain;
+        transfer(buf, true, &drain, false, count);
+        wait_idle();
     }
 
     void setSckSpeed(uint32_t maxSck) {
@@ -77,7 +110,34 @@ public:
     }
 
 private:
-    uint32_t m_sckfreq;
+    // Runs a full duplex DMA transfer of count bytes. Sectors read by
+    // SdFat's multi sector paths (CMD18/CMD25) all go through here
+    void transfer(const uint8_t* src, bool incSrc, uint8_t* dst, bool incDst,
+                  size_t count) {
+      io_rw_32* dr = &spi_get_hw(SD_SPI)->dr;
+
+      dma_channel_config rx = dma_channel_get_default_config(m_dmaRx);
+      channel_config_set_transfer_data_size(&rx, DMA_SIZE_8);
+      channel_config_set_read_increment(&rx, false);
+      channel_config_set_write_increment(&rx, incDst);
+      channel_config_set_dreq(&rx, spi_get_dreq(SD_SPI, false));
+      dma_channel_configure(m_dmaRx, &rx, dst, dr, count, false);
+
+      dma_channel_config tx = dma_channel_get_default_config(m_dmaTx);
+      channel_config_set_transfer_data_size(&tx, DMA_SIZE_8);
+      channel_config_set_read_increment(&tx, incSrc);
+      channel_config_set_write_increment(&tx, false);
+      channel_config_set_dreq(&tx, spi_get_dreq(SD_SPI, true));
+      dma_channel_configure(m_dmaTx, &tx, dr, src, count, false);
+
+      dma_start_channel_mask((1u << m_dmaTx) | (1u << m_dmaRx));
+      dma_channel_wait_for_finish_blocking(m_dmaRx);
+    }
+
+    uint32_t m_sckfreq = 0;
+    uint32_t m_activeFreq = 0;
+    int m_dmaTx = -1;
+    int m_dmaRx = -1;
 };
 
 void sdCsInit(SdCsPin_t pin)
@@ -94,5 +154,3 @@ void sdCsWrite(SdCsPin_t pin, bool level)
 
 RP2040SPIDriver g_sd_spi_port;
 SdSpiConfig g_sd_spi_config(0, DEDICATED_SPI, SD_SCK_MHZ(24), &g_sd_spi_port);
-
-#endif
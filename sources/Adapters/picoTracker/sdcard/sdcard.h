@@ -3,13 +3,16 @@
 
 // SD card driver for SdFat
 
+class SdSpiConfig;
+extern SdSpiConfig g_sd_spi_config;
+
 #ifdef SD_SDIO
 class SdioConfig;
 extern SdioConfig g_sd_sdio_config;
 #define SD_CONFIG g_sd_sdio_config
+// Used when the card doesn't negotiate SDIO
+#define SD_FALLBACK_CONFIG g_sd_spi_config
 #else
-class SdSpiConfig;
-extern SdSpiConfig g_sd_spi_config;
 #define SD_CONFIG g_sd_spi_config
 #endif
 
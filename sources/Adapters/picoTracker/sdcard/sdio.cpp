@@ -16,9 +16,6 @@
 #include <hardware/pio.h>
 #include <string.h>
 
-// Maximum number of 512 byte blocks to transfer in one request
-#define SDIO_MAX_BLOCKS 256
-
 enum sdio_transfer_state_t { SDIO_IDLE, SDIO_RX, SDIO_TX, SDIO_TX_WAIT_IDLE };
 
 static struct {
@@ -55,6 +52,12 @@ static struct {
   } received_checksums[SDIO_MAX_BLOCKS];
 } g_sdio;
 
+// DMA channels are claimed when the interface is first initialized and
+// given back when falling back to SPI, so other drivers can use them
+static bool g_sdio_resources_claimed = false;
+static int g_sdio_dma_ch = -1;
+static int g_sdio_dma_chb = -1;
+
 void rp2040_sdio_dma_irq();
 
 /*******************************************************
@@ -237,18 +240,18 @@ sdio_status_t rp2040_sdio_command_R2(uint8_t command, uint32_t arg,
   // The response is too long to fit in the PIO FIFO, so use DMA to receive it.
   pio_sm_clear_fifos(SDIO_PIO, SDIO_CMD_SM);
   uint32_t response_buf[5];
-  dma_channel_config dmacfg = dma_channel_get_default_config(SDIO_DMA_CH);
+  dma_channel_config dmacfg = dma_channel_get_default_config(g_sdio_dma_ch);
   channel_config_set_transfer_data_size(&dmacfg, DMA_SIZE_32);
   channel_config_set_read_increment(&dmacfg, false);
   channel_config_set_write_increment(&dmacfg, true);
   channel_config_set_dreq(&dmacfg, pio_get_dreq(SDIO_PIO, SDIO_CMD_SM, false));
-  dma_channel_configure(SDIO_DMA_CH, &dmacfg, &response_buf,
+  dma_channel_configure(g_sdio_dma_ch, &dmacfg, &response_buf,
                         &SDIO_PIO->rxf[SDIO_CMD_SM], 5, true);
 
   sdio_send_command(command, arg, 136);
 
   uint32_t start = millis();
-  while (dma_channel_is_busy(SDIO_DMA_CH)) {
+  while (dma_channel_is_busy(g_sdio_dma_ch)) {
     if ((uint32_t)(millis() - start) > 2) {
       Trace::Debug(
           "Timeout waiting for response in rp2040_sdio_command_R2(",
@@ -259,7 +262,7 @@ sdio_status_t rp2040_sdio_command_R2(uint8_t command, uint32_t arg,
           " TXF: ", (int)pio_sm_get_tx_fifo_level(SDIO_PIO, SDIO_CMD_SM));
 
       // Reset the state machine program
-      dma_channel_abort(SDIO_DMA_CH);
+      dma_channel_abort(g_sdio_dma_ch);
       pio_sm_clear_fifos(SDIO_PIO, SDIO_CMD_SM);
       pio_sm_exec(SDIO_PIO, SDIO_CMD_SM,
                   pio_encode_jmp(g_sdio.pio_cmd_clk_offset));
@@ -267,7 +270,7 @@ sdio_status_t rp2040_sdio_command_R2(uint8_t command, uint32_t arg,
     }
   }
 
-  dma_channel_abort(SDIO_DMA_CH);
+  dma_channel_abort(g_sdio_dma_ch);
 
   // Copy the response payload to output buffer
   response[0] = ((response_buf[0] >> 16) & 0xFF);
@@ -373,24 +376,24 @@ sdio_status_t rp2040_sdio_rx_start(uint8_t *buffer, uint32_t num_blocks) {
   g_sdio.dma_blocks[num_blocks * 2].transfer_count = 0;
 
   // Configure first DMA channel for reading from the PIO RX fifo
-  dma_channel_config dmacfg = dma_channel_get_default_config(SDIO_DMA_CH);
+  dma_channel_config dmacfg = dma_channel_get_default_config(g_sdio_dma_ch);
   channel_config_set_transfer_data_size(&dmacfg, DMA_SIZE_32);
   channel_config_set_read_increment(&dmacfg, false);
   channel_config_set_write_increment(&dmacfg, true);
   channel_config_set_dreq(&dmacfg, pio_get_dreq(SDIO_PIO, SDIO_DATA_SM, false));
   channel_config_set_bswap(&dmacfg, true);
-  channel_config_set_chain_to(&dmacfg, SDIO_DMA_CHB);
-  dma_channel_configure(SDIO_DMA_CH, &dmacfg, 0, &SDIO_PIO->rxf[SDIO_DATA_SM],
+  channel_config_set_chain_to(&dmacfg, g_sdio_dma_chb);
+  dma_channel_configure(g_sdio_dma_ch, &dmacfg, 0, &SDIO_PIO->rxf[SDIO_DATA_SM],
                         0, false);
 
   // Configure second DMA channel for reconfiguring the first one
-  dmacfg = dma_channel_get_default_config(SDIO_DMA_CHB);
+  dmacfg = dma_channel_get_default_config(g_sdio_dma_chb);
   channel_config_set_transfer_data_size(&dmacfg, DMA_SIZE_32);
   channel_config_set_read_increment(&dmacfg, true);
   channel_config_set_write_increment(&dmacfg, true);
   channel_config_set_ring(&dmacfg, true, 3);
-  dma_channel_configure(SDIO_DMA_CHB, &dmacfg,
-                        &dma_hw->ch[SDIO_DMA_CH].al1_write_addr,
+  dma_channel_configure(g_sdio_dma_chb, &dmacfg,
+                        &dma_hw->ch[g_sdio_dma_ch].al1_write_addr,
                         g_sdio.dma_blocks, 2, false);
 
   // Initialize PIO state machine
@@ -407,7 +410,7 @@ sdio_status_t rp2040_sdio_rx_start(uint8_t *buffer, uint32_t num_blocks) {
   SDIO_PIO->sm[SDIO_DATA_SM].shiftctrl |= PIO_SM0_SHIFTCTRL_FJOIN_RX_BITS;
 
   // Start PIO and DMA
-  dma_channel_start(SDIO_DMA_CHB);
+  dma_channel_start(g_sdio_dma_chb);
   pio_sm_set_enabled(SDIO_PIO, SDIO_DATA_SM, true);
 
   return SDIO_OK;
@@ -431,9 +434,9 @@ static void sdio_verify_rx_checksums(uint32_t maxcount) {
     if (checksum != expected) {
       g_sdio.checksum_errors++;
       if (g_sdio.checksum_errors == 1) {
-        Trace::Debug
-        ("SDIO checksum error in reception: block ", blockidx, " calculated ",
-         checksum, " expected ", expected);
+        Trace::Debug("SDIO checksum error in reception: block %d calculated "
+                     "%llx expected %llx",
+                     blockidx, checksum, expected);
       }
     }
   }
@@ -449,7 +452,7 @@ sdio_status_t rp2040_sdio_rx_poll(uint32_t *bytes_complete) {
 
     // Check how many DMA control blocks have been consumed
     uint32_t dma_ctrl_block_count =
-        (dma_hw->ch[SDIO_DMA_CHB].read_addr - (uint32_t)&g_sdio.dma_blocks);
+        (dma_hw->ch[g_sdio_dma_chb].read_addr - (uint32_t)&g_sdio.dma_blocks);
     dma_ctrl_block_count /= sizeof(g_sdio.dma_blocks[0]);
 
     // Compute how many complete 512 byte SDIO blocks have been transferred
@@ -482,7 +485,7 @@ sdio_status_t rp2040_sdio_rx_poll(uint32_t *bytes_complete) {
             (int)g_sdio.pio_data_rx_offset,
         " RXF: ", (int)pio_sm_get_rx_fifo_level(SDIO_PIO, SDIO_DATA_SM),
         " TXF: ", (int)pio_sm_get_tx_fifo_level(SDIO_PIO, SDIO_DATA_SM),
-        " DMA CNT: ", dma_hw->ch[SDIO_DMA_CH].al2_transfer_count);
+        " DMA CNT: ", dma_hw->ch[g_sdio_dma_ch].al2_transfer_count);
     rp2040_sdio_stop();
     return SDIO_ERR_DATA_TIMEOUT;
   }
@@ -500,14 +503,14 @@ static void sdio_start_next_block_tx() {
               &g_sdio.pio_cfg_data_tx);
 
   // Configure DMA to send the data block payload (512 bytes)
-  dma_channel_config dmacfg = dma_channel_get_default_config(SDIO_DMA_CH);
+  dma_channel_config dmacfg = dma_channel_get_default_config(g_sdio_dma_ch);
   channel_config_set_transfer_data_size(&dmacfg, DMA_SIZE_32);
   channel_config_set_read_increment(&dmacfg, true);
   channel_config_set_write_increment(&dmacfg, false);
   channel_config_set_dreq(&dmacfg, pio_get_dreq(SDIO_PIO, SDIO_DATA_SM, true));
   channel_config_set_bswap(&dmacfg, true);
-  channel_config_set_chain_to(&dmacfg, SDIO_DMA_CHB);
-  dma_channel_configure(SDIO_DMA_CH, &dmacfg, &SDIO_PIO->txf[SDIO_DATA_SM],
+  channel_config_set_chain_to(&dmacfg, g_sdio_dma_chb);
+  dma_channel_configure(g_sdio_dma_ch, &dmacfg, &SDIO_PIO->txf[SDIO_DATA_SM],
                         g_sdio.data_buf +
                             g_sdio.blocks_done * SDIO_WORDS_PER_BLOCK,
                         SDIO_WORDS_PER_BLOCK, false);
@@ -518,12 +521,12 @@ static void sdio_start_next_block_tx() {
   g_sdio.end_token_buf[1] = (uint32_t)(crc >> 0);
   g_sdio.end_token_buf[2] = 0xFFFFFFFF;
   channel_config_set_bswap(&dmacfg, false);
-  dma_channel_configure(SDIO_DMA_CHB, &dmacfg, &SDIO_PIO->txf[SDIO_DATA_SM],
+  dma_channel_configure(g_sdio_dma_chb, &dmacfg, &SDIO_PIO->txf[SDIO_DATA_SM],
                         g_sdio.end_token_buf, 3, false);
 
   // Enable IRQ to trigger when block is done
-  dma_hw->ints1 = 1 << SDIO_DMA_CHB;
-  dma_set_irq1_channel_mask_enabled(1 << SDIO_DMA_CHB, 1);
+  dma_hw->ints1 = 1 << g_sdio_dma_chb;
+  dma_set_irq1_channel_mask_enabled(1 << g_sdio_dma_chb, 1);
 
   // Initialize register X with nibble count and register Y with response bit
   // count
@@ -538,7 +541,7 @@ static void sdio_start_next_block_tx() {
 
   // Write start token and start the DMA transfer.
   pio_sm_put(SDIO_PIO, SDIO_DATA_SM, 0xFFFFFFF0);
-  dma_channel_start(SDIO_DMA_CH);
+  dma_channel_start(g_sdio_dma_ch);
 
   // Start state machine
   pio_sm_set_enabled(SDIO_PIO, SDIO_DATA_SM, true);
@@ -613,11 +616,11 @@ sdio_status_t check_sdio_write_response(uint32_t card_response) {
 
 // When a block finishes, this IRQ handler starts the next one
 static void rp2040_sdio_tx_irq() {
-  dma_hw->ints1 = 1 << SDIO_DMA_CHB;
+  dma_hw->ints1 = 1 << g_sdio_dma_chb;
 
   if (g_sdio.transfer_state == SDIO_TX) {
-    if (!dma_channel_is_busy(SDIO_DMA_CH) &&
-        !dma_channel_is_busy(SDIO_DMA_CHB)) {
+    if (!dma_channel_is_busy(g_sdio_dma_ch) &&
+        !dma_channel_is_busy(g_sdio_dma_chb)) {
       // Main data transfer is finished now.
       // When card is ready, PIO will put card response on RX fifo
       g_sdio.transfer_state = SDIO_TX_WAIT_IDLE;
@@ -627,20 +630,20 @@ static void rp2040_sdio_tx_irq() {
       } else {
         // Use DMA to wait for the response
         dma_channel_config dmacfg =
-            dma_channel_get_default_config(SDIO_DMA_CHB);
+            dma_channel_get_default_config(g_sdio_dma_chb);
         channel_config_set_transfer_data_size(&dmacfg, DMA_SIZE_32);
         channel_config_set_read_increment(&dmacfg, false);
         channel_config_set_write_increment(&dmacfg, false);
         channel_config_set_dreq(&dmacfg,
                                 pio_get_dreq(SDIO_PIO, SDIO_DATA_SM, false));
-        dma_channel_configure(SDIO_DMA_CHB, &dmacfg, &g_sdio.card_response,
+        dma_channel_configure(g_sdio_dma_chb, &dmacfg, &g_sdio.card_response,
                               &SDIO_PIO->rxf[SDIO_DATA_SM], 1, true);
       }
     }
   }
 
   if (g_sdio.transfer_state == SDIO_TX_WAIT_IDLE) {
-    if (!dma_channel_is_busy(SDIO_DMA_CHB)) {
+    if (!dma_channel_is_busy(g_sdio_dma_chb)) {
       g_sdio.wr_status = check_sdio_write_response(g_sdio.card_response);
 
       if (g_sdio.wr_status != SDIO_OK) {
@@ -690,7 +693,7 @@ sdio_status_t rp2040_sdio_tx_poll(uint32_t *bytes_complete) {
             (int)g_sdio.pio_data_tx_offset,
         " RXF: ", (int)pio_sm_get_rx_fifo_level(SDIO_PIO, SDIO_DATA_SM),
         " TXF: ", (int)pio_sm_get_tx_fifo_level(SDIO_PIO, SDIO_DATA_SM),
-        " DMA CNT: ", dma_hw->ch[SDIO_DMA_CH].al2_transfer_count);
+        " DMA CNT: ", dma_hw->ch[g_sdio_dma_ch].al2_transfer_count);
     rp2040_sdio_stop();
     return SDIO_ERR_DATA_TIMEOUT;
   }
@@ -698,11 +701,30 @@ sdio_status_t rp2040_sdio_tx_poll(uint32_t *bytes_complete) {
   return SDIO_BUSY;
 }
 
+// Stop the state machines and DMA so the pins can be handed over to
+// another peripheral, and release them for the SPI driver
+void rp2040_sdio_deinit() {
+  if (!g_sdio_resources_claimed) {
+    return;
+  }
+  rp2040_sdio_stop();
+  pio_sm_set_enabled(SDIO_PIO, SDIO_CMD_SM, false);
+  dma_channel_unclaim(g_sdio_dma_ch);
+  dma_channel_unclaim(g_sdio_dma_chb);
+  g_sdio_dma_ch = g_sdio_dma_chb = -1;
+  pio_sm_unclaim(SDIO_PIO, SDIO_CMD_SM);
+  pio_sm_unclaim(SDIO_PIO, SDIO_DATA_SM);
+  g_sdio_resources_claimed = false;
+}
+
 // Force everything to idle state
 sdio_status_t rp2040_sdio_stop() {
-  dma_channel_abort(SDIO_DMA_CH);
-  dma_channel_abort(SDIO_DMA_CHB);
-  dma_set_irq1_channel_mask_enabled(1 << SDIO_DMA_CHB, 0);
+  if (!g_sdio_resources_claimed) {
+    return SDIO_OK;
+  }
+  dma_channel_abort(g_sdio_dma_ch);
+  dma_channel_abort(g_sdio_dma_chb);
+  dma_set_irq1_channel_mask_enabled(1 << g_sdio_dma_chb, 0);
   pio_sm_set_enabled(SDIO_PIO, SDIO_DATA_SM, false);
   pio_sm_set_consecutive_pindirs(SDIO_PIO, SDIO_DATA_SM, SDIO_D0, 4, false);
   g_sdio.transfer_state = SDIO_IDLE;
@@ -711,19 +733,18 @@ sdio_status_t rp2040_sdio_stop() {
 
 void rp2040_sdio_init(int clock_divider) {
   // Mark resources as being in use, unless it has been done already.
-  static bool resources_claimed = false;
-  if (!resources_claimed) {
+  if (!g_sdio_resources_claimed) {
     pio_sm_claim(SDIO_PIO, SDIO_CMD_SM);
     pio_sm_claim(SDIO_PIO, SDIO_DATA_SM);
-    dma_channel_claim(SDIO_DMA_CH);
-    dma_channel_claim(SDIO_DMA_CHB);
-    resources_claimed = true;
+    g_sdio_dma_ch = dma_claim_unused_channel(true);
+    g_sdio_dma_chb = dma_claim_unused_channel(true);
+    g_sdio_resources_claimed = true;
   }
 
   memset(&g_sdio, 0, sizeof(g_sdio));
 
-  dma_channel_abort(SDIO_DMA_CH);
-  dma_channel_abort(SDIO_DMA_CHB);
+  dma_channel_abort(g_sdio_dma_ch);
+  dma_channel_abort(g_sdio_dma_chb);
   pio_sm_set_enabled(SDIO_PIO, SDIO_CMD_SM, false);
   pio_sm_set_enabled(SDIO_PIO, SDIO_DATA_SM, false);
 
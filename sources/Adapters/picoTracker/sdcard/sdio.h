@@ -27,6 +27,11 @@ enum sdio_status_t {
 #define SDIO_BLOCK_SIZE 512
 #define SDIO_WORDS_PER_BLOCK 128
 
+// Maximum number of 512 byte blocks to transfer in one request. Each block
+// needs two DMA descriptors and a checksum slot (24 bytes of RAM), bigger
+// requests are split by the card layer
+#define SDIO_MAX_BLOCKS 32
+
 // Execute a command that has 48-bit reply (response types R1, R6, R7)
 // If response is NULL, does not wait for reply.
 sdio_status_t rp2040_sdio_command_R1(uint8_t command, uint32_t arg,
@@ -61,4 +66,7 @@ sdio_status_t rp2040_sdio_stop();
 // (Re)initialize the SDIO interface
 void rp2040_sdio_init(int clock_divider = 1);
 
+// Release the bus, used when falling back to SPI
+void rp2040_sdio_deinit();
+
 #endif
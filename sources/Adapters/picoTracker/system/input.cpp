@@ -1,5 +1,17 @@
 #include "input.h"
 
 uint16_t scanKeys() {
-  return (~gpio_get_all() & 0x0001FF00) >> 8;
+  return (~gpio_get_all() & KEY_GPIO_MASK) >> KEY_GPIO_SHIFT;
+}
+
+// Calls back on both edges of every button so the UI core can sleep until
+// something happens
+
+void enableKeyInterrupts(gpio_irq_callback_t callback) {
+  for (uint pin = 0; pin < 32; pin++) {
+    if (KEY_GPIO_MASK & (1u << pin)) {
+      gpio_set_irq_enabled_with_callback(
+          pin, GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL, true, callback);
+    }
+  }
 }
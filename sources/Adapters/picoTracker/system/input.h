@@ -17,6 +17,11 @@ typedef enum KEYPAD_BITS {
   KEY_SELECT = BIT(9), //!< Keypad SELECT button.
 } KEYPAD_BITS;
 
+// Buttons are wired to consecutive GPIOs starting at INPUT_LEFT
+#define KEY_GPIO_SHIFT 8
+#define KEY_GPIO_MASK 0x0001FF00
+
 uint16_t scanKeys();
+void enableKeyInterrupts(gpio_irq_callback_t callback);
 
 #endif
@@ -1,4 +0,0 @@
-#include "picoTrackerEventQueue.h"
-
-picoTrackerEventQueue::picoTrackerEventQueue()
-    : T_Stack<picoTrackerEvent>(true) {}
@@ -3,6 +3,7 @@
 #include "Adapters/picoTracker/audio/picoTrackerAudio.h"
 #include "Adapters/picoTracker/filesystem/picoTrackerFileSystem.h"
 #include "Adapters/picoTracker/gui/GUIFactory.h"
+#include "Adapters/picoTracker/utils/utils.h"
 #ifdef DUMMY_MIDI
 #include "Adapters/Dummy/Midi/DummyMidi.h"
 #else
@@ -118,6 +119,8 @@ unsigned long picoTrackerSystem::GetClock() {
   return long((tp.tv_sec - secbase) * 1000 + tp.tv_usec / 1000.0);
 }
 
+unsigned long picoTrackerSystem::GetMicros() { return micros(); }
+
 int picoTrackerSystem::GetBatteryLevel() {
 
   if (0) {
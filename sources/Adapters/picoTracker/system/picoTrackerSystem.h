@@ -17,6 +17,7 @@ public:
 
 public: // System implementation
   virtual unsigned long GetClock();
+  virtual unsigned long GetMicros();
   virtual int GetBatteryLevel();
   virtual void Sleep(int millisec);
   virtual void *Malloc(unsigned size);
@@ -3,6 +3,7 @@
 #include "Application/Commands/EventDispatcher.h"
 #include "Application/Instruments/SamplePool.h"
 #include "Application/Mixer/MixerService.h"
+#include "Application/Model/UndoJournal.h"
 #include "Application/Persistency/PersistencyService.h"
 #include "Application/Player/TablePlayback.h"
 #include "Application/Utils/char.h"
@@ -79,6 +80,7 @@ AppWindow::AppWindow(I_GUIWindowImp &imp) : GUIWindow(imp) {
   _tableView = 0;
   _nullView = 0;
   _grooveView = 0;
+  _mixerView = 0;
   _closeProject = 0;
   _lastA = 0;
   _lastB = 0;
@@ -113,6 +115,7 @@ AppWindow::AppWindow(I_GUIWindowImp &imp) : GUIWindow(imp) {
   memset(_preScreen, ' ', 1200);
   memset(_charScreenProp, 0, 1200);
   memset(_preScreenProp, 0, 1200);
+  setRowsDirty(0, SCREEN_HEIGHT);
 
   Redraw();
 };
@@ -135,9 +138,21 @@ void AppWindow::DrawString(const char *string, GUIPoint &pos,
 
   NAssert((pos._x < 40) && (pos._y < 30));
   int index = pos._x + 40 * pos._y;
-  memcpy(_charScreen + index, buffer, len);
   unsigned char prop = colorIndex_ + (props.invert_ ? PROP_INVERT : 0);
-  memset(_charScreenProp + index, prop, len);
+
+  // Views redraw the same content a lot, only rows that actually change
+  // need flushing
+
+  unsigned char *screen = _charScreen + index;
+  unsigned char *screenProp = _charScreenProp + index;
+  for (int i = 0; i < len; i++) {
+    if ((screen[i] != buffer[i]) || (screenProp[i] != prop)) {
+      memcpy(screen, buffer, len);
+      memset(screenProp, prop, len);
+      setRowsDirty(pos._y, 1);
+      break;
+    }
+  }
 };
 
 void AppWindow::Clear(bool all) {
@@ -147,6 +162,7 @@ void AppWindow::Clear(bool all) {
     memset(_preScreen, ' ', 1200);
     memset(_preScreenProp, 0, 1200);
   };
+  setRowsDirty(0, SCREEN_HEIGHT);
 };
 
 void AppWindow::ClearRect(GUIRect &r) {
@@ -166,6 +182,28 @@ void AppWindow::ClearRect(GUIRect &r) {
     st += (40 - w);
     pr += (40 - w);
   }
+  setRowsDirty(y, h);
+};
+
+// Rows are only flagged when they differ from what was last flushed, so a
+// view clearing the screen and drawing the same content back costs nothing
+
+void AppWindow::setRowsDirty(int top, int count) {
+  int bottom = MIN(top + count, SCREEN_HEIGHT);
+  for (int y = (top < 0) ? 0 : top; y < bottom; y++) {
+    int row = SCREEN_WIDTH * y;
+#ifndef _LGPT_NO_SCREEN_CACHE_
+    bool changed =
+        memcmp(_charScreen + row, _preScreen + row, SCREEN_WIDTH) ||
+        memcmp(_charScreenProp + row, _preScreenProp + row, SCREEN_WIDTH);
+#else
+    bool changed = true;
+#endif
+    rowDirty_[y] = changed;
+    if (changed) {
+      dirty_ = true;
+    }
+  }
 };
 
 //
@@ -178,10 +216,23 @@ void AppWindow::Redraw() {
 
   if (_currentView) {
     _currentView->Redraw();
-    Invalidate();
+    if (dirty_) {
+      Invalidate();
+    }
   }
 };
 
+static inline bool cellChanged(unsigned char *current,
+                               unsigned char *previous,
+                               unsigned char *currentProp,
+                               unsigned char *previousProp, int x) {
+#ifndef _LGPT_NO_SCREEN_CACHE_
+  return (current[x] != previous[x]) || (currentProp[x] != previousProp[x]);
+#else
+  return true;
+#endif
+}
+
 //
 // Flush current screen to display
 //
@@ -196,67 +247,79 @@ void AppWindow::Flush() {
   GUIPoint pos;
 
   ColorDefinition color = (ColorDefinition)-1;
-  pos._x = 0;
-  pos._y = 0;
 
   int count = 0;
 
-  unsigned char *current = _charScreen;
-  unsigned char *previous = _preScreen;
-  unsigned char *currentProp = _charScreenProp;
-  unsigned char *previousProp = _preScreenProp;
+  // Changed cells are sent as runs sharing the same color and inversion so
+  // the display only gets one call per run instead of one per character
+
+  char run[SCREEN_WIDTH + 1];
+
+  dirty_ = false;
   for (int y = 0; y < 30; y++) {
-    for (int x = 0; x < 40; x++) {
-#ifndef _LGPT_NO_SCREEN_CACHE_
-      if ((*current != *previous) || (*currentProp != *previousProp)) {
-#endif
-        props.invert_ = (*currentProp & PROP_INVERT) != 0;
-        if (((*currentProp) & 0x7F) != color) {
-          color = (ColorDefinition)((*currentProp) & 0x7F);
-          GUIColor gcolor = normalColor_;
-          switch (color) {
-          case CD_BACKGROUND:
-            gcolor = backgroundColor_;
-            break;
-          case CD_NORMAL:
-            break;
-          case CD_HILITE1:
-            gcolor = highlightColor_;
-            break;
-          case CD_HILITE2:
-            gcolor = highlight2Color_;
-            break;
-          case CD_CONSOLE:
-            gcolor = consoleColor_;
-            break;
-          case CD_CURSOR:
-            gcolor = cursorColor_;
-            break;
-
-          default:
-            NAssert(0);
-            break;
-          }
-          GUIWindow::SetColor(gcolor);
+    // Cleared before looking at the row so that a concurrent draw marks it
+    // again for the next flush
+    if (!rowDirty_[y]) {
+      continue;
+    }
+    rowDirty_[y] = false;
+    unsigned char *current = _charScreen + 40 * y;
+    unsigned char *previous = _preScreen + 40 * y;
+    unsigned char *currentProp = _charScreenProp + 40 * y;
+    unsigned char *previousProp = _preScreenProp + 40 * y;
+    int x = 0;
+    while (x < 40) {
+      if (!cellChanged(current, previous, currentProp, previousProp, x)) {
+        x++;
+        continue;
+      }
+      unsigned char prop = currentProp[x];
+      int len = 0;
+      do {
+        run[len++] = current[x++];
+      } while ((x < 40) && (currentProp[x] == prop) &&
+               cellChanged(current, previous, currentProp, previousProp, x));
+      run[len] = 0;
+
+      props.invert_ = (prop & PROP_INVERT) != 0;
+      if ((prop & 0x7F) != color) {
+        color = (ColorDefinition)(prop & 0x7F);
+        GUIColor gcolor = normalColor_;
+        switch (color) {
+        case CD_BACKGROUND:
+          gcolor = backgroundColor_;
+          break;
+        case CD_NORMAL:
+          break;
+        case CD_HILITE1:
+          gcolor = highlightColor_;
+          break;
+        case CD_HILITE2:
+          gcolor = highlight2Color_;
+          break;
+        case CD_CONSOLE:
+          gcolor = consoleColor_;
+          break;
+        case CD_CURSOR:
+          gcolor = cursorColor_;
+          break;
+
+        default:
+          NAssert(0);
+          break;
         }
-        GUIWindow::DrawChar(*current, pos, props);
-        count++;
-#ifndef _LGPT_NO_SCREEN_CACHE_
+        GUIWindow::SetColor(gcolor);
       }
-#endif
-      current++;
-      previous++;
-      currentProp++;
-      previousProp++;
-      pos._x += AppWindow::charWidth_;
+      pos._x = (x - len) * AppWindow::charWidth_;
+      pos._y = y * AppWindow::charHeight_;
+      GUIWindow::DrawString(run, pos, props, false);
+      count += len;
     }
-    pos._y += AppWindow::charHeight_;
-    pos._x = 0;
+    memcpy(previous, current, 40);
+    memcpy(previousProp, currentProp, 40);
   }
   GUIWindow::Flush();
   Unlock();
-  memcpy(_preScreen, _charScreen, 1200);
-  memcpy(_preScreenProp, _charScreenProp, 1200);
 };
 
 void AppWindow::LoadProject(const Path &p) {
@@ -330,6 +393,9 @@ void AppWindow::LoadProject(const Path &p) {
   _grooveView = new GrooveView((*this), _viewData);
   _grooveView->AddObserver(*this);
 
+  _mixerView = new MixerView((*this), _viewData);
+  _mixerView->AddObserver(*this);
+
   _currentView = _songView;
   _currentView->OnFocus();
 
@@ -366,6 +432,8 @@ void AppWindow::CloseProject() {
   SAFE_DELETE(_instrumentView);
   SAFE_DELETE(_tableView);
   SAFE_DELETE(_grooveView);
+  SAFE_DELETE(_mixerView);
+  AudioMixer::EnableMetering(false);
 
   UIController *controller = UIController::GetInstance();
   controller->Reset();
@@ -409,6 +477,8 @@ bool AppWindow::onEvent(GUIEvent &event) {
     _mask |= v;
     if (_currentView)
       _currentView->ProcessButton(_mask, true);
+    // Everything edited by a press is undone as one step
+    UndoJournal::GetInstance()->Commit();
     break;
 
   case ET_PADBUTTONUP:
@@ -494,6 +564,9 @@ void AppWindow::Update(Observable &o, I_ObservableData *d) {
     case VT_GROOVE:
       _currentView = _grooveView;
       break;
+    case VT_MIXER:
+      _currentView = _mixerView;
+      break;
     default:
       break;
     }
@@ -510,7 +583,10 @@ void AppWindow::Update(Observable &o, I_ObservableData *d) {
     if (_currentView) {
       SysMutexLocker locker(drawMutex_);
       _currentView->OnPlayerUpdate(pt->GetType(), pt->GetTickCount());
-      Invalidate();
+      // Most ticks don't change anything on screen
+      if (dirty_) {
+        Invalidate();
+      }
     }
     break;
   }
@@ -6,6 +6,7 @@
 #include "Application/Views/ConsoleView.h"
 #include "Application/Views/GrooveView.h"
 #include "Application/Views/InstrumentView.h"
+#include "Application/Views/MixerView.h"
 #include "Application/Views/NullView.h"
 #include "Application/Views/PhraseView.h"
 #include "Application/Views/ProjectView.h"
@@ -18,8 +19,6 @@
 #include "UIFramework/SimpleBaseClasses/GUIWindow.h"
 
 #define PROP_INVERT 0x80
-#define CHAR_WIDTH 10
-#define CHAR_HEIGHT 10
 #define SCREEN_WIDTH 40
 #define SCREEN_HEIGHT 30
 
@@ -62,6 +61,8 @@ protected: // GUIWindow implementation
 
   void onQuitApp();
 
+  void setRowsDirty(int top, int count);
+
 private:
   View *_currentView;
   ViewData *_viewData;
@@ -72,6 +73,7 @@ private:
   InstrumentView *_instrumentView;
   TableView *_tableView;
   GrooveView *_grooveView;
+  MixerView *_mixerView;
   NullView *_nullView;
 
   Path _root;
@@ -89,6 +91,11 @@ private:
   static unsigned char _preScreen[SCREEN_WIDTH * SCREEN_HEIGHT];
   static unsigned char _preScreenProp[SCREEN_WIDTH * SCREEN_HEIGHT];
 
+  // Rows that differ from the last flush. Each flag is a plain byte store,
+  // so drawing doesn't need to lock against the flush
+  volatile bool rowDirty_[SCREEN_HEIGHT];
+  volatile bool dirty_;
+
   static GUIColor backgroundColor_;
   static GUIColor normalColor_;
   static GUIColor highlight2Color_;
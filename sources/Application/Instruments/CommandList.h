@@ -34,6 +34,10 @@
 #define I_CMD_FBTN MAKE_FOURCC('F', 'B', 'T', 'N')
 #endif
 #define I_CMD_STOP MAKE_FOURCC('S', 'T', 'O', 'P')
+#define I_CMD_SEND MAKE_FOURCC('S', 'E', 'N', 'D')
+#define I_CMD_ENVL MAKE_FOURCC('E', 'N', 'V', 'L')
+#define I_CMD_LFO MAKE_FOURCC('L', 'F', 'O', ' ')
+#define I_CMD_EMOD MAKE_FOURCC('E', 'M', 'O', 'D')
 
 class CommandList {
 public:
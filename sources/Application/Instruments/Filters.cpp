@@ -6,6 +6,7 @@ hope it will work :D
 
 #include "Filters.h"
 #include "System/Console/Trace.h"
+#include "System/System/System.h"
 #include <math.h>
 
 static filter_t filter[8];
@@ -24,7 +25,7 @@ void init_filters(void) {
   filters_inited = true;
 }
 
-void set_filter(int channel, filterType_t type, fixed param1, fixed param2,
+AUDIO_FUNC void set_filter(int channel, filterType_t type, fixed param1, fixed param2,
                 int mix, bool bassyMapping) {
   filter_t *flt = &filter[channel];
 
@@ -71,7 +72,7 @@ void set_filter(int channel, filterType_t type, fixed param1, fixed param2,
   }
 }
 
-filter_t *get_filter(int channel) { return &filter[channel]; };
+AUDIO_FUNC filter_t *get_filter(int channel) { return &filter[channel]; };
 /*
 void filterize(int channel, fixed* buffer, long int size)
 {
@@ -13,22 +13,44 @@ const char *InstrumentTypeData[] = {"Sample", "Midi"};
 
 // Contain all instrument definition
 
-InstrumentBank::InstrumentBank() : Persistent("INSTRUMENTBANK") {
+// Sample instruments are only created when first edited or loaded so that
+// unused slots cost a pointer each. The player runs on the audio core and
+// never creates them: a slot that doesn't exist yet has no sample, so it
+// plays the shared empty instrument instead. MIDI instruments play without
+// being edited and are cheap, they're created up front
 
-  for (int i = 0; i < MAX_SAMPLEINSTRUMENT_COUNT; i++) {
-    Trace::Debug("Loading sample instrument: %i", i);
-    SampleInstrument *s = new SampleInstrument();
-    instrument_[i] = s;
+InstrumentBank::InstrumentBank() : Persistent("INSTRUMENTBANK") {
+  for (int i = 0; i < MAX_INSTRUMENT_COUNT; i++) {
+    instrument_[i] = 0;
   }
-  for (int i = 0; i < MAX_MIDIINSTRUMENT_COUNT; i++) {
-    Trace::Debug("Loading MIDI instrument: %i", i);
-    MidiInstrument *s = new MidiInstrument();
-    s->SetChannel(i);
-    instrument_[MAX_SAMPLEINSTRUMENT_COUNT + i] = s;
+  for (int i = MAX_SAMPLEINSTRUMENT_COUNT; i < MAX_INSTRUMENT_COUNT; i++) {
+    createInstrument(i, IT_MIDI);
   }
-  Status::Set("All instrument loaded") ;
+  empty_ = new SampleInstrument();
+  empty_->Init();
 };
 
+I_Instrument *InstrumentBank::createInstrument(int i, InstrumentType type) {
+  I_Instrument *instr = 0;
+  switch (type) {
+  case IT_SAMPLE:
+    Trace::Debug("Creating sample instrument: %i", i);
+    instr = new SampleInstrument();
+    break;
+  case IT_MIDI: {
+    Trace::Debug("Creating MIDI instrument: %i", i);
+    MidiInstrument *m = new MidiInstrument();
+    if (i >= MAX_SAMPLEINSTRUMENT_COUNT) {
+      m->SetChannel(i - MAX_SAMPLEINSTRUMENT_COUNT);
+    }
+    instr = m;
+  } break;
+  }
+  instr->Init();
+  instrument_[i] = instr;
+  return instr;
+}
+
 //
 // Assigns default instruments value for new project
 //
@@ -37,10 +59,11 @@ void InstrumentBank::AssignDefaults() {
 
   SamplePool *pool = SamplePool::GetInstance();
   for (int i = 0; i < MAX_SAMPLEINSTRUMENT_COUNT; i++) {
-    SampleInstrument *s = (SampleInstrument *)instrument_[i];
     if (i < pool->GetNameListSize()) {
+      SampleInstrument *s = (SampleInstrument *)GetInstrument(i);
       s->AssignSample(i);
-    } else {
+    } else if (instrument_[i]) {
+      SampleInstrument *s = (SampleInstrument *)instrument_[i];
       s->AssignSample(-1);
     }
   };
@@ -50,16 +73,26 @@ InstrumentBank::~InstrumentBank() {
   for (int i = 0; i < MAX_INSTRUMENT_COUNT; i++) {
     delete instrument_[i];
   }
+  delete empty_;
+};
+
+I_Instrument *InstrumentBank::GetInstrument(int i) {
+  if (!instrument_[i]) {
+    createInstrument(i, (i < MAX_SAMPLEINSTRUMENT_COUNT) ? IT_SAMPLE : IT_MIDI);
+  }
+  return instrument_[i];
 };
 
-I_Instrument *InstrumentBank::GetInstrument(int i) { return instrument_[i]; };
+I_Instrument *InstrumentBank::FindInstrument(int i) { return instrument_[i]; };
+
+I_Instrument *InstrumentBank::GetEmptyInstrument() { return empty_; };
 
 void InstrumentBank::SaveContent(tinyxml2::XMLPrinter *printer) {
   char hex[3];
   for (int i = 0; i < MAX_INSTRUMENT_COUNT; i++) {
 
     I_Instrument *instr = instrument_[i];
-    if (!instr->IsEmpty()) {
+    if ((instr) && (!instr->IsEmpty())) {
       printer->OpenElement("INSTRUMENT");
       hex2char(i, hex);
       printer->PushAttribute("ID",hex) ;
@@ -119,17 +152,9 @@ void InstrumentBank::RestoreContent(PersistencyDocument *doc) {
       };
       if (id < MAX_INSTRUMENT_COUNT) {
         I_Instrument *instr = instrument_[id];
-        if (instr->GetType() != it) {
+        if ((!instr) || (instr->GetType() != it)) {
           delete instr;
-          switch (it) {
-          case IT_SAMPLE:
-            instr=new SampleInstrument() ;
-            break ;
-          case IT_MIDI:
-            instr=new MidiInstrument() ;
-            break ;
-          }
-          instrument_[id] = instr;
+          instr = createInstrument(id, it);
         };
 
         bool subelem = doc->FirstChild();
@@ -186,13 +211,18 @@ void InstrumentBank::RestoreContent(PersistencyDocument *doc) {
 
 void InstrumentBank::Init() {
   for (int i = 0; i < MAX_INSTRUMENT_COUNT; i++) {
-    instrument_[i]->Init();
+    if (instrument_[i]) {
+      instrument_[i]->Init();
+    }
   }
 }
 
 unsigned short InstrumentBank::GetNext() {
   for (int i = 0; i < MAX_SAMPLEINSTRUMENT_COUNT; i++) {
     SampleInstrument *si = (SampleInstrument *)instrument_[i];
+    if (!si) {
+      return i;
+    }
     Variable *sample = si->FindVariable(SIP_SAMPLE);
     if (sample) {
       if (sample->GetInt() == -1) {
@@ -211,7 +241,7 @@ unsigned short InstrumentBank::Clone(unsigned short i) {
     return NO_MORE_INSTRUMENT;
   }
 
-  I_Instrument *src = instrument_[i];
+  I_Instrument *src = GetInstrument(i);
   I_Instrument *dst = instrument_[next];
 
   if (src == dst) {
@@ -219,13 +249,7 @@ unsigned short InstrumentBank::Clone(unsigned short i) {
   }
 
   delete dst;
-
-  if (src->GetType() == IT_SAMPLE) {
-    dst = new SampleInstrument();
-  } else {
-    dst = new MidiInstrument();
-  }
-  instrument_[next] = dst;
+  dst = createInstrument(next, src->GetType());
   IteratorPtr<Variable> it(src->GetIterator());
   for (it->Begin(); !it->IsDone(); it->Next()) {
     Variable &srcV = it->CurrentItem();
@@ -239,7 +263,9 @@ unsigned short InstrumentBank::Clone(unsigned short i) {
 
 void InstrumentBank::OnStart() {
   for (int i = 0; i < MAX_INSTRUMENT_COUNT; i++) {
-    instrument_[i]->OnStart();
+    if (instrument_[i]) {
+      instrument_[i]->OnStart();
+    }
   }
   init_filters();
 };
@@ -13,6 +13,8 @@ public:
   ~InstrumentBank();
   void AssignDefaults();
   I_Instrument *GetInstrument(int i);
+  I_Instrument *FindInstrument(int i);
+  I_Instrument *GetEmptyInstrument();
   virtual void SaveContent(tinyxml2::XMLPrinter *printer);
   virtual void RestoreContent(PersistencyDocument *doc);
   void Init();
@@ -21,7 +23,9 @@ public:
   unsigned short Clone(unsigned short i);
 
 private:
+  I_Instrument *createInstrument(int i, InstrumentType type);
   I_Instrument *instrument_[MAX_INSTRUMENT_COUNT];
+  I_Instrument *empty_; // stands for sample slots not created yet
 };
 
 #endif
@@ -1,198 +1,41 @@
-
 #include "SRPUpdaters.h"
 #include "System/Console/Trace.h"
+#include "System/System/System.h"
 #include <math.h>
-//
-// Volume Ramp
-//
-
-void VolumeRamp::SetData(float target, float speed, float start) {
-  target_ = fl2fp(target);
-  speed_ = (speed == 0) ? 0 : fl2fp(speed);
-  current_ = fl2fp(start);
-};
-
-void VolumeRamp::Trigger(bool tableTick) {
-  if (!enabled_)
-    return;
-  if (!tableTick) {
-    if (speed_ == 0) {
-      current_ = target_;
-    } else {
-      if (current_ < target_) {
-        current_ = fp_add(current_, speed_);
-        if (current_ > target_) {
-          current_ = target_;
-        }
-      } else {
-        current_ = fp_sub(current_, speed_);
-        if (current_ < target_) {
-          current_ = target_;
-        }
-      };
-    }
-  };
-};
-
-void VolumeRamp::UpdateSRP(struct RUParams &rup) {
-  if (!enabled_)
-    return;
-  rup.volumeOffset_ = fp_add(rup.volumeOffset_, current_);
-};
-
-//
-// FilterCut off ramp
-//
-
-void FCRamp::SetData(float target, float speed, float start) {
-  target_ = fl2fp(target);
-  speed_ = (speed == 0) ? 0 : fl2fp(speed);
-  current_ = fl2fp(start);
-};
-
-void FCRamp::Trigger(bool tableTick) {
-  if (!enabled_)
-    return;
-  if (!tableTick) {
-    if (speed_ == 0) {
-      current_ = target_;
-    } else {
-      if (current_ < target_) {
-        current_ = fp_add(current_, speed_);
-        if (current_ > target_) {
-          current_ = target_;
-        }
-      } else {
-        current_ = fp_sub(current_, speed_);
-        if (current_ < target_) {
-          current_ = target_;
-        }
-      };
-    }
-  };
-};
-
-void FCRamp::UpdateSRP(struct RUParams &rup) {
-  if (!enabled_)
-    return;
-  rup.cutOffset_ = fp_add(rup.cutOffset_, current_);
-};
 
 //
-// Filter Resonance ramp
+// Linear ramp (volume, pan, filter, feedback and pitch)
 //
 
-void FRRamp::SetData(float target, float speed, float start) {
-  target_ = fl2fp(target);
-  speed_ = (speed == 0) ? 0 : fl2fp(speed);
-  current_ = fl2fp(start);
-};
-
-void FRRamp::Trigger(bool tableTick) {
-  if (!enabled_)
-    return;
-  if (!tableTick) {
-    if (speed_ == 0) {
-      current_ = target_;
-    } else {
-      if (current_ < target_) {
-        current_ = fp_add(current_, speed_);
-        if (current_ > target_) {
-          current_ = target_;
-        }
-      } else {
-        current_ = fp_sub(current_, speed_);
-        if (current_ < target_) {
-          current_ = target_;
-        }
-      };
-    }
-  };
-};
-
-void FRRamp::UpdateSRP(struct RUParams &rup) {
-  if (!enabled_)
-    return;
-  rup.resOffset_ = fp_add(rup.resOffset_, current_);
-};
-
-// Feedmack mix ramp
-
-void FBMixRamp::SetData(float target, float speed, float start) {
+void LinearRamp::SetData(float target, float speed, float start) {
   target_ = fl2fp(target);
   speed_ = (speed == 0) ? 0 : fl2fp(speed);
   current_ = fl2fp(start);
 };
 
-void FBMixRamp::Trigger(bool tableTick) {
-  if (!enabled_)
-    return;
-  if (!tableTick) {
-    if (speed_ == 0) {
-      current_ = target_;
-    } else {
-      if (current_ < target_) {
-        current_ = fp_add(current_, speed_);
-        if (current_ > target_) {
-          current_ = target_;
-        }
-      } else {
-        current_ = fp_sub(current_, speed_);
-        if (current_ < target_) {
-          current_ = target_;
-        }
-      };
-    }
-  };
-};
-
-void FBMixRamp::UpdateSRP(struct RUParams &rup) {
-  if (!enabled_)
-    return;
-  rup.fbMixOffset_ = fp_add(rup.fbMixOffset_, current_);
-};
-
-// Feedmack tune ramp
-
-void FBTunRamp::SetData(float target, float speed, float start) {
-  target_ = fl2fp(target);
-  speed_ = (speed == 0) ? 0 : fl2fp(speed);
-  current_ = fl2fp(start);
-};
-
-void FBTunRamp::Trigger(bool tableTick) {
-  if (!enabled_)
-    return;
-  if (!tableTick) {
-    if (speed_ == 0) {
-      current_ = target_;
+AUDIO_FUNC void LinearRamp::Trigger() {
+  if (speed_ == 0) {
+    current_ = target_;
+  } else {
+    if (current_ < target_) {
+      current_ = fp_add(current_, speed_);
+      if (current_ > target_) {
+        current_ = target_;
+      }
     } else {
+      current_ = fp_sub(current_, speed_);
       if (current_ < target_) {
-        current_ = fp_add(current_, speed_);
-        if (current_ > target_) {
-          current_ = target_;
-        }
-      } else {
-        current_ = fp_sub(current_, speed_);
-        if (current_ < target_) {
-          current_ = target_;
-        }
-      };
-    }
-  };
-};
-
-void FBTunRamp::UpdateSRP(struct RUParams &rup) {
-  if (!enabled_)
-    return;
-  rup.fbTunOffset_ = fp_add(rup.fbTunOffset_, current_);
+        current_ = target_;
+      }
+    };
+  }
 };
 
 //
 // Speed/Frequency Ramp
 //
 
-void LogSpeedRamp::SetData(float target, float speed, float start) {
+void LogRamp::SetData(float target, float speed, float start) {
   target_ = fl2fp(target);
   current_ = fl2fp(start);
   if (target_ > current_) {
@@ -206,122 +49,27 @@ void LogSpeedRamp::SetData(float target, float speed, float start) {
   }
 };
 
-float LogSpeedRamp::GetCurrent() { return fp2fl(current_); };
+float LogRamp::GetCurrent() { return fp2fl(current_); };
 
-void LogSpeedRamp::Trigger(bool tableTick) {
-  if (!enabled_)
-    return;
-  if (!tableTick) {
-    if (speed_ == 0) {
-      current_ = target_;
+AUDIO_FUNC void LogRamp::Trigger() {
+  if (speed_ == 0) {
+    current_ = target_;
+  } else {
+    if (speed_ > FP_ONE) {
+      current_ = fp_mul(current_, speed_);
+      if (current_ > target_) {
+        current_ = target_;
+        speed_ = 0;
+      }
     } else {
-      //			if (current_<target_) {
-      if (speed_ > FP_ONE) {
+      if (current_ > target_) {
         current_ = fp_mul(current_, speed_);
-        if (current_ > target_) {
-          current_ = target_;
-          speed_ = 0;
-        }
-      } else {
-        if (current_ > target_) {
-          current_ = fp_mul(current_, speed_);
-          if (current_ < target_) {
-            current_ = target_;
-          }
-        }
-      };
-    }
-  };
-};
-
-void LogSpeedRamp::UpdateSRP(struct RUParams &rup) {
-  if (!enabled_)
-    return;
-  rup.speedOffset_ = fp_mul(rup.speedOffset_, current_);
-  //	Trace::Debug("Log: current=%f,offset
-  //now=%f",fp2fl(current_),fp2fl(rup.speedOffset_)) ;
-};
-
-//
-// Linear Speed/Frequency Ramp
-//
-
-void LinSpeedRamp::SetData(float target, float speed, float start) {
-  target_ = fl2fp(target);
-  current_ = fl2fp(start);
-
-  speed_ = (speed == 0) ? 0 : fl2fp(speed);
-};
-
-void LinSpeedRamp::Trigger(bool tableTick) {
-  if (!enabled_)
-    return;
-  if (!tableTick) {
-    if (speed_ == 0) {
-      current_ = target_;
-    } else {
-      if (current_ < target_) {
-        current_ = fp_add(current_, speed_);
-        if (current_ > target_) {
-          current_ = target_;
-        }
-      } else {
-        if (current_ > target_) {
-          current_ = fp_sub(current_, speed_);
-          if (current_ < target_) {
-            current_ = target_;
-          }
-        }
-      };
-    }
-  };
-};
-
-void LinSpeedRamp::UpdateSRP(struct RUParams &rup) {
-  if (!enabled_)
-    return;
-  rup.speedOffset_ = fp_mul(rup.speedOffset_, current_);
-};
-
-//
-// Panner
-//
-
-void Panner::SetData(float target, float speed, float start) {
-  target_ = fl2fp(target);
-  current_ = fl2fp(start);
-
-  speed_ = (speed == 0) ? 0 : fl2fp(speed);
-};
-
-void Panner::Trigger(bool tableTick) {
-  if (!enabled_)
-    return;
-  if (!tableTick) {
-    if (speed_ == 0) {
-      current_ = target_;
-    } else {
-      if (current_ < target_) {
-        current_ = fp_add(current_, speed_);
-        if (current_ > target_) {
+        if (current_ < target_) {
           current_ = target_;
         }
-      } else {
-        if (current_ > target_) {
-          current_ = fp_sub(current_, speed_);
-          if (current_ < target_) {
-            current_ = target_;
-          }
-        }
-      };
-    }
-  };
-};
-
-void Panner::UpdateSRP(struct RUParams &rup) {
-  if (!enabled_)
-    return;
-  rup.panOffset_ = fp_add(rup.panOffset_, current_);
+      }
+    };
+  }
 };
 
 //
@@ -344,10 +92,7 @@ void Arp::SetData(unsigned int value) {
   current_ = fl2fp(1.0);
 };
 
-void Arp::Trigger(bool tableTick) {
-
-  if ((!tableTick) || (!enabled_))
-    return;
+AUDIO_FUNC void Arp::Trigger() {
   if (arpLength_ > 0) {
     arpPosition_++;
     if (arpPosition_ > arpLength_) {
@@ -357,8 +102,91 @@ void Arp::Trigger(bool tableTick) {
   }
 };
 
-void Arp::UpdateSRP(struct RUParams &rup) {
-  if (!enabled_)
-    return;
-  rup.speedOffset_ = fp_mul(rup.speedOffset_, current_);
+//
+// Envelope
+//
+
+void Envelope::SetData(fixed attack, fixed decay, fixed sustain,
+                       fixed release) {
+  attack_ = attack;
+  decay_ = decay;
+  sustain_ = sustain;
+  release_ = release;
+  stage_ = ENV_ATTACK;
+};
+
+void Envelope::Release() {
+  if (stage_ != ENV_DONE) {
+    stage_ = ENV_RELEASE;
+  }
+};
+
+AUDIO_FUNC void Envelope::Trigger() {
+  switch (stage_) {
+  case ENV_ATTACK:
+    level_ = (attack_ == 0) ? FP_ONE : fp_add(level_, attack_);
+    if (level_ >= FP_ONE) {
+      level_ = FP_ONE;
+      stage_ = ENV_DECAY;
+    }
+    break;
+  case ENV_DECAY:
+    level_ = (decay_ == 0) ? sustain_ : fp_sub(level_, decay_);
+    if (level_ <= sustain_) {
+      level_ = sustain_;
+      stage_ = (sustain_ == 0) ? ENV_DONE : ENV_SUSTAIN;
+    }
+    break;
+  case ENV_RELEASE:
+    level_ = (release_ == 0) ? 0 : fp_sub(level_, release_);
+    if (level_ <= 0) {
+      level_ = 0;
+      stage_ = ENV_DONE;
+    }
+    break;
+  default:
+    break;
+  }
+};
+
+//
+// LFO
+//
+
+#define LFO_RANDOM_MUL 1664525
+#define LFO_RANDOM_ADD 1013904223
+
+void Lfo::SetData(uchar shape, fixed depth, unsigned int increment,
+                  bool restart) {
+  shape_ = shape;
+  depth_ = depth;
+  increment_ = increment;
+  if (restart) {
+    phase_ = 1 << 30; // triangle starts from the center, going up
+    random_ = random_ * LFO_RANDOM_MUL + LFO_RANDOM_ADD;
+    value_ = 0;
+  }
+};
+
+AUDIO_FUNC void Lfo::Trigger() {
+  unsigned int last = phase_;
+  phase_ += increment_;
+  int x = phase_ >> 16;
+  switch (shape_) {
+  case LFO_TRIANGLE:
+    value_ = ((x < 0x8000) ? x : 0xFFFF - x) * 2 - FP_ONE;
+    break;
+  case LFO_SQUARE:
+    value_ = (x < 0x8000) ? FP_ONE : -FP_ONE;
+    break;
+  case LFO_SAW:
+    value_ = x - FP_ONE;
+    break;
+  case LFO_RANDOM:
+    if ((phase_ < last) || (value_ == 0)) {
+      random_ = random_ * LFO_RANDOM_MUL + LFO_RANDOM_ADD;
+      value_ = int(random_ >> 16) - FP_ONE;
+    }
+    break;
+  }
 };
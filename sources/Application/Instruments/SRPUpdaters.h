@@ -1,145 +1,127 @@
 #ifndef _SRP_UPDATERS_H_
 #define _SRP_UPDATERS_H_
 
+#include "Application/Utils/fixed.h"
 #include "Foundation/Types/Types.h"
-#include "I_SRPUpdater.h"
 
-class VolumeRamp : public I_SRPUpdater {
-public:
-  VolumeRamp(){};
-  virtual ~VolumeRamp(){};
-  void SetData(float target, float speed, float start);
-  virtual void Trigger(bool tableTick);
-  virtual void UpdateSRP(struct RUParams &rup);
-
-private:
-  fixed current_;
-  fixed target_;
-  fixed speed_;
+// Voice modulators. They are plain structs held in the voice state and a
+// bitmask tells which of them run, so commands never allocate anything and
+// k-rate updates don't go through virtual calls
+
+// LFO destinations, one LFO per destination and voice
+enum LfoTarget { LFO_VOLUME = 0, LFO_CUTOFF, LFO_PAN, LFO_PITCH, LFO_LAST };
+
+enum LfoShape { LFO_TRIANGLE = 0, LFO_SQUARE, LFO_SAW, LFO_RANDOM };
+
+// Modulator slots, each one is a bit of the voice's active mask. The linear
+// ramps come first, in the order of the offsets they update
+
+enum SRPModulator {
+  SRPM_VOLUME = 0,
+  SRPM_PAN,
+  SRPM_CUTOFF,
+  SRPM_RESO,
+  SRPM_FBMIX,
+  SRPM_FBTUNE,
+  SRPM_PITCH, // linear pitch ramp, multiplies the speed
+  SRPM_LEGATO,
+  SRPM_PFIN,
+  SRPM_ARP,
+  SRPM_ENVELOPE,
+  SRPM_LFO, // first of the LFO_LAST LFO slots
+  SRPM_LAST = SRPM_LFO + LFO_LAST
 };
 
-class FCRamp : public I_SRPUpdater {
-public:
-  FCRamp(){};
-  virtual ~FCRamp(){};
-  void SetData(float target, float speed, float start);
-  virtual void Trigger(bool tableTick);
-  virtual void UpdateSRP(struct RUParams &rup);
+#define SRPM_BIT(m) (1u << (m))
+#define SRPM_OFFSETS SRPM_PITCH // number of additive destinations
+#define SRPM_RAMPS (SRPM_PITCH + 1)
 
-private:
-  fixed current_;
-  fixed target_;
-  fixed speed_;
-};
+// Modulators moving the play position
+#define SRPM_SPEED_MASK                                                        \
+  (SRPM_BIT(SRPM_PITCH) | SRPM_BIT(SRPM_LEGATO) | SRPM_BIT(SRPM_PFIN) |        \
+   SRPM_BIT(SRPM_ARP) | SRPM_BIT(SRPM_LFO + LFO_PITCH))
 
-class FRRamp : public I_SRPUpdater {
-public:
-  FRRamp(){};
-  virtual ~FRRamp(){};
-  void SetData(float target, float speed, float start);
-  virtual void Trigger(bool tableTick);
-  virtual void UpdateSRP(struct RUParams &rup);
+// What the active modulators add up to
 
-private:
-  fixed current_;
-  fixed target_;
-  fixed speed_;
+struct RUParams {
+  fixed offset_[SRPM_OFFSETS]; // added to the base volume, pan, cutoff...
+  fixed speed_;                // multiplies the base speed
+  fixed volumeScale_;          // multiplies the volume
 };
 
-class FBMixRamp : public I_SRPUpdater {
-public:
-  FBMixRamp(){};
-  virtual ~FBMixRamp(){};
-  void SetData(float target, float speed, float start);
-  virtual void Trigger(bool tableTick);
-  virtual void UpdateSRP(struct RUParams &rup);
-
-private:
-  fixed current_;
-  fixed target_;
-  fixed speed_;
-};
+// Moves linearly towards a target, one step per k-rate update
 
-class FBTunRamp : public I_SRPUpdater {
-public:
-  FBTunRamp(){};
-  virtual ~FBTunRamp(){};
+struct LinearRamp {
   void SetData(float target, float speed, float start);
-  virtual void Trigger(bool tableTick);
-  virtual void UpdateSRP(struct RUParams &rup);
+  void Trigger();
 
-private:
   fixed current_;
   fixed target_;
   fixed speed_;
 };
 
-class LogSpeedRamp : public I_SRPUpdater {
-public:
-  LogSpeedRamp(){};
-  virtual ~LogSpeedRamp(){};
-  void SetData(float target, float speed, float start);
-  float GetCurrent();
-  virtual void Trigger(bool tableTick);
-  virtual void UpdateSRP(struct RUParams &rup);
-
-private:
-  fixed current_;
-  fixed target_;
-  fixed speed_;
-};
+// Moves geometrically towards a target, for pitch
 
-class LinSpeedRamp : public I_SRPUpdater {
-public:
-  LinSpeedRamp(){};
-  virtual ~LinSpeedRamp(){};
+struct LogRamp {
   void SetData(float target, float speed, float start);
-  virtual void Trigger(bool tableTick);
-  virtual void UpdateSRP(struct RUParams &rup);
+  float GetCurrent();
+  void Trigger();
 
-private:
   fixed current_;
   fixed target_;
   fixed speed_;
 };
 
-class Arp : public I_SRPUpdater {
-public:
-  Arp(){};
-  virtual ~Arp(){};
+struct Arp {
   void SetData(uint data);
-  virtual void Trigger(bool tableTick);
-  virtual void UpdateSRP(struct RUParams &rup);
+  void Trigger(); // on table ticks
 
-private:
   uchar arp_[5];      // Arp setting
   uchar arpPosition_; // Position of in the arpegiator
   uchar arpLength_;   // Length of arp data
   fixed current_;
 };
 
-class Panner : public I_SRPUpdater {
-public:
-  Panner(){};
-  virtual ~Panner(){};
-  void SetData(float target, float speed, float start);
-  virtual void Trigger(bool tableTick);
-  virtual void UpdateSRP(struct RUParams &rup);
+// Amplitude envelope. Rates are the level change per k-rate update, 0
+// meaning the stage is immediate. Setting the data restarts the attack from
+// the current level
 
-private:
-  fixed current_;
-  fixed target_;
-  fixed speed_;
+enum EnvelopeStage {
+  ENV_ATTACK,
+  ENV_DECAY,
+  ENV_SUSTAIN,
+  ENV_RELEASE,
+  ENV_DONE
+};
+
+struct Envelope {
+  void SetData(fixed attack, fixed decay, fixed sustain, fixed release);
+  void Release();
+  void Trigger();
+  bool Done() { return stage_ == ENV_DONE; };
+
+  fixed level_;
+  fixed attack_;
+  fixed decay_;
+  fixed sustain_;
+  fixed release_;
+  uchar stage_;
+};
+
+// Low frequency oscillator, the phase wraps once per period and the output
+// goes from -depth to depth
+
+struct Lfo {
+  void SetData(uchar shape, fixed depth, unsigned int increment, bool restart);
+  void Trigger();
+  fixed GetValue() { return fp_mul(value_, depth_); };
+
+  unsigned int phase_;
+  unsigned int increment_;
+  unsigned int random_;
+  fixed value_; // -FP_ONE to FP_ONE
+  fixed depth_;
+  uchar shape_;
 };
 
-/*class Vibrato: public I_SRPUpdater {
-public:
-        Vibrato() {} ;
-        virtual ~Vibrato() {} ;
-        void SetData() ;
-        virtual void Trigger(bool tableTick) ;
-        virtual void UpdateSRP(struct RUParams &rup) ;
-private:
-} ;
-*/
 #endif
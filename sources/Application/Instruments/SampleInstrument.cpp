@@ -2,7 +2,9 @@
 #include "Application/Instruments/Filters.h"
 #include "Application/Model/Table.h"
 #include "Application/Player/PlayerMixer.h" // For MIX_BUFFER_SIZE.. kick out pls
+#include "Application/Player/RenderBudget.h"
 #include "Application/Player/SyncMaster.h"
+#include "Application/Utils/interp.h"
 #include "CommandList.h"
 #include "SamplePool.h"
 #include "SampleVariable.h"
@@ -26,19 +28,51 @@ bool SampleInstrument::useDirtyDownsampling_ = false;
 
 #define SHOULD_KILL_CLICKS false
 
+// Per channel voice state is shared by all sample instruments so that
+// instruments themselves only hold their parameters
+
+renderParams SampleInstrument::renderParams_[SONG_CHANNEL_COUNT];
+SampleInstrument *SampleInstrument::channelOwner_[SONG_CHANNEL_COUNT];
 signed char SampleInstrument::lastMidiNote_[SONG_CHANNEL_COUNT];
+SampleReader *SampleInstrument::readers_[SONG_CHANNEL_COUNT];
 
 #define KRATE_SAMPLE_COUNT 100
 
+// Kernels below take a pointer to the sample on the left of the current
+// position and return the interpolated value in fixed point. Tables hold
+// fixed point coefficients so a plain 32 bit multiply does the job
+
+static inline fixed interpolateCubic(const short *src, int stride, int phase) {
+  const fixed *c = cubicTable[phase];
+  return src[-stride] * c[0] + src[0] * c[1] + src[stride] * c[2] +
+         src[2 * stride] * c[3];
+}
+
+static inline fixed interpolateSinc(const short *src, int stride, int phase) {
+  const fixed *c = sincTable[phase];
+  const short *p = src - 3 * stride;
+  fixed result = 0;
+  for (int i = 0; i < 8; i++) {
+    result += *p * c[i];
+    p += stride;
+  }
+  return result;
+}
+
 SampleInstrument::SampleInstrument() {
 
-  // Initialize MIDI notes
+  // Initialize MIDI notes. Readers are created here rather than when the
+  // voice starts so that they're never allocated on the audio core
   for (int i = 0; i < SONG_CHANNEL_COUNT; i++) {
     SampleInstrument::lastMidiNote_[i] = -1;
+    if (!readers_[i]) {
+      readers_[i] = SampleReader::Create();
+    }
   }
 
   // Initialize instruments settings
   source_ = 0;
+  loadedSource_ = 0;
   dirty_ = false;
   running_ = false;
 
@@ -51,7 +85,8 @@ SampleInstrument::SampleInstrument() {
   Insert(volume_);
 
   interpolation_ =
-      new Variable("interpol", SIP_INTERPOLATION, interpolationTypes, 2, 0);
+      new Variable("interpol", SIP_INTERPOLATION, interpolationTypes,
+                   SIIP_LAST, 0);
   Insert(interpolation_);
 
   crush_ = new Variable("crush", SIP_CRUSH, 16);
@@ -114,28 +149,18 @@ SampleInstrument::SampleInstrument() {
   Insert(fbMix_);
 #endif
 
-  // Initalize instrument's voices update list
-
-  for (int i = 0; i < SONG_CHANNEL_COUNT; i++) {
-    renderParams *rp = renderParams_ + i;
-    rp->updaters_.push_back(&rp->volumeRamp_);
-    rp->updaters_.push_back(&rp->panner_);
-    rp->updaters_.push_back(&rp->cutRamp_);
-    rp->updaters_.push_back(&rp->resRamp_);
-    rp->updaters_.push_back(&rp->fbMixRamp_);
-    rp->updaters_.push_back(&rp->fbTunRamp_);
-    rp->updaters_.push_back(&rp->arp_);
-    rp->updaters_.push_back(&rp->speedRamp_);
-    rp->updaters_.push_back(&rp->legato_);
-    rp->updaters_.push_back(&rp->pfin_);
-  };
-
   // Reset table state
 
   tableState_.Reset();
 }
 
-SampleInstrument::~SampleInstrument() {}
+SampleInstrument::~SampleInstrument() {
+  for (int i = 0; i < SONG_CHANNEL_COUNT; i++) {
+    if (channelOwner_[i] == this) {
+      channelOwner_[i] = 0;
+    }
+  }
+}
 
 bool SampleInstrument::Init() {
 
@@ -143,12 +168,37 @@ bool SampleInstrument::Init() {
   Variable *vSample = FindVariable(SIP_SAMPLE);
   NAssert(vSample);
   int index = vSample->GetInt();
+  LoadSource();
   source_ = (index >= 0) ? pool->GetSource(index) : 0;
   tableState_.Reset();
   return false;
 }
 
-void SampleInstrument::OnStart() { tableState_.Reset(); };
+// Sample data isn't loaded when the sample variable changes, otherwise
+// scrolling through presets would load every one of them. It is loaded on
+// the UI side when the instrument is initialised, when the sample field is
+// left and when the player starts, and the previous source is released
+
+void SampleInstrument::LoadSource() {
+  SamplePool *pool = SamplePool::GetInstance();
+  int index = FindVariable(SIP_SAMPLE)->GetInt();
+  SoundSource *source = (index >= 0) ? pool->GetSource(index) : 0;
+  if (source == loadedSource_) {
+    return;
+  }
+  if (loadedSource_) {
+    pool->ReleaseSource(loadedSource_);
+  }
+  if (source) {
+    pool->LoadSource(index);
+  }
+  loadedSource_ = source;
+};
+
+void SampleInstrument::OnStart() {
+  LoadSource();
+  tableState_.Reset();
+};
 
 bool SampleInstrument::Start(int channel, unsigned char midinote,
                              bool cleanstart) {
@@ -167,6 +217,13 @@ bool SampleInstrument::Start(int channel, unsigned char midinote,
 
   renderParams *rp = renderParams_ + channel;
 
+  // Voice state left by another instrument on this channel can't be reused
+
+  if (channelOwner_[channel] != this) {
+    channelOwner_[channel] = this;
+    cleanstart = true;
+  }
+
   rp->midiNote_ = midinote;
 
   if (lastMidiNote_[channel] == -1) // To prevent First LEGA to go bonkers
@@ -338,46 +395,121 @@ bool SampleInstrument::Start(int channel, unsigned char midinote,
 
     rp->downsample_ = downsample_->GetInt();
 
-    // Disable all updaters for new voice
-
-    std::vector<I_SRPUpdater *>::iterator it;
+    // No modulator runs on a new voice, and the envelope only goes to the
+    // volume until EMOD routes it
 
-    for (it = rp->updaters_.begin(); it != rp->updaters_.end(); it++) {
-      I_SRPUpdater *current = *it;
-      current->Disable();
+    rp->activeModulators_ = 0;
+    rp->envelopeDepth_[LFO_VOLUME] = FP_ONE;
+    for (int i = LFO_CUTOFF; i < LFO_LAST; i++) {
+      rp->envelopeDepth_[i] = 0;
     }
-
-    rp->activeUpdaters_.clear();
   }
   return true;
 }
 
 void SampleInstrument::Stop(int channel) { running_ = false; }
 
-void SampleInstrument::doTickUpdate(int channel) {
+AUDIO_FUNC void SampleInstrument::doTickUpdate(int channel) {
 
-  // Process updaters
+  // Only the arpeggiator moves on ticks
 
   renderParams *rp = renderParams_ + channel;
-  std::vector<I_SRPUpdater *>::iterator it;
-
-  for (it = rp->activeUpdaters_.begin(); it != rp->activeUpdaters_.end();
-       it++) {
-    I_SRPUpdater *current = *it;
-    current->Trigger(true);
+  if (rp->IsActive(SRPM_ARP)) {
+    rp->arp_.Trigger();
   }
 };
 
-void SampleInstrument::doKRateUpdate(int channel) {
+AUDIO_FUNC void SampleInstrument::doKRateUpdate(int channel) {
 
   renderParams *rp = renderParams_ + channel;
-  std::vector<I_SRPUpdater *>::iterator it;
+  unsigned int active = rp->activeModulators_;
 
-  for (it = rp->activeUpdaters_.begin(); it != rp->activeUpdaters_.end();
-       it++) {
-    I_SRPUpdater *current = *it;
-    current->Trigger(false);
+  for (int i = 0; i < SRPM_RAMPS; i++) {
+    if (active & SRPM_BIT(i)) {
+      rp->ramps_[i].Trigger();
+    }
+  }
+  if (active & SRPM_BIT(SRPM_LEGATO)) {
+    rp->legato_.Trigger();
+  }
+  if (active & SRPM_BIT(SRPM_PFIN)) {
+    rp->pfin_.Trigger();
+  }
+  if (active & SRPM_BIT(SRPM_ENVELOPE)) {
+    rp->envelope_.Trigger();
   }
+  for (int i = 0; i < LFO_LAST; i++) {
+    if (active & SRPM_BIT(SRPM_LFO + i)) {
+      rp->lfo_[i].Trigger();
+    }
+  }
+};
+
+// Sums up what the active modulators do and applies it to the voice
+
+AUDIO_FUNC void SampleInstrument::applyModulators(renderParams *rp) {
+
+  unsigned int active = rp->activeModulators_;
+  struct RUParams rup;
+
+  for (int i = 0; i < SRPM_OFFSETS; i++) {
+    rup.offset_[i] = (active & SRPM_BIT(i)) ? rp->ramps_[i].current_ : 0;
+  }
+  rup.speed_ = FP_ONE;
+  rup.volumeScale_ = FP_ONE;
+
+  if (active & SRPM_BIT(SRPM_PITCH)) {
+    rup.speed_ = fp_mul(rup.speed_, rp->ramps_[SRPM_PITCH].current_);
+  }
+  if (active & SRPM_BIT(SRPM_LEGATO)) {
+    rup.speed_ = fp_mul(rup.speed_, rp->legato_.current_);
+  }
+  if (active & SRPM_BIT(SRPM_PFIN)) {
+    rup.speed_ = fp_mul(rup.speed_, rp->pfin_.current_);
+  }
+  if (active & SRPM_BIT(SRPM_ARP)) {
+    rup.speed_ = fp_mul(rup.speed_, rp->arp_.current_);
+  }
+  if (active & SRPM_BIT(SRPM_ENVELOPE)) {
+    fixed level = rp->envelope_.level_;
+    fixed *depth = rp->envelopeDepth_;
+    rup.volumeScale_ = FP_ONE - fp_mul(depth[LFO_VOLUME], FP_ONE - level);
+    rup.offset_[SRPM_CUTOFF] += fp_mul(depth[LFO_CUTOFF], level);
+    rup.offset_[SRPM_PAN] += fp_mul(depth[LFO_PAN], level);
+    if (depth[LFO_PITCH] != 0) {
+      rup.speed_ = fp_mul(rup.speed_, FP_ONE + fp_mul(depth[LFO_PITCH], level));
+    }
+  }
+  if (active & SRPM_BIT(SRPM_LFO + LFO_VOLUME)) {
+    rup.offset_[SRPM_VOLUME] += rp->lfo_[LFO_VOLUME].GetValue();
+  }
+  if (active & SRPM_BIT(SRPM_LFO + LFO_CUTOFF)) {
+    rup.offset_[SRPM_CUTOFF] += rp->lfo_[LFO_CUTOFF].GetValue();
+  }
+  if (active & SRPM_BIT(SRPM_LFO + LFO_PAN)) {
+    rup.offset_[SRPM_PAN] += rp->lfo_[LFO_PAN].GetValue();
+  }
+  if (active & SRPM_BIT(SRPM_LFO + LFO_PITCH)) {
+    rup.speed_ = fp_mul(rup.speed_, FP_ONE + rp->lfo_[LFO_PITCH].GetValue());
+  }
+
+  fixed volume = rp->baseVolume_ + rup.offset_[SRPM_VOLUME];
+  if (rup.volumeScale_ != FP_ONE) {
+    volume = fp_mul(volume, rup.volumeScale_);
+  }
+  rp->volume_ = (volume < 0) ? 0 : volume;
+  rp->speed_ = fp_mul(rp->baseSpeed_, rup.speed_);
+
+  // LFOs can push these outside of what the render code handles
+
+  fixed pan = rp->basePan_ + rup.offset_[SRPM_PAN];
+  rp->pan_ = (pan < 0) ? 0 : ((pan > i2fp(254)) ? i2fp(254) : pan);
+  fixed cutoff = rp->baseFCut_ + rup.offset_[SRPM_CUTOFF];
+  rp->cutoff_ = (cutoff < 0) ? 0 : ((cutoff > FP_ONE) ? FP_ONE : cutoff);
+  fixed reso = rp->baseFRes_ + rup.offset_[SRPM_RESO];
+  rp->reso_ = (reso < 0) ? 0 : ((reso > FP_ONE) ? FP_ONE : reso);
+  rp->fbMix_ = rp->baseFbMix_ + rup.offset_[SRPM_FBMIX];
+  rp->fbTun_ = rp->baseFbTun_ + rup.offset_[SRPM_FBTUNE];
 };
 
 #ifndef DISABLE_FEEDBACK
@@ -422,10 +554,36 @@ void SampleInstrument::updateFeedback(renderParams *rp) {
 }
 #endif
 
+// ENV times, in ticks
+
+static const unsigned char envelopeTicks[16] = {
+    0, 1, 2, 3, 4, 6, 9, 12, 18, 24, 36, 48, 72, 96, 144, 192};
+
+// Level change per k-rate update for an ENV time nibble, 0 is immediate
+
+static fixed envelopeRate(int time, float tickSamples) {
+  if (envelopeTicks[time] == 0) {
+    return 0;
+  }
+  fixed rate = fl2fp(KRATE_SAMPLE_COUNT / (envelopeTicks[time] * tickSamples));
+  return (rate > 0) ? rate : 1;
+}
+
+// Modulation per LFO depth step, for volume, cutoff, pan and speed ratio
+// (about a quarter of a semitone)
+
+static const float lfoDepthScale[LFO_LAST] = {8.0f, 1.0f / 30, 8.0f, 0.0144f};
+
+// Envelope modulation at the full EMOD depth (7F): the whole volume, cutoff
+// and pan ranges, and a speed ratio of about 10 semitones
+
+static const float envelopeDepthScale[LFO_LAST] = {1.0f, 1.0f, 254.0f,
+                                                   0.83f};
+
 // Size in samples
 
-bool SampleInstrument::Render(int channel, fixed *buffer, int size,
-                              bool updateTick) {
+AUDIO_FUNC bool SampleInstrument::Render(int channel, fixed *buffer, int size,
+                                         bool updateTick) {
 
   bool somethingToMix = false;
 
@@ -444,7 +602,7 @@ bool SampleInstrument::Render(int channel, fixed *buffer, int size,
 
     SYS_MEMSET(buffer, 0, size * 2 * sizeof(fixed));
 
-    bool hasUpdaters = !(rp->activeUpdaters_.empty());
+    bool hasUpdaters = (rp->activeModulators_ != 0);
 
     int filterMix = filterMix_->GetInt();
     FilterMode filterMode = (FilterMode)filterMode_->GetInt();
@@ -466,23 +624,7 @@ bool SampleInstrument::Render(int channel, fixed *buffer, int size,
       if (hasUpdaters) {
 
         doTickUpdate(channel);
-
-        struct RUParams rup;
-        rup.cutOffset_ = rup.resOffset_ = rup.volumeOffset_ = rup.panOffset_ =
-            0;
-        rup.speedOffset_ = FP_ONE;
-
-        std::vector<I_SRPUpdater *>::iterator it;
-
-        for (it = rp->activeUpdaters_.begin(); it != rp->activeUpdaters_.end();
-             it++) {
-          I_SRPUpdater *current = *it;
-          current->UpdateSRP(rup);
-        }
-
-        rp->volume_ = rp->baseVolume_ + rup.volumeOffset_;
-        rp->speed_ = fp_mul(rp->baseSpeed_, rup.speedOffset_);
-        rp->pan_ = rp->basePan_ + rup.panOffset_;
+        applyModulators(rp);
       }
 
       // Process retrig
@@ -527,9 +669,15 @@ bool SampleInstrument::Render(int channel, fixed *buffer, int size,
     SampleInstrumentLoopMode loopMode =
         (SampleInstrumentLoopMode)loopMode_->GetInt();
 
-    // Interpolation
+    // Interpolation. The render budget may ask us to use a cheaper kernel
+    // if we're getting too close to the audio deadline
 
-    int interpol = interpolation_->GetInt();
+    SampleInstrumentInterpolation interpol =
+        (SampleInstrumentInterpolation)interpolation_->GetInt();
+    int qualityCap = RenderBudget::GetInstance()->GetQualityCap(channel);
+    while (interpolationCost[interpol] > qualityCap) {
+      interpol = interpolationFallback[interpol];
+    }
 
     // Get sound characteristics
 
@@ -537,6 +685,21 @@ bool SampleInstrument::Render(int channel, fixed *buffer, int size,
 
     int channelCount = rp->channelCount_;
 
+    // If the sample has band limited mipmaps, pick the level that keeps the
+    // playback speed in the [1,2[ range. Everything below works in the
+    // coordinates of that level
+
+    int level = 0;
+    int levels = source_->GetMipmapLevels(rp->midiNote_);
+    while ((level + 1 < levels) && ((rp->speed_ >> (level + 1)) >= FP_ONE)) {
+      level++;
+    }
+    if (level > 0) {
+      wavbuf = (char *)source_->GetMipmapBuffer(rp->midiNote_, level);
+    }
+    float levelScale = float(1 << level);
+    fixed rpSpeed = rp->speed_ >> level;
+
     int count = size; // number of samples to treat
 
     fixed *result = buffer;
@@ -556,28 +719,57 @@ bool SampleInstrument::Render(int channel, fixed *buffer, int size,
 
     // Get pan multiplicators, and take volume into account
 
-    int n = int(rp->position_);
+    float levelPosition = rp->position_ / levelScale;
+    int n = int(levelPosition);
+
+    // Tell the reader which frames this block can reach (kernel taps
+    // included). The block is bounded if nothing can move the position
+    // somewhere else: no pitch modulation, no downsampling and no loop point or
+    // sample end within reach. The reader may hand back a base pointer to a
+    // copy of those frames, in which case everything below uses it
+
+    SampleReader *reader = readers_[channel];
+    int frameCount = source_->GetSize(rp->midiNote_) >> level;
+    reader->SetSample((short *)wavbuf, frameCount, channelCount);
+    int reach = int(((long long)rpSpeed * size) >> FIXED_SHIFT) + 2;
+    int windowFirst = rp->reverse_ ? n - reach - 5 : n - 3;
+    int windowLast = rp->reverse_ ? n + 4 : n + reach + 5;
+    int endFrame = rp->reverse_ ? (rp->rendLoopEnd_ >> level)
+                                : (rp->rendLoopEnd_ >> level) - 1;
+    bool pitchEnvelope =
+        rp->IsActive(SRPM_ENVELOPE) && (rp->envelopeDepth_[LFO_PITCH] != 0);
+    bool bounded = !(rp->activeModulators_ & SRPM_SPEED_MASK) &&
+                   !pitchEnvelope &&
+                   (dsMask == 0xFFFFFFFF) &&
+                   (rp->reverse_ ? windowFirst > endFrame
+                                 : windowLast < endFrame);
+    const short *readerBase = reader->Acquire(windowFirst, windowLast, bounded);
+    if (readerBase) {
+      wavbuf = (char *)readerBase;
+    }
+
     short *input = (short *)(wavbuf + 2 * channelCount *
                                           n); // input is the current
                                               // sample to the left of position
 
-    fixed fpPos = fl2fp(rp->position_ - n); // fpPos is current pos from input
-    fixed fpSpeed = rp->speed_;             // speed in fixed
+    fixed fpPos = fl2fp(levelPosition - n); // fpPos is current pos from input
+    fixed fpSpeed = rpSpeed;                // speed in fixed
     if (rp->reverse_) {
-      fpSpeed = -rp->speed_;
+      fpSpeed = -rpSpeed;
     }
 
     fixed s1, s2, t2, eta, inveta;
     s2 = 0;
     t2 = 0;
 
-    short *loopPosition =
-        (short *)(wavbuf + rp->rendLoopStart_ * 2 * channelCount);
-    short *lastSample =
-        (short *)(wavbuf + (rp->rendLoopEnd_ - 1) * 2 * channelCount);
+    int loopStart = rp->rendLoopStart_ >> level;
+    int loopEnd = rp->rendLoopEnd_ >> level;
+
+    short *loopPosition = (short *)(wavbuf + loopStart * 2 * channelCount);
+    short *lastSample = (short *)(wavbuf + (loopEnd - 1) * 2 * channelCount);
 
     if (/*(loopMode==SILM_OSCFINE)||*/ (rp->reverse_)) {
-      lastSample = (short *)(wavbuf + rp->rendLoopEnd_ * 2 * channelCount);
+      lastSample = (short *)(wavbuf + loopEnd * 2 * channelCount);
     }
 
     fixed zerofive = fl2fp(0.5f);
@@ -622,7 +814,47 @@ bool SampleInstrument::Render(int channel, fixed *buffer, int size,
     fixed *fltDelayPtr = 0;
     fixed *fltHeightPtr = 0;
 
-    short *dsBasePtr = ((short *)wavbuf) + rp->rendFirst_ * channelCount;
+    short *dsBasePtr =
+        ((short *)wavbuf) + (rp->rendFirst_ >> level) * channelCount;
+
+    // Sample boundaries, higher order kernels can't read past them
+
+    short *firstSample = (short *)wavbuf;
+    short *endSample =
+        firstSample +
+        ((source_->GetSize(rp->midiNote_) >> level) - 1) * channelCount;
+
+#ifdef USE_INTERPOLATOR
+    // interp1 steps the position. Lane 0's accumulator holds fpPos+fpSpeed,
+    // popping lane 1 returns its integer part and leaves the fraction plus
+    // the speed in it for the next sample
+
+    interp_config cfg = interp_default_config();
+    interp_config_set_mask(&cfg, 0, FIXED_SHIFT - 1);
+    interp_set_config(interp1, 0, &cfg);
+    cfg = interp_default_config();
+    interp_config_set_cross_input(&cfg, true);
+    interp_config_set_shift(&cfg, FIXED_SHIFT);
+    interp_config_set_mask(&cfg, 0, 31 - FIXED_SHIFT);
+    interp_config_set_signed(&cfg, true);
+    interp_set_config(interp1, 1, &cfg);
+    interp_set_base(interp1, 0, fpSpeed);
+    interp_set_base(interp1, 1, 0);
+    interp_set_accumulator(interp1, 0, fpPos + fpSpeed);
+    fixed interpSpeed = fpSpeed;
+
+    // interp0 does linear interpolation, blending between its bases with
+    // the top 8 bits of the position held in lane 1's accumulator
+
+    cfg = interp_default_config();
+    interp_config_set_blend(&cfg, true);
+    interp_set_config(interp0, 0, &cfg);
+    cfg = interp_default_config();
+    interp_config_set_shift(&cfg, FIXED_SHIFT - 8);
+    interp_config_set_mask(&cfg, 0, 7);
+    interp_config_set_signed(&cfg, true);
+    interp_set_config(interp0, 1, &cfg);
+#endif
 
     while (count > 0) {
 
@@ -640,9 +872,9 @@ bool SampleInstrument::Render(int channel, fixed *buffer, int size,
             input = loopPosition;
             rpReverse = (loopPosition > lastSample);
             if (rpReverse) {
-              fpSpeed = -rp->speed_;
+              fpSpeed = -rpSpeed;
             } else {
-              fpSpeed = rp->speed_;
+              fpSpeed = rpSpeed;
             }
             break;
             /*						case SILM_OSCFINE:
@@ -673,9 +905,9 @@ bool SampleInstrument::Render(int channel, fixed *buffer, int size,
             input = loopPosition;
             rpReverse = (loopPosition > lastSample);
             if (rpReverse) {
-              fpSpeed = -rp->speed_;
+              fpSpeed = -rpSpeed;
             } else {
-              fpSpeed = rp->speed_;
+              fpSpeed = rpSpeed;
             }
             break;
             /*						case SILM_OSCFINE:
@@ -707,27 +939,18 @@ bool SampleInstrument::Render(int channel, fixed *buffer, int size,
 
           if (hasUpdaters) {
             doKRateUpdate(channel);
-            struct RUParams rup;
-            rup.cutOffset_ = rup.resOffset_ = rup.volumeOffset_ =
-                rup.panOffset_ = rup.fbMixOffset_ = rup.fbTunOffset_ = 0;
-            rup.speedOffset_ = FP_ONE;
+            applyModulators(rp);
 
-            std::vector<I_SRPUpdater *>::iterator it;
+            // The voice is over once an envelope on its full volume has
+            // released. It stops running so that a note started without
+            // a clean start isn't cut again
 
-            for (it = rp->activeUpdaters_.begin();
-                 it != rp->activeUpdaters_.end(); it++) {
-              I_SRPUpdater *current = *it;
-              current->UpdateSRP(rup);
+            if (rp->IsActive(SRPM_ENVELOPE) && rp->envelope_.Done() &&
+                (rp->envelopeDepth_[LFO_VOLUME] == FP_ONE)) {
+              rp->Deactivate(SRPM_ENVELOPE);
+              *rpFinished = true;
             }
 
-            rp->volume_ = rp->baseVolume_ + rup.volumeOffset_;
-            rp->pan_ = rp->basePan_ + rup.panOffset_;
-            rp->speed_ = fp_mul(rp->baseSpeed_, rup.speedOffset_);
-            rp->cutoff_ = rp->baseFCut_ + rup.cutOffset_;
-            rp->reso_ = rp->baseFRes_ + rup.resOffset_;
-            rp->fbMix_ = rp->baseFbMix_ + rup.fbMixOffset_;
-            rp->fbTun_ = rp->baseFbTun_ + rup.fbTunOffset_;
-
             set_filter(channel, FLT_LOWPASS, rp->cutoff_, rp->reso_, filterMix,
                        bassyFilter);
             filtering = (rp->cutoff_ < i2fp(1)) || (rp->reso_ > i2fp(0));
@@ -741,15 +964,30 @@ bool SampleInstrument::Render(int channel, fixed *buffer, int size,
 #endif
             volfactor = fp_mul(rp->volume_, volscale);
             pan = fp2i(rp->pan_);
+            fixedpanl = panlaw[pan];
+            fixedpanr = panlaw[254 - pan];
 
+            rpSpeed = rp->speed_ >> level;
             if (rpReverse) {
-              fpSpeed = -rp->speed_;
+              fpSpeed = -rpSpeed;
             } else {
-              fpSpeed = rp->speed_;
+              fpSpeed = rpSpeed;
             }
           }
         }
 
+#ifdef USE_INTERPOLATOR
+        // Loops and k-rate updates may have changed the speed
+
+        if (fpSpeed != interpSpeed) {
+          fixed position = interp_get_accumulator(interp1, 0) - interpSpeed;
+          interp_set_base(interp1, 0, fpSpeed);
+          interp_set_accumulator(interp1, 0, position + fpSpeed);
+          interpSpeed = fpSpeed;
+        }
+        fpPos = interp_get_accumulator(interp1, 0) - fpSpeed;
+#endif
+
         // get input sample to interpolate from
         // s= left channel
         // t= right channel
@@ -767,6 +1005,23 @@ bool SampleInstrument::Render(int channel, fixed *buffer, int size,
 
         short *i2 = i1 + channelCount;
 
+        // Cubic and sinc need neighbours on both sides, use linear when we're
+        // too close to the edges of the sample
+
+        SampleInstrumentInterpolation kernel = interpol;
+        if (kernel == SIIP_CUBIC) {
+          if ((i1 - channelCount < firstSample) ||
+              (i1 + 2 * channelCount > endSample)) {
+            kernel = SIIP_LINEAR;
+          }
+        } else if (kernel == SIIP_SINC) {
+          if ((i1 - 3 * channelCount < firstSample) ||
+              (i1 + 4 * channelCount > endSample)) {
+            kernel = SIIP_LINEAR;
+          }
+        }
+        int phase = fpPos >> (FIXED_SHIFT - INTERPOLATION_PHASE_BITS);
+
         if (filtering) {
           fltSpeedPtr = fltSpeed;
           fltHeightPtr = fltHeight;
@@ -778,10 +1033,20 @@ bool SampleInstrument::Render(int channel, fixed *buffer, int size,
           s1 = i2fp(*i1++);
           s2 = i2fp(*i2++);
 
-          switch (interpol) {
+          switch (kernel) {
+
+          case SIIP_LINEAR:
 
-          case 0: // Linear interpolation
+#ifdef USE_INTERPOLATOR
+            // Samples go in with 7 fractional bits so the blend doesn't
+            // truncate them
 
+            interp_set_accumulator(interp0, 1, fpPos);
+            interp_set_base(interp0, 0, s1 >> 8);
+            interp_set_base(interp0, 1, s2 >> 8);
+            s1 = fixed(interp_peek_lane_result(interp0, 1)) << 8;
+            break;
+#endif
             eta = fpPos;
             inveta = fp_sub(FP_ONE, eta);
 
@@ -795,12 +1060,26 @@ bool SampleInstrument::Render(int channel, fixed *buffer, int size,
             s1 += s2;
             break;
 
-          case 1: // Nearest neighbor
+          case SIIP_NONE: // Nearest neighbor
 
             if (fpPos > zerofive) {
               s1 = s2;
             };
             break;
+
+          case SIIP_CUBIC:
+
+            s1 = interpolateCubic(i1 - 1, channelCount, phase);
+            break;
+
+          case SIIP_SINC:
+
+            s1 = interpolateSinc(i1 - 1, channelCount, phase);
+            break;
+
+          case SIIP_LAST:
+            NAssert(0);
+            break;
           }
 
 #ifndef DISABLE_FEEDBACK
@@ -918,20 +1197,37 @@ bool SampleInstrument::Render(int channel, fixed *buffer, int size,
         // Computes new pos for next input sample
         // fpPos is always relative to 'input' pointer
 
+#ifdef USE_INTERPOLATOR
+        int delta = int(interp_pop_lane_result(interp1, 1));
+#else
         fpPos = fp_add(fpPos, fpSpeed);
         int delta = fp2i(fpPos);
-        input += channelCount * delta;
         fpPos = fp_sub(fpPos, i2fp(delta));
+#endif
+        input += channelCount * delta;
         count--;
       }
     }
+#ifdef USE_INTERPOLATOR
+    fpPos = interp_get_accumulator(interp1, 0) - interpSpeed;
+#endif
+
     // Update 'reverse' mode if changed
 
     rp->reverse_ = rpReverse;
 
-    // Update final sample position
+    // Update final sample position (back in full rate coordinates)
     rp->position_ =
-        (((char *)input) - wavbuf) / (2 * channelCount) + fp2fl(fpPos);
+        ((((char *)input) - wavbuf) / (2 * channelCount) + fp2fl(fpPos)) *
+        levelScale;
+
+    // Let the reader fetch what the next block should need
+
+    if (bounded && !*rpFinished) {
+      n = int((((char *)input) - wavbuf) / (2 * channelCount));
+      reader->Advance(rpReverse ? n - reach - 5 : n - 3,
+                      rpReverse ? n + 4 : n + reach + 5);
+    }
 
 #ifndef DISABLE_FEEDBACK
     // Update feedback position
@@ -1008,6 +1304,7 @@ void SampleInstrument::Update(Observable &o, I_ObservableData *d) {
 
   switch (id) {
   case SIP_SAMPLE: {
+    // The sample data is loaded once the choice is committed, see LoadSource
     if (running_) {
       dirty_ = true; // we'll update later, when instrument gets re-triggered
     } else {
@@ -1071,10 +1368,7 @@ void SampleInstrument::ProcessCommand(int channel, FourCC cc, ushort value) {
 
   case I_CMD_ARPG: {
     rp->arp_.SetData(value);
-    if (!rp->arp_.Enabled()) {
-      rp->arp_.Enable();
-      rp->activeUpdaters_.push_back(&rp->arp_);
-    }
+    rp->Activate(SRPM_ARP);
   } break;
 
   case I_CMD_VOLM: {
@@ -1087,12 +1381,9 @@ void SampleInstrument::ProcessCommand(int channel, FourCC cc, ushort value) {
     speed = (speed == 0) ? 0
                          : fabs(targetVolume - startVolume) *
                                KRATE_SAMPLE_COUNT / float(speed) / sampleCount;
-    rp->volumeRamp_.SetData(targetVolume - baseVolume, speed,
-                            startVolume - baseVolume);
-    if (!rp->volumeRamp_.Enabled()) {
-      rp->volumeRamp_.Enable();
-      rp->activeUpdaters_.push_back(&rp->volumeRamp_);
-    }
+    rp->ramps_[SRPM_VOLUME].SetData(targetVolume - baseVolume, speed,
+                                    startVolume - baseVolume);
+    rp->Activate(SRPM_VOLUME);
   } break;
 
   case I_CMD_PAN_: {
@@ -1107,11 +1398,9 @@ void SampleInstrument::ProcessCommand(int channel, FourCC cc, ushort value) {
     speed = (speed == 0) ? 0
                          : fabs(targetPan - startPan) * KRATE_SAMPLE_COUNT /
                                float(speed) / sampleCount;
-    rp->panner_.SetData(targetPan - basePan, speed, startPan - basePan);
-    if (!rp->panner_.Enabled()) {
-      rp->panner_.Enable();
-      rp->activeUpdaters_.push_back(&rp->panner_);
-    }
+    rp->ramps_[SRPM_PAN].SetData(targetPan - basePan, speed,
+                                 startPan - basePan);
+    rp->Activate(SRPM_PAN);
   } break;
 
   case I_CMD_FCUT: {
@@ -1123,11 +1412,8 @@ void SampleInstrument::ProcessCommand(int channel, FourCC cc, ushort value) {
     speed = (speed == 0) ? 0
                          : fabs(target - start) * KRATE_SAMPLE_COUNT /
                                float(speed) / sampleCount;
-    rp->cutRamp_.SetData(target - baseCut, speed, start - baseCut);
-    if (!rp->cutRamp_.Enabled()) {
-      rp->cutRamp_.Enable();
-      rp->activeUpdaters_.push_back(&rp->cutRamp_);
-    }
+    rp->ramps_[SRPM_CUTOFF].SetData(target - baseCut, speed, start - baseCut);
+    rp->Activate(SRPM_CUTOFF);
   } break;
 
   case I_CMD_FRES: {
@@ -1139,11 +1425,8 @@ void SampleInstrument::ProcessCommand(int channel, FourCC cc, ushort value) {
     speed = (speed == 0) ? 0
                          : fabs(target - start) * KRATE_SAMPLE_COUNT /
                                float(speed) / sampleCount;
-    rp->resRamp_.SetData(target - baseRes, speed, start - baseRes);
-    if (!rp->resRamp_.Enabled()) {
-      rp->resRamp_.Enable();
-      rp->activeUpdaters_.push_back(&rp->resRamp_);
-    }
+    rp->ramps_[SRPM_RESO].SetData(target - baseRes, speed, start - baseRes);
+    rp->Activate(SRPM_RESO);
   } break;
 
     // Feedback mix
@@ -1157,11 +1440,8 @@ void SampleInstrument::ProcessCommand(int channel, FourCC cc, ushort value) {
                               int
        sampleCount=int(4*SyncMaster::GetInstance()->GetTickSampleCount()) ;
                               speed=(speed==0)?0:fabs(target-start)*KRATE_SAMPLE_COUNT/float(speed)/sampleCount
-       ; rp->fbMixRamp_.SetData(target-baseMix,speed,start-baseMix) ; if
-       (!rp->fbMixRamp_.Enabled()) { rp->fbMixRamp_.Enable() ;
-                                      rp->activeUpdaters_.push_back(&rp->fbMixRamp_)
-       ;
-                              }
+       ; rp->ramps_[SRPM_FBMIX].SetData(target-baseMix,speed,start-baseMix) ;
+                              rp->Activate(SRPM_FBMIX) ;
                       }
                       break ;
 
@@ -1176,11 +1456,8 @@ void SampleInstrument::ProcessCommand(int channel, FourCC cc, ushort value) {
                               int
        sampleCount=int(4*SyncMaster::GetInstance()->GetTickSampleCount()) ;
                               speed=(speed==0)?0:fabs(target-start)*KRATE_SAMPLE_COUNT/float(speed)/sampleCount
-       ; rp->fbTunRamp_.SetData(target-baseTune,speed,start-baseTune) ; if
-       (!rp->fbTunRamp_.Enabled()) { rp->fbTunRamp_.Enable() ;
-                                      rp->activeUpdaters_.push_back(&rp->fbTunRamp_)
-       ;
-                              }
+       ; rp->ramps_[SRPM_FBTUNE].SetData(target-baseTune,speed,start-baseTune) ;
+                              rp->Activate(SRPM_FBTUNE) ;
                       }
                       break ;
     */
@@ -1203,11 +1480,8 @@ void SampleInstrument::ProcessCommand(int channel, FourCC cc, ushort value) {
 
     // Fill ramp data & enable
 
-    rp->speedRamp_.SetData(targetSpeed, speed, srcSpeed);
-    if (!rp->speedRamp_.Enabled()) {
-      rp->speedRamp_.Enable();
-      rp->activeUpdaters_.push_back(&rp->speedRamp_);
-    }
+    rp->ramps_[SRPM_PITCH].SetData(targetSpeed, speed, srcSpeed);
+    rp->Activate(SRPM_PITCH);
   }; break;
 
   case I_CMD_LEGA: {
@@ -1237,10 +1511,7 @@ void SampleInstrument::ProcessCommand(int channel, FourCC cc, ushort value) {
     // Fill ramp data & enable
 
     rp->legato_.SetData(targetSpeed, speed, initSpeed);
-    if (!rp->legato_.Enabled()) {
-      rp->legato_.Enable();
-      rp->activeUpdaters_.push_back(&rp->legato_);
-    }
+    rp->Activate(SRPM_LEGATO);
   }; break;
 
   case I_CMD_PFIN: {
@@ -1251,7 +1522,7 @@ void SampleInstrument::ProcessCommand(int channel, FourCC cc, ushort value) {
 
     float speed = float(value >> 8); // get speed parameter
 
-    float initSpeed = rp->pfin_.Enabled() ? rp->pfin_.GetCurrent() : 1;
+    float initSpeed = rp->IsActive(SRPM_PFIN) ? rp->pfin_.GetCurrent() : 1;
     float targetSpeed = float(pow(2.0f, semi / 12.0f));
 
     // speed of ramp
@@ -1261,12 +1532,64 @@ void SampleInstrument::ProcessCommand(int channel, FourCC cc, ushort value) {
     // Fill ramp data & enable
 
     rp->pfin_.SetData(targetSpeed, speed, initSpeed);
+    rp->Activate(SRPM_PFIN);
+  }; break;
+
+  case I_CMD_ENVL: {
 
-    if (!rp->pfin_.Enabled()) {
-      rp->pfin_.Enable();
-      rp->activeUpdaters_.push_back(&rp->pfin_);
+    // ENV 0000 releases the running envelope
+
+    if (value == 0) {
+      rp->envelope_.Release();
+      break;
     }
-  }; break;
+    float tickSamples = SyncMaster::GetInstance()->GetTickSampleCount();
+    fixed sustain = i2fp((value >> 4) & 0xF) / 15;
+    if (!rp->IsActive(SRPM_ENVELOPE)) {
+      rp->envelope_.level_ = 0;
+    }
+    rp->envelope_.SetData(envelopeRate(value >> 12, tickSamples),
+                          envelopeRate((value >> 8) & 0xF, tickSamples),
+                          sustain, envelopeRate(value & 0xF, tickSamples));
+    rp->Activate(SRPM_ENVELOPE);
+  } break;
+
+  case I_CMD_EMOD: {
+
+    // EMOD a0cc sends the envelope to destination a with a signed depth cc
+
+    int target = (value >> 12) & 0x3;
+    int depth = (signed char)(value & 0xFF);
+    if (target == LFO_VOLUME) {
+      depth = (depth < 0) ? 0 : depth;
+    }
+    rp->envelopeDepth_[target] =
+        fl2fp(envelopeDepthScale[target]) * depth / 0x7F;
+    applyModulators(rp);
+  } break;
+
+  case I_CMD_LFO: {
+    int target = (value >> 12) & 0x3;
+    int shape = (value >> 14) & 0x3;
+    int depth = (value >> 8) & 0xF;
+    int period = value & 0xFF; // in ticks
+    int modulator = SRPM_LFO + target;
+
+    if (period == 0) {
+      rp->Deactivate(modulator);
+      applyModulators(rp);
+      break;
+    }
+
+    // One phase cycle (2^32) per period, advanced every k-rate update
+
+    float tickSamples = SyncMaster::GetInstance()->GetTickSampleCount();
+    unsigned int increment = (unsigned int)(4294967296.0 * KRATE_SAMPLE_COUNT /
+                                            (period * tickSamples));
+    rp->lfo_[target].SetData(shape, fl2fp(depth * lfoDepthScale[target]),
+                             increment, !rp->IsActive(modulator));
+    rp->Activate(modulator);
+  } break;
 
   case I_CMD_RTRG: {
     unsigned char loop = (value & 0xFF); // number of ticks before repeat
@@ -1289,29 +1612,8 @@ void SampleInstrument::ProcessCommand(int channel, FourCC cc, ushort value) {
         (value & 0xFF) / 255.0f; // resonance, aka Q (0=none) so default is FF00
     rp->cutoff_ = rp->baseFCut_ = fl2fp(cut);
     rp->reso_ = rp->baseFRes_ = fl2fp(res);
-    if (rp->cutRamp_.Enabled()) {
-      rp->cutRamp_.Disable();
-      std::vector<I_SRPUpdater *>::iterator it = rp->activeUpdaters_.begin();
-      while (it != rp->activeUpdaters_.end()) {
-        if (*it == &rp->cutRamp_) {
-          it = rp->activeUpdaters_.erase(it);
-          break;
-        }
-        it++;
-      }
-    }
-    if (rp->resRamp_.Enabled()) {
-      rp->resRamp_.Disable();
-      std::vector<I_SRPUpdater *>::iterator it = rp->activeUpdaters_.begin();
-      while (it != rp->activeUpdaters_.end()) {
-        if (*it == &rp->resRamp_) {
-          it = rp->activeUpdaters_.erase(it);
-          break;
-        }
-        it++;
-      }
-    }
-
+    rp->Deactivate(SRPM_CUTOFF);
+    rp->Deactivate(SRPM_RESO);
   } break;
   case I_CMD_CRSH: {
     unsigned char drive = (value >> 8);
@@ -3,6 +3,7 @@
 
 #include "I_Instrument.h"
 #include "SRPUpdaters.h"
+#include "SampleReader.h"
 #include "SampleRenderingParams.h"
 
 #include "Application/Model/Song.h"
@@ -20,6 +21,18 @@ enum SampleInstrumentLoopMode {
   SILM_LAST
 };
 
+enum SampleInstrumentInterpolation {
+  SIIP_LINEAR = 0,
+  SIIP_NONE,
+  SIIP_CUBIC,
+  SIIP_SINC,
+  SIIP_LAST
+};
+
+// Interpolation tables resolution (fractional position bits)
+#define INTERPOLATION_PHASE_BITS 6
+#define INTERPOLATION_PHASES (1 << INTERPOLATION_PHASE_BITS)
+
 #define NO_SAMPLE (-1)
 #define SIP_VOLUME MAKE_FOURCC('V', 'O', 'L', 'M')
 #define SIP_CRUSH MAKE_FOURCC('C', 'R', 'S', 'H')
@@ -79,6 +92,7 @@ public:
   virtual void Update(Observable &o, I_ObservableData *d);
   // Additional
   void AssignSample(int i);
+  void LoadSource();
   int GetSampleIndex();
   int GetVolume();
   void SetVolume(int);
@@ -92,17 +106,21 @@ protected:
   void updateInstrumentData(bool search);
   void doTickUpdate(int channel);
   void doKRateUpdate(int channel);
+  void applyModulators(renderParams *rp);
 #ifndef DISABLE_FEEDBACK
   void updateFeedback(renderParams *rp) ;
 #endif
 private:
   SoundSource *source_;
-  struct renderParams renderParams_[SONG_CHANNEL_COUNT];
+  SoundSource *loadedSource_; // source we asked the pool to load
   bool running_;
   bool dirty_;
   TableSaveState tableState_;
 
+  static struct renderParams renderParams_[SONG_CHANNEL_COUNT];
+  static SampleInstrument *channelOwner_[SONG_CHANNEL_COUNT];
   static signed char lastMidiNote_[SONG_CHANNEL_COUNT];
+  static SampleReader *readers_[SONG_CHANNEL_COUNT];
   static fixed lastSample_[SONG_CHANNEL_COUNT][2];
 #ifndef DISABLE_FEEDBACK
   static fixed feedback_[SONG_CHANNEL_COUNT][FB_BUFFER_LENGTH*2] ;
@@ -4,7 +4,16 @@ const char *loopTypes[SILM_LAST] = {"none", "loop", "oscillator",
                                     //	"oscillator fine",
                                     "looper sync"};
 
-const char *interpolationTypes[] = {"linear", "none"};
+const char *interpolationTypes[SIIP_LAST] = {"linear", "none", "cubic",
+                                             "sinc"};
+
+// Relative cost of each interpolation kernel, used to match them against the
+// quality cap given by the render budget
+const int interpolationCost[SIIP_LAST] = {1, 0, 2, 3};
+
+// Kernel to fall back to when a kernel is too expensive for the budget
+const SampleInstrumentInterpolation interpolationFallback[SIIP_LAST] = {
+    SIIP_NONE, SIIP_NONE, SIIP_LINEAR, SIIP_CUBIC};
 
 const char *filterMode[] = {"original", "bassy", "scream"};
 
@@ -15,7 +24,7 @@ enum FilterMode {
   FM_LAST
 };
 
-const fixed panlaw[] = {
+AUDIO_TABLE const fixed panlaw[] = {
     0x0,    0x808,  0xb5b,  0xde9,  0x1010, 0x11f5, 0x13ac, 0x153f, 0x16b7,
     0x1818, 0x1965, 0x1aa3, 0x1bd2, 0x1cf5, 0x1e0d, 0x1f1b, 0x2020, 0x211d,
     0x2213, 0x2302, 0x23ea, 0x24cd, 0x25ab, 0x2684, 0x2758, 0x2828, 0x28f3,
@@ -46,3 +55,143 @@ const fixed panlaw[] = {
     0x7d32, 0x7d74, 0x7db6, 0x7df7, 0x7e39, 0x7e7a, 0x7ebb, 0x7efc, 0x7f3d,
     0x7f7e, 0x7fbf, 0x8000,
 };
+
+// Interpolation kernels are sampled at INTERPOLATION_PHASES positions between
+// two samples. Coefficients are in fixed point so that multiplying them by a
+// 16 bit sample directly gives a fixed point result.
+
+// Catmull-Rom cubic hermite coefficients, taps at n-1,n,n+1,n+2
+AUDIO_TABLE const fixed cubicTable[INTERPOLATION_PHASES][4] = {
+    {0, 32768, 0, 0},
+    {-248, 32748, 272, -4},
+    {-480, 32690, 574, -16},
+    {-698, 32593, 907, -34},
+    {-900, 32460, 1268, -60},
+    {-1088, 32291, 1657, -92},
+    {-1262, 32088, 2072, -130},
+    {-1421, 31852, 2512, -175},
+    {-1568, 31584, 2976, -224},
+    {-1702, 31285, 3463, -278},
+    {-1822, 30956, 3972, -338},
+    {-1931, 30598, 4502, -401},
+    {-2028, 30212, 5052, -468},
+    {-2113, 29800, 5620, -539},
+    {-2188, 29362, 6206, -612},
+    {-2251, 28901, 6807, -689},
+    {-2304, 28416, 7424, -768},
+    {-2347, 27909, 8055, -849},
+    {-2380, 27382, 8698, -932},
+    {-2405, 26834, 9354, -1015},
+    {-2420, 26268, 10020, -1100},
+    {-2427, 25684, 10696, -1185},
+    {-2426, 25084, 11380, -1270},
+    {-2416, 24469, 12071, -1356},
+    {-2400, 23840, 12768, -1440},
+    {-2377, 23198, 13470, -1523},
+    {-2346, 22544, 14176, -1606},
+    {-2310, 21879, 14885, -1686},
+    {-2268, 21204, 15596, -1764},
+    {-2220, 20521, 16307, -1840},
+    {-2168, 19830, 17018, -1912},
+    {-2110, 19134, 17726, -1982},
+    {-2048, 18432, 18432, -2048},
+    {-1982, 17726, 19134, -2110},
+    {-1912, 17018, 19830, -2168},
+    {-1840, 16307, 20521, -2220},
+    {-1764, 15596, 21204, -2268},
+    {-1686, 14885, 21879, -2310},
+    {-1606, 14176, 22544, -2346},
+    {-1523, 13470, 23198, -2377},
+    {-1440, 12768, 23840, -2400},
+    {-1356, 12071, 24469, -2416},
+    {-1270, 11380, 25084, -2426},
+    {-1185, 10696, 25684, -2427},
+    {-1100, 10020, 26268, -2420},
+    {-1015, 9354, 26834, -2405},
+    {-932, 8698, 27382, -2380},
+    {-849, 8055, 27909, -2347},
+    {-768, 7424, 28416, -2304},
+    {-689, 6807, 28901, -2251},
+    {-612, 6206, 29362, -2188},
+    {-539, 5620, 29800, -2113},
+    {-468, 5052, 30212, -2028},
+    {-401, 4502, 30598, -1931},
+    {-338, 3972, 30956, -1822},
+    {-278, 3463, 31285, -1702},
+    {-224, 2976, 31584, -1568},
+    {-175, 2512, 31852, -1421},
+    {-130, 2072, 32088, -1262},
+    {-92, 1657, 32291, -1088},
+    {-60, 1268, 32460, -900},
+    {-34, 907, 32593, -698},
+    {-16, 574, 32690, -480},
+    {-4, 272, 32748, -248},
+};
+
+// Blackman windowed sinc coefficients, taps at n-3..n+4
+AUDIO_TABLE const fixed sincTable[INTERPOLATION_PHASES][8] = {
+    {187, -1042, 2493, 29492, 2493, -1042, 187, 0},
+    {173, -953, 2102, 29480, 2898, -1133, 201, 0},
+    {160, -865, 1723, 29446, 3315, -1226, 215, 0},
+    {148, -780, 1358, 29389, 3745, -1321, 229, 0},
+    {135, -697, 1006, 29310, 4187, -1416, 244, -1},
+    {124, -616, 668, 29207, 4640, -1513, 259, -1},
+    {112, -538, 344, 29082, 5105, -1610, 274, -1},
+    {101, -463, 34, 28936, 5581, -1708, 289, -2},
+    {91, -390, -263, 28767, 6067, -1806, 304, -2},
+    {81, -320, -545, 28577, 6563, -1905, 320, -3},
+    {72, -252, -813, 28364, 7069, -2003, 335, -4},
+    {63, -188, -1067, 28132, 7583, -2101, 350, -4},
+    {55, -126, -1307, 27876, 8107, -2197, 365, -5},
+    {47, -68, -1534, 27604, 8638, -2293, 380, -6},
+    {39, -12, -1746, 27312, 9176, -2388, 394, -7},
+    {33, 41, -1945, 26998, 9721, -2480, 408, -8},
+    {26, 90, -2130, 26668, 10272, -2571, 422, -9},
+    {20, 137, -2302, 26319, 10828, -2659, 435, -10},
+    {15, 181, -2461, 25951, 11390, -2744, 447, -11},
+    {10, 222, -2606, 25567, 11955, -2827, 459, -12},
+    {5, 260, -2739, 25166, 12524, -2905, 470, -13},
+    {1, 295, -2859, 24750, 13095, -2980, 480, -14},
+    {-2, 327, -2967, 24318, 13668, -3051, 490, -15},
+    {-6, 356, -3063, 23874, 14242, -3117, 498, -16},
+    {-9, 383, -3147, 23414, 14817, -3178, 505, -17},
+    {-11, 407, -3220, 22942, 15391, -3233, 510, -18},
+    {-13, 429, -3281, 22455, 15964, -3283, 515, -18},
+    {-15, 448, -3332, 21959, 16535, -3326, 518, -19},
+    {-17, 464, -3372, 21454, 17103, -3363, 519, -20},
+    {-18, 478, -3403, 20937, 17668, -3393, 519, -20},
+    {-19, 490, -3423, 20410, 18228, -3415, 517, -20},
+    {-19, 500, -3434, 19874, 18784, -3430, 513, -20},
+    {-20, 508, -3436, 19331, 19333, -3436, 508, -20},
+    {-20, 513, -3430, 18784, 19874, -3434, 500, -19},
+    {-20, 517, -3415, 18228, 20410, -3423, 490, -19},
+    {-20, 519, -3393, 17668, 20937, -3403, 478, -18},
+    {-20, 519, -3363, 17103, 21454, -3372, 464, -17},
+    {-19, 518, -3326, 16535, 21959, -3332, 448, -15},
+    {-18, 515, -3283, 15964, 22455, -3281, 429, -13},
+    {-18, 510, -3233, 15391, 22942, -3220, 407, -11},
+    {-17, 505, -3178, 14817, 23414, -3147, 383, -9},
+    {-16, 498, -3117, 14242, 23874, -3063, 356, -6},
+    {-15, 490, -3051, 13668, 24318, -2967, 327, -2},
+    {-14, 480, -2980, 13095, 24750, -2859, 295, 1},
+    {-13, 470, -2905, 12524, 25166, -2739, 260, 5},
+    {-12, 459, -2827, 11955, 25567, -2606, 222, 10},
+    {-11, 447, -2744, 11390, 25951, -2461, 181, 15},
+    {-10, 435, -2659, 10828, 26319, -2302, 137, 20},
+    {-9, 422, -2571, 10272, 26668, -2130, 90, 26},
+    {-8, 408, -2480, 9721, 26998, -1945, 41, 33},
+    {-7, 394, -2388, 9176, 27312, -1746, -12, 39},
+    {-6, 380, -2293, 8638, 27604, -1534, -68, 47},
+    {-5, 365, -2197, 8107, 27876, -1307, -126, 55},
+    {-4, 350, -2101, 7583, 28132, -1067, -188, 63},
+    {-4, 335, -2003, 7069, 28364, -813, -252, 72},
+    {-3, 320, -1905, 6563, 28577, -545, -320, 81},
+    {-2, 304, -1806, 6067, 28767, -263, -390, 91},
+    {-2, 289, -1708, 5581, 28936, 34, -463, 101},
+    {-1, 274, -1610, 5105, 29082, 344, -538, 112},
+    {-1, 259, -1513, 4640, 29207, 668, -616, 124},
+    {-1, 244, -1416, 4187, 29310, 1006, -697, 135},
+    {0, 229, -1321, 3745, 29389, 1358, -780, 148},
+    {0, 215, -1226, 3315, 29446, 1723, -865, 160},
+    {0, 201, -1133, 2898, 29480, 2102, -953, 173},
+};
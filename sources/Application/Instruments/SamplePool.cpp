@@ -1,4 +1,5 @@
 #include "SamplePool.h"
+#include "WavResampler.h"
 #include "Application/Persistency/PersistencyService.h"
 #include "System/Console/Trace.h"
 #include "System/io/Status.h"
@@ -127,6 +128,40 @@ void SamplePool::Load() {
 
 SoundSource *SamplePool::GetSource(int i) { return wav_[i]; };
 
+// Wav files are loaded with the pool but soundfont presets only get their
+// samples loaded once an instrument uses them
+
+bool SamplePool::LoadSource(int i) {
+  if ((i < 0) || (i >= count_) || !wav_[i]) {
+    return false;
+  }
+#ifndef DISABLESF
+  if (wav_[i]->IsMulti()) {
+    SoundFontPreset *preset = (SoundFontPreset *)wav_[i];
+#ifdef LOAD_IN_FLASH
+    return preset->LoadInFlash(flashEraseOffset_, flashWriteOffset_);
+#else
+    return preset->Load();
+#endif
+  }
+#endif
+  return true;
+};
+
+// Sources are released by pointer as purging a sample shifts the indexes,
+// one that has been purged since it was loaded has nothing left to release
+
+void SamplePool::ReleaseSource(SoundSource *source) {
+#ifndef DISABLESF
+  for (int i = 0; i < count_; i++) {
+    if ((wav_[i] == source) && source->IsMulti()) {
+      ((SoundFontPreset *)source)->Release();
+      return;
+    }
+  }
+#endif
+};
+
 char **SamplePool::GetNameList() { return names_; };
 
 int SamplePool::GetNameListSize() { return count_; };
@@ -141,6 +176,9 @@ bool SamplePool::loadSample(const char *path) {
 
   Path wavPath(path);
   WavFile *wave = WavFile::Open(path);
+  if (wave && WavResampler::NeedsResampling(wave)) {
+    wave = openResampled(wave, path);
+  }
   if (wave) {
     wav_[count_] = wave;
     const std::string name = wavPath.GetName();
@@ -150,7 +188,7 @@ bool SamplePool::loadSample(const char *path) {
 #ifdef LOAD_IN_FLASH
     wave->LoadInFlash(flashEraseOffset_, flashWriteOffset_);
 #else
-    wave->GetBuffer(0, wave->GetSize(-1));
+    wave->LoadInMemory();
 #endif
     wave->Close();
     return true;
@@ -160,6 +198,44 @@ bool SamplePool::loadSample(const char *path) {
   }
 }
 
+// Swaps a wav that isn't at the engine rate for its resampled version,
+// creating the cached file if it doesn't exist yet. The original file is kept
+// untouched so the conversion can be redone
+
+WavFile *SamplePool::openResampled(WavFile *wave, const char *path) {
+
+  std::string cachePath = WavResampler::GetCachePath(path);
+  Path cache(cachePath.c_str());
+
+  // Reuse the cache only if it matches the current sample, so a replaced
+  // sample doesn't pick up a stale conversion
+
+  WavFile *resampled = 0;
+  if (cache.Exists()) {
+    resampled = WavFile::Open(cachePath.c_str());
+    if (resampled && (resampled->GetSize(-1) !=
+                      WavResampler::GetResampledSize(wave) ||
+                      resampled->GetChannelCount(-1) !=
+                      wave->GetChannelCount(-1))) {
+      SAFE_DELETE(resampled);
+    }
+  }
+
+  if (!resampled) {
+    Status::Set("Resampling %s", Path(path).GetName().c_str());
+    WavResampler resampler(wave);
+    if (resampler.Run(cachePath.c_str())) {
+      resampled = WavFile::Open(cachePath.c_str());
+    }
+    if (!resampled) {
+      Trace::Error("Failed to resample %s", path);
+      return wave;
+    }
+  }
+  delete wave;
+  return resampled;
+}
+
 #define IMPORT_CHUNK_SIZE 1000
 
 int SamplePool::ImportSample(Path &path) {
@@ -207,6 +283,11 @@ int SamplePool::ImportSample(Path &path) {
   delete (fin);
   delete (fout);
 
+  // a sample with the same name might have been resampled before
+
+  std::string cachePath = WavResampler::GetCachePath(dstPath.GetPath().c_str());
+  FileSystem::GetInstance()->Delete(cachePath.c_str());
+
   // now load the sample
 
   bool status = loadSample(dstPath.GetPath().c_str());
@@ -231,8 +312,10 @@ void SamplePool::PurgeSample(int i) {
   // delete name entry
   SAFE_DELETE(names_[i]);
 
-  // delete file
+  // delete file and its resampled version if any
   FileSystem::GetInstance()->Delete(path.GetPath().c_str());
+  std::string cachePath = WavResampler::GetCachePath(path.GetPath().c_str());
+  FileSystem::GetInstance()->Delete(cachePath.c_str());
 
   // shift all entries from deleted to end
   for (int j = i; j < count_ - 1; j++) {
@@ -260,18 +343,13 @@ bool SamplePool::loadSoundFont(const char *path) {
     return false;
   }
 
-  // Grab the sample offset
-
-  long offset = sfGetSMPLOffset(id);
-
-  // Add all presets of the sf
+  // Add all presets of the sf, their samples are loaded on demand
 
   WORD presetCount = 0;
   SFPRESETHDRPTR pHeaders = sfGetPresetHdrs(id, &presetCount);
 
   for (int i = 0; i < presetCount; i++) {
     if (count_ < MAX_PIG_SAMPLES) {
-      sfPresetHdr current = pHeaders[i];
       wav_[count_] = new SoundFontPreset(id, i);
       const char *name = pHeaders[i].achPresetName;
       names_[count_] = (char *)SYS_MALLOC(strlen(name) + 1);
@@ -23,6 +23,8 @@ public:
   void Reset();
   ~SamplePool();
   SoundSource *GetSource(int i);
+  bool LoadSource(int i);
+  void ReleaseSource(SoundSource *source);
   char **GetNameList();
   int GetNameListSize();
   int ImportSample(Path &path);
@@ -31,6 +33,7 @@ public:
 
 protected:
   bool loadSample(const char *path);
+  WavFile *openResampled(WavFile *wave, const char *path);
   bool loadSoundFont(const char *path);
   int count_;
   char *names_[MAX_PIG_SAMPLES];
@@ -0,0 +1,177 @@
+#include "SampleReader.h"
+#include "Application/Model/Config.h"
+#include "System/Console/Trace.h"
+#include "System/System/System.h"
+#include <string.h>
+
+#ifdef PICOBUILD
+#include "hardware/dma.h"
+#include "hardware/regs/addressmap.h"
+#else
+#include "XipCacheSim.h"
+#endif
+
+#define MAX_SAMPLE_CHANNELS 2
+
+SampleReader *SampleReader::Create() {
+  const char *reader = Config::GetInstance()->GetValue("SAMPLEREADER");
+  if (reader && !strcmp(reader, "PREFETCH")) {
+    return new PrefetchSampleReader();
+  }
+  return new SampleReader();
+}
+
+SampleReader::SampleReader() : buffer_(0), frameCount_(0), channelCount_(1) {}
+
+void SampleReader::SetSample(const short *buffer, int frameCount,
+                             int channelCount) {
+  if ((buffer != buffer_) || (frameCount != frameCount_) ||
+      (channelCount != channelCount_)) {
+    buffer_ = buffer;
+    frameCount_ = frameCount;
+    channelCount_ = channelCount;
+    onSampleChange();
+  }
+}
+
+void SampleReader::clampWindow(int &first, int &last) {
+  first = (first < 0) ? 0 : first;
+  last = (last > frameCount_ - 1) ? frameCount_ - 1 : last;
+}
+
+// Direct access, the kernel reads the sample where it is
+
+const short *SampleReader::Acquire(int first, int last, bool bounded) {
+  clampWindow(first, last);
+#ifndef PICOBUILD
+  XipCacheSim::GetInstance()->Read(buffer_ + first * channelCount_,
+                                   (last - first + 1) * channelCount_ * 2);
+#endif
+  return buffer_;
+}
+
+#ifdef PICOBUILD
+// Voices take their channels from PREFETCH_DMA_FIRST up. The audio and SD
+// card drivers claim the lowest free channels, so they still find one
+// whether they start before or after the instruments are created
+
+static int claimPrefetchChannel() {
+  for (int i = PREFETCH_DMA_FIRST; i < NUM_DMA_CHANNELS; i++) {
+    if (!dma_channel_is_claimed(i)) {
+      dma_channel_claim(i);
+      return i;
+    }
+  }
+  return -1;
+}
+#endif
+
+PrefetchSampleReader::PrefetchSampleReader()
+    : current_(0), dma_(-1), pending_(false) {
+  for (int i = 0; i < 2; i++) {
+    window_[i] = (short *)SYS_MALLOC(PREFETCH_FRAMES * MAX_SAMPLE_CHANNELS *
+                                     sizeof(short));
+    first_[i] = 1;
+    last_[i] = 0;
+  }
+  if (!window_[0] || !window_[1]) {
+    Trace::Error("Not enough memory for sample prefetch windows");
+  }
+#ifdef PICOBUILD
+  dma_ = claimPrefetchChannel();
+#endif
+}
+
+PrefetchSampleReader::~PrefetchSampleReader() {
+  wait();
+#ifdef PICOBUILD
+  if (dma_ >= 0) {
+    dma_channel_unclaim(dma_);
+  }
+#endif
+  SAFE_FREE(window_[0]);
+  SAFE_FREE(window_[1]);
+}
+
+void PrefetchSampleReader::onSampleChange() {
+  wait();
+  for (int i = 0; i < 2; i++) {
+    first_[i] = 1;
+    last_[i] = 0;
+  }
+}
+
+const short *PrefetchSampleReader::Acquire(int first, int last,
+                                           bool bounded) {
+  clampWindow(first, last);
+  if (!bounded || (last - first + 1 > PREFETCH_FRAMES) || !window_[0] ||
+      !window_[1]) {
+    SampleReader::Acquire(first, last, bounded);
+    return 0;
+  }
+
+  // Use the window fetched ahead if it has what we need, fetch now if no
+  // window does
+
+  int other = current_ ^ 1;
+  if ((first >= first_[other]) && (last <= last_[other])) {
+    wait();
+    current_ = other;
+  } else if ((first < first_[current_]) || (last > last_[current_])) {
+    wait();
+    fetch(current_, first, last, true);
+  }
+  return window_[current_] - first_[current_] * channelCount_;
+}
+
+void PrefetchSampleReader::Advance(int first, int last) {
+  clampWindow(first, last);
+  if ((last < first) || (last - first + 1 > PREFETCH_FRAMES) ||
+      ((first >= first_[current_]) && (last <= last_[current_]))) {
+    return;
+  }
+  wait();
+  fetch(current_ ^ 1, first, last, false);
+}
+
+void PrefetchSampleReader::fetch(int window, int first, int last, bool wait) {
+  const short *src = buffer_ + first * channelCount_;
+  int count = (last - first + 1) * channelCount_;
+  first_[window] = first;
+  last_[window] = last;
+#ifndef PICOBUILD
+  XipCacheSim::GetInstance()->ReadUncached(count * 2);
+#endif
+
+#ifdef PICOBUILD
+  uintptr_t address = (uintptr_t)src;
+  if ((dma_ >= 0) && (address >= XIP_BASE) &&
+      (address < XIP_NOCACHE_NOALLOC_BASE)) {
+
+    // Read through the alias that neither looks up nor fills the cache
+
+    address += XIP_NOCACHE_NOALLOC_BASE - XIP_BASE;
+    dma_channel_config cfg = dma_channel_get_default_config(dma_);
+    channel_config_set_transfer_data_size(&cfg, DMA_SIZE_16);
+    channel_config_set_read_increment(&cfg, true);
+    channel_config_set_write_increment(&cfg, true);
+    dma_channel_configure(dma_, &cfg, window_[window], (const void *)address,
+                          count, true);
+    pending_ = true;
+    if (wait) {
+      this->wait();
+    }
+    return;
+  }
+#endif
+  memcpy(window_[window], src, count * sizeof(short));
+}
+
+void PrefetchSampleReader::wait() {
+#ifdef PICOBUILD
+  if (pending_) {
+    dma_channel_wait_for_finish_blocking(dma_);
+  }
+#endif
+  pending_ = false;
+}
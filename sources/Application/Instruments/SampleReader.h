@@ -0,0 +1,67 @@
+#ifndef _SAMPLE_READER_H_
+#define _SAMPLE_READER_H_
+
+// Sits between a voice and the sample data it plays. Before rendering a
+// block, the kernel tells the reader which frames it can reach and gets back
+// a base pointer to address them (base + frame * channelCount), which may
+// point to a copy of the data rather than the sample itself. After the block
+// it tells where the next one starts so the reader can fetch it ahead.
+// The backend is chosen with SAMPLEREADER in the config
+
+class SampleReader {
+public:
+  static SampleReader *Create();
+  virtual ~SampleReader(){};
+
+  // Sample data the reader works on, interleaved 16 bit frames
+  void SetSample(const short *buffer, int frameCount, int channelCount);
+
+  // Frames [first, last] are about to be read. When bounded is false the
+  // block may go outside of them (loops, pitch modulation) and the reader
+  // returns 0: the kernel then reads the sample itself
+  virtual const short *Acquire(int first, int last, bool bounded);
+
+  // The next block is expected to read frames [first, last]
+  virtual void Advance(int first, int last){};
+
+protected:
+  SampleReader();
+  virtual void onSampleChange(){};
+  void clampWindow(int &first, int &last);
+
+  const short *buffer_;
+  int frameCount_;
+  int channelCount_;
+};
+
+// Copies the frames each block needs into a per voice SRAM window so the
+// kernel doesn't go through the XIP cache that all voices share. On the pico
+// the next window is fetched by DMA from the non cached flash alias while
+// the other voices render
+
+#define PREFETCH_FRAMES 512 // per window, blocks reaching more read directly
+#define PREFETCH_DMA_FIRST 4 // lower DMA channels are left to the drivers
+
+class PrefetchSampleReader : public SampleReader {
+public:
+  PrefetchSampleReader();
+  virtual ~PrefetchSampleReader();
+  virtual const short *Acquire(int first, int last, bool bounded);
+  virtual void Advance(int first, int last);
+
+protected:
+  virtual void onSampleChange();
+
+private:
+  void fetch(int window, int first, int last, bool wait);
+  void wait();
+
+  short *window_[2];
+  int first_[2]; // frames held by each window, first_ > last_ if none
+  int last_[2];
+  int current_;  // window handed to the kernel
+  int dma_;      // -1 if no channel could be claimed
+  bool pending_; // DMA running into the other window
+};
+
+#endif
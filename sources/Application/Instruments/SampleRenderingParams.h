@@ -4,12 +4,23 @@
 
 #include "Foundation/Types/Types.h"
 #include "SRPUpdaters.h"
-#include <vector>
 
 enum FeedbackMode { FB_NONE, FB_ADD, FB_SUB };
 
+// Voice state for one song channel. Channels are monophonic and the player
+// always stops the previous instrument before starting the next one, so
+// a single set is shared by every sample instrument
+
 struct renderParams {
 
+  bool IsActive(int modulator) {
+    return (activeModulators_ & SRPM_BIT(modulator)) != 0;
+  };
+  void Activate(int modulator) { activeModulators_ |= SRPM_BIT(modulator); };
+  void Deactivate(int modulator) {
+    activeModulators_ &= ~SRPM_BIT(modulator);
+  };
+
   void *sampleBuffer_; // wavdata
   int channelCount_;
 
@@ -56,19 +67,15 @@ struct renderParams {
   fixed basePan_; // panning
   fixed pan_;
 
-  std::vector<I_SRPUpdater *> updaters_;
-  std::vector<I_SRPUpdater *> activeUpdaters_;
-
-  VolumeRamp volumeRamp_;
-  Panner panner_;
-  FCRamp cutRamp_;
-  FRRamp resRamp_;
-  FBMixRamp fbMixRamp_;
-  FBTunRamp fbTunRamp_;
-  LinSpeedRamp speedRamp_;
-  LogSpeedRamp legato_;
-  LogSpeedRamp pfin_;
+  unsigned int activeModulators_; // SRPM_BIT of the modulators that run
+
+  LinearRamp ramps_[SRPM_RAMPS]; // indexed by SRPM_VOLUME..SRPM_PITCH
+  LogRamp legato_;
+  LogRamp pfin_;
   Arp arp_;
+  Envelope envelope_;
+  fixed envelopeDepth_[LFO_LAST]; // same destinations as the LFOs
+  Lfo lfo_[LFO_LAST];
 
   bool couldClick_;
 
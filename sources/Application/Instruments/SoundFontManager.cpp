@@ -1,17 +1,48 @@
 #include "SoundFontManager.h"
+#include "System/Console/Trace.h"
 #include "System/FileSystem/FileSystem.h"
 #include "System/System/System.h"
 
-SoundFontManager::SoundFontManager(){};
+#ifdef LOAD_IN_FLASH
+#include "WavFile.h"
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+#include "pico/multicore.h"
+#endif
+
+SoundFontManager::SoundFontManager() {
+#ifdef LOAD_IN_FLASH
+  rewoundWrite_ = -1;
+  rewoundTop_ = -1;
+#endif
+};
 
 SoundFontManager::~SoundFontManager(){};
 
 void SoundFontManager::Reset() {
-  std::vector<void *>::iterator it = sampleData_.begin();
-  while (it != sampleData_.end()) {
-    SAFE_FREE(*it);
-    it = sampleData_.erase(it);
-  };
+  for (int i = 0; i < MAXLOADEDBANKS; i++) {
+    Bank &bank = banks_[i];
+    if (bank.path_.empty()) {
+      continue;
+    }
+#ifndef LOAD_IN_FLASH
+    std::vector<short *>::iterator it = bank.data_.begin();
+    while (it != bank.data_.end()) {
+      SAFE_FREE(*it);
+      it++;
+    };
+#endif
+    sfUnloadSFBank(i);
+    bank.path_.clear();
+    bank.fileStart_.clear();
+    bank.data_.clear();
+    bank.users_.clear();
+  }
+#ifdef LOAD_IN_FLASH
+  flashSamples_.clear();
+  rewoundWrite_ = -1;
+  rewoundTop_ = -1;
+#endif
 };
 
 sfBankID SoundFontManager::LoadBank(const char *path) {
@@ -20,52 +51,167 @@ sfBankID SoundFontManager::LoadBank(const char *path) {
   if (id == -1) {
     return -1;
   }
-  // open the file
 
-  I_File *fin = FileSystem::GetInstance()->Open(path, "r");
-  if (!fin) {
-    return false;
-  }
+  Bank &bank = banks_[id];
+  bank.path_ = path;
 
   // Grab the sample offset
 
-  long offset = sfGetSMPLOffset(id);
+  bank.smplOffset_ = sfGetSMPLOffset(id);
 
-  // Grab the sample headerzz
+  // Grab the sample headers
 
   WORD headerCount = 0;
   SFSAMPLEHDRPTR &headers = sfGetSampHdrs(id, &headerCount);
 
-  // Loop on every sample, load them and adapt the pointers
+  bank.fileStart_.resize(headerCount);
+  bank.data_.assign(headerCount, (short *)0);
+  bank.users_.assign(headerCount, 0);
 
-  for (int i = 0; i < headerCount; i++) {
+  // Make all addresses relative to the sample start and keep where the
+  // sample is in the file for when we need to load it. This way navigation
+  // gives offsets that are valid wherever the sample ends up
 
+  for (int i = 0; i < headerCount; i++) {
     sfSampleHdr &current = headers[i];
+    bank.fileStart_[i] = current.dwStart;
+    current.dwEnd = (current.dwEnd - current.dwStart);
+    current.dwStartloop = (current.dwStartloop - current.dwStart);
+    current.dwEndloop = (current.dwEndloop - current.dwStart);
+    current.dwStart = 0;
+  }
 
-    long from = current.dwStart * 2 + offset;
-    long to = current.dwEnd * 2 + offset;
-
-    int byteSize = to - from;
-
-    void *buffer = malloc(byteSize);
+  return id;
+};
 
-    if (buffer) {
-      fin->Seek(from, SEEK_SET);
-      fin->Read(buffer, byteSize, 1);
-    }
+short *SoundFontManager::GetSampleData(sfBankID id, int sample) {
+  Bank &bank = banks_[id];
+  if ((sample < 0) || (sample >= (int)bank.data_.size())) {
+    return 0;
+  }
+  return bank.data_[sample];
+};
 
-    // now adapt the headers so the start is the memory point
-    // and all others are sample offset
+#ifdef LOAD_IN_FLASH
+bool SoundFontManager::LoadSample(sfBankID id, int sample,
+                                  int &flashEraseOffset,
+                                  int &flashWriteOffset) {
+#else
+bool SoundFontManager::LoadSample(sfBankID id, int sample) {
+#endif
+  Bank &bank = banks_[id];
+  if ((sample < 0) || (sample >= (int)bank.data_.size())) {
+    return false;
+  }
+  bank.users_[sample]++;
+  if (bank.data_[sample]) {
+    return true;
+  }
 
-    current.dwEnd = (current.dwEnd - current.dwStart);
-    current.dwStartloop = (current.dwStartloop - current.dwStart);
-    current.dwEndloop = (current.dwEndloop - current.dwStart);
-    current.dwStart = (DWORD)buffer;
+  WORD headerCount = 0;
+  SFSAMPLEHDRPTR &headers = sfGetSampHdrs(id, &headerCount);
+  int byteSize = headers[sample].dwEnd * 2;
+
+#ifdef LOAD_IN_FLASH
+  reclaimFlash(flashEraseOffset, flashWriteOffset);
+  int flashSize = WavFile::FlashPageSize(byteSize);
+  if (flashWriteOffset + flashSize > FLASH_LIMIT) {
+    Trace::Error("Sample doesn't fit in available Flash (need: %i - avail: %i)",
+                 flashSize, FLASH_LIMIT - flashWriteOffset);
+    return false;
+  }
+#endif
 
-    sampleData_.push_back(buffer);
+  I_File *fin = FileSystem::GetInstance()->Open(bank.path_.c_str(), "r");
+  if (!fin) {
+    return false;
+  }
+  fin->Seek(bank.smplOffset_ + bank.fileStart_[sample] * 2, SEEK_SET);
+
+#ifdef LOAD_IN_FLASH
+  // Same as WavFile::LoadInFlash, nothing else can touch flash while we're
+  // writing to it. The player may be running on core1 and playing from XIP,
+  // so pause it while a page is erased and programmed, that also disables
+  // IRQs on it. Each page is read from the SD card before that so the player
+  // only waits for the flash itself
+  // https://www.raspberrypi.com/documentation/pico-sdk/high_level.html#multicore_lockout
+  short *data = (short *)(XIP_BASE + flashWriteOffset);
+  FlashSample loaded = {id, sample, flashWriteOffset, 0};
+  unsigned char page[FLASH_PAGE_SIZE];
+
+  for (int offset = 0; offset < byteSize; offset += FLASH_PAGE_SIZE) {
+    int count = byteSize - offset;
+    fin->Read(page, (count > FLASH_PAGE_SIZE) ? FLASH_PAGE_SIZE : count, 1);
+    multicore_lockout_start_blocking();
+    int irqs = save_and_disable_interrupts();
+    WavFile::EraseFlash(flashEraseOffset, flashWriteOffset, FLASH_PAGE_SIZE);
+    flash_range_program(flashWriteOffset, page, FLASH_PAGE_SIZE);
+    restore_interrupts(irqs);
+    multicore_lockout_end_blocking();
+    flashWriteOffset += FLASH_PAGE_SIZE;
+  }
+  loaded.end_ = flashWriteOffset;
+  flashSamples_.push_back(loaded);
+#else
+  short *data = (short *)SYS_MALLOC(byteSize);
+  if (data) {
+    fin->Read(data, byteSize, 1);
   }
+#endif
+
   fin->Close();
   SAFE_DELETE(fin);
 
-  return id;
-};
\ No newline at end of file
+  bank.data_[sample] = data;
+  return (data != 0);
+};
+
+// Without flash there's nothing worth reclaiming and a voice may still be
+// reading the data, so it stays until the banks are reset
+
+void SoundFontManager::ReleaseSample(sfBankID id, int sample) {
+  Bank &bank = banks_[id];
+  if ((sample < 0) || (sample >= (int)bank.users_.size())) {
+    return;
+  }
+  if (bank.users_[sample] > 0) {
+    bank.users_[sample]--;
+  }
+};
+
+#ifdef LOAD_IN_FLASH
+
+// Drops the unused samples written last. Flash is erased by sector so we can
+// only rewind to the sector boundary after the data still in use, what's
+// left of that sector is remembered so the next rewind can go past it as
+// long as nothing was written since
+
+void SoundFontManager::reclaimFlash(int &flashEraseOffset,
+                                    int &flashWriteOffset) {
+  int top = (flashWriteOffset == rewoundWrite_) ? rewoundTop_
+                                                : flashWriteOffset;
+  int used = top;
+  while (!flashSamples_.empty()) {
+    FlashSample &last = flashSamples_.back();
+    Bank &bank = banks_[last.bank_];
+    if ((last.end_ != used) || (bank.users_[last.sample_] > 0)) {
+      break;
+    }
+    bank.data_[last.sample_] = 0;
+    used = last.start_;
+    flashSamples_.pop_back();
+  }
+  if (used == top) {
+    return;
+  }
+  int sectorEnd = (used + FLASH_SECTOR_SIZE - 1) & ~(FLASH_SECTOR_SIZE - 1);
+  if (sectorEnd < flashWriteOffset) {
+    Trace::Log("SF", "Reclaimed %d bytes of flash",
+               flashWriteOffset - sectorEnd);
+    flashWriteOffset = sectorEnd;
+    flashEraseOffset = sectorEnd;
+  }
+  rewoundWrite_ = flashWriteOffset;
+  rewoundTop_ = used;
+};
+#endif
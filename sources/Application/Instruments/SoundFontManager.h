@@ -3,16 +3,54 @@
 
 #include "Externals/Soundfont/ENAB.H"
 #include "Foundation/T_Singleton.h"
+#include <string>
 #include <vector>
 
+// Keeps track of the loaded banks. Only the articulation data is loaded
+// with the bank, sample data is loaded on demand when a preset using it is
+// loaded so we don't waste memory on unused samples. Every preset loaded
+// counts as a user of its samples until it is released
+
 class SoundFontManager : public T_Singleton<SoundFontManager> {
 public:
   SoundFontManager();
   ~SoundFontManager();
   void Reset();
   sfBankID LoadBank(const char *path);
+#ifdef LOAD_IN_FLASH
+  bool LoadSample(sfBankID id, int sample, int &flashEraseOffset,
+                  int &flashWriteOffset);
+#else
+  bool LoadSample(sfBankID id, int sample);
+#endif
+  void ReleaseSample(sfBankID id, int sample);
+  // Returns 0 if the sample isn't loaded
+  short *GetSampleData(sfBankID id, int sample);
 
 private:
-  std::vector<void *> sampleData_;
+  struct Bank {
+    std::string path_;
+    long smplOffset_;              // sample chunk offset in file (bytes)
+    std::vector<DWORD> fileStart_; // sample start in sample chunk (samples)
+    std::vector<short *> data_;    // loaded sample data
+    std::vector<unsigned short> users_;
+  };
+  Bank banks_[MAXLOADEDBANKS];
+
+#ifdef LOAD_IN_FLASH
+  // Flash is written like a stack, samples nobody uses any more can only be
+  // given back while they're on top of it
+  void reclaimFlash(int &flashEraseOffset, int &flashWriteOffset);
+
+  struct FlashSample {
+    sfBankID bank_;
+    int sample_;
+    int start_; // flash offset of the sample
+    int end_;
+  };
+  std::vector<FlashSample> flashSamples_;
+  int rewoundWrite_; // write offset we rewound flash to
+  int rewoundTop_;   // end of the data still in use below it
+#endif
 };
 #endif
@@ -1,11 +1,11 @@
 #include "SoundFontPreset.h"
-#include "Externals/Soundfont/ENAB.H"
+#include "Externals/Soundfont/SFNAV.H"
+#include "SoundFontManager.h"
 #include "System/Console/Trace.h"
 
 SoundFontPreset::SoundFontPreset(int sfID, int presetID)
-    : sfID_(sfID), presetID_(presetID), vect_(0), lastNote_(-1) {
-  navigator_.SetHydraFont(GetHydraPtr(sfID)); // would be bank select
-};
+    : sfID_(sfID), presetID_(presetID), zonesBuilt_(false), zone_(0),
+      data_(0), lastNote_(-1), users_(0){};
 
 SoundFontPreset::~SoundFontPreset() {}
 
@@ -17,34 +17,32 @@ int SoundFontPreset::GetChannelCount(int note) {
 
 void *SoundFontPreset::GetSampleBuffer(int note) {
   checkNote(note);
-  if (vect_) {
-    return (void *)vect_->dwStart;
+  if (zone_ && data_) {
+    return (void *)(data_ + zone_->start_);
   };
   return 0;
 };
 
 int SoundFontPreset::GetSampleRate(int note) {
   checkNote(note);
-  if (vect_) {
-    return vect_->dwSampleRate;
+  if (zone_) {
+    return zone_->sampleRate_;
   };
   return 44100;
 };
 
 int SoundFontPreset::GetSize(int note) {
   checkNote(note);
-  if (vect_) {
-    return vect_->dwEnd;
+  if (zone_) {
+    return zone_->end_ - zone_->start_;
   };
   return 0;
 };
 
 int SoundFontPreset::GetRootNote(int note) {
   checkNote(note);
-  if (vect_) {
-    twoByteUnion tbu;
-    tbu.wVal = vect_->shOrigKeyAndCorr;
-    return tbu.byVals.by1;
+  if (zone_) {
+    return zone_->rootKey_;
   };
   return 60;
 };
@@ -53,31 +51,132 @@ bool SoundFontPreset::IsMulti() { return true; };
 
 bool SoundFontPreset::IsLooped(int note) {
   checkNote(note);
-  return ((vect_->shSampleModes & 0x1) != 0);
+  return zone_ && zone_->looped_;
 };
 
 int SoundFontPreset::GetLoopStart(int note) {
   checkNote(note);
-  if (vect_) {
-    return (IsLooped(note)) ? vect_->dwStartloop : -1;
+  if (zone_) {
+    return (IsLooped(note)) ? zone_->loopStart_ - zone_->start_ : -1;
   }
   return -1;
 };
 
 int SoundFontPreset::GetLoopEnd(int note) {
   checkNote(note);
-  if (vect_) {
-    return vect_->dwEndloop;
+  if (zone_) {
+    return zone_->loopEnd_ - zone_->start_;
   }
   return -1;
 };
 
+// Navigates the articulation data once for every key and keeps the result
+// as a list of key ranges, so playing a note is a short lookup instead of a
+// full navigation and we don't need to keep a navigator per preset
+
+void SoundFontPreset::buildZones() {
+
+  zonesBuilt_ = true;
+
+  SoundFontNavigator *navigator = new SoundFontNavigator();
+  navigator->SetHydraFont(GetHydraPtr(sfID_)); // would be bank select
+
+  for (int key = 0; key < 128; key++) {
+    navigator->Navigate(presetID_, key, 127);
+    if (navigator->GetNOsc() == 0) {
+      continue;
+    }
+    sfData *vect = navigator->GetSFPtr();
+    twoByteUnion tbu;
+    tbu.wVal = vect->shOrigKeyAndCorr;
+
+    SoundFontZone zone;
+    zone.loKey_ = key;
+    zone.hiKey_ = key;
+    zone.rootKey_ = tbu.byVals.by1;
+    zone.looped_ = ((vect->shSampleModes & 0x1) != 0);
+    zone.sample_ = navigator->GetSampleIndex(0);
+    zone.sampleRate_ = vect->dwSampleRate;
+    zone.start_ = vect->dwStart;
+    zone.end_ = vect->dwEnd;
+    zone.loopStart_ = vect->dwStartloop;
+    zone.loopEnd_ = vect->dwEndloop;
+
+    // Extend the previous zone if this key plays the same thing
+
+    if (!zones_.empty()) {
+      SoundFontZone &last = zones_.back();
+      if ((last.hiKey_ == key - 1) && (last.rootKey_ == zone.rootKey_) &&
+          (last.looped_ == zone.looped_) && (last.sample_ == zone.sample_) &&
+          (last.start_ == zone.start_) && (last.end_ == zone.end_) &&
+          (last.loopStart_ == zone.loopStart_) &&
+          (last.loopEnd_ == zone.loopEnd_)) {
+        last.hiKey_ = key;
+        continue;
+      }
+    }
+    zones_.push_back(zone);
+  }
+  zones_.shrink_to_fit();
+  delete navigator;
+
+  Trace::Log("SF", "Preset %d has %d zones", presetID_, (int)zones_.size());
+};
+
+#ifdef LOAD_IN_FLASH
+bool SoundFontPreset::LoadInFlash(int &flashEraseOffset,
+                                  int &flashWriteOffset) {
+#else
+bool SoundFontPreset::Load() {
+#endif
+  if (users_++ > 0) {
+    return true;
+  }
+  if (!zonesBuilt_) {
+    buildZones();
+  }
+  SoundFontManager *sfm = SoundFontManager::GetInstance();
+  bool loaded = true;
+  for (unsigned int i = 0; i < zones_.size(); i++) {
+#ifdef LOAD_IN_FLASH
+    loaded &= sfm->LoadSample(sfID_, zones_[i].sample_, flashEraseOffset,
+                              flashWriteOffset);
+#else
+    loaded &= sfm->LoadSample(sfID_, zones_[i].sample_);
+#endif
+  }
+  // pick up the data of the samples we just loaded
+  if (zone_) {
+    data_ = sfm->GetSampleData(sfID_, zone_->sample_);
+  }
+  return loaded;
+};
+
+// Once nobody uses the preset its samples may be reclaimed, so forget the
+// data we picked and look it up again on the next note
+
+void SoundFontPreset::Release() {
+  if ((users_ == 0) || (--users_ > 0)) {
+    return;
+  }
+  SoundFontManager *sfm = SoundFontManager::GetInstance();
+  for (unsigned int i = 0; i < zones_.size(); i++) {
+    sfm->ReleaseSample(sfID_, zones_[i].sample_);
+  }
+  data_ = 0;
+  lastNote_ = -1;
+};
+
 void SoundFontPreset::checkNote(int note) {
   if (note != lastNote_) {
-    navigator_.Navigate(presetID_, note, 127);
-    int oscCount = navigator_.GetNOsc();
-    if (oscCount != 0) {
-      vect_ = navigator_.GetSFPtr();
+    for (unsigned int i = 0; i < zones_.size(); i++) {
+      SoundFontZone &zone = zones_[i];
+      if ((note >= zone.loKey_) && (note <= zone.hiKey_)) {
+        zone_ = &zone;
+        data_ = SoundFontManager::GetInstance()->GetSampleData(sfID_,
+                                                               zone.sample_);
+        break;
+      }
     }
     lastNote_ = note;
   }
@@ -2,8 +2,24 @@
 #define _SOUNDFONT_PRESET_H_
 
 #include "Externals/Soundfont/ENAB.H"
-#include "Externals/Soundfont/SFNAV.H"
 #include "SoundSource.h"
+#include <vector>
+
+// Key range of a preset played by a single sample, as given by navigating
+// the articulation data. Addresses are in frames relative to the sample start
+
+struct SoundFontZone {
+  unsigned char loKey_;
+  unsigned char hiKey_;
+  unsigned char rootKey_;
+  bool looped_;
+  unsigned short sample_; // sample header index
+  DWORD sampleRate_;
+  DWORD start_;
+  DWORD end_;
+  DWORD loopStart_;
+  DWORD loopEnd_;
+};
 
 class SoundFontPreset : public SoundSource {
 public:
@@ -20,14 +36,27 @@ public:
 
   bool IsLooped(int loop);
 
+  // Loads the samples used by the preset, until then it stays silent. Each
+  // load needs a matching release, the samples are only loaded the first time
+#ifdef LOAD_IN_FLASH
+  bool LoadInFlash(int &flashEraseOffset, int &flashWriteOffset);
+#else
+  bool Load();
+#endif
+  void Release();
+
 protected:
+  void buildZones();
   void checkNote(int note);
 
 private:
   int sfID_;
   int presetID_;
-  sfData *vect_;
+  std::vector<SoundFontZone> zones_;
+  bool zonesBuilt_;
+  SoundFontZone *zone_; // zone of the last note
+  short *data_;         // sample data of the last note
   int lastNote_;
-  SoundFontNavigator navigator_;
+  int users_;
 };
 #endif
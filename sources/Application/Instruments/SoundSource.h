@@ -1,6 +1,11 @@
 #ifndef _SOUND_SOURCE_H_
 #define _SOUND_SOURCE_H_
 
+// Min/max peak cache used to display the waveform. Level 0 splits the whole
+// sample in PEAK_COUNT buckets, each following level halves the count
+#define PEAK_COUNT 256
+#define PEAK_LEVELS 4
+
 class SoundSource {
 public:
   SoundSource(){};
@@ -11,6 +16,15 @@ public:
   virtual int GetSampleRate(int note) = 0;
   virtual int GetChannelCount(int note) = 0;
   virtual void *GetSampleBuffer(int note) = 0;
+  // Band limited versions of the sample, each level at half the rate of the
+  // previous one. Level 0 is the sample itself
+  virtual int GetMipmapLevels(int note) { return 1; };
+  virtual void *GetMipmapBuffer(int note, int level) {
+    return (level == 0) ? GetSampleBuffer(note) : 0;
+  };
+  // Min and max (top 8 bits) of each bucket of a peak cache level,
+  // interleaved. Null if the source has no peak cache
+  virtual const signed char *GetPeaks(int level) { return 0; };
   virtual bool IsMulti() = 0;
   virtual int GetRootNote(int note) = 0;
 };
@@ -4,19 +4,21 @@
 #include "Foundation/Types/Types.h"
 #include "Services/Time/TimeService.h"
 #include "System/Console/Trace.h"
+#include "System/System/System.h"
+#include <assert.h>
 #include <stdlib.h>
+#include <string.h>
 
 #ifdef LOAD_IN_FLASH
 #include "hardware/flash.h"
 #include "hardware/sync.h"
-
-// Raspberry pi pico has 2MB of Flash
-#define FLASH_LIMIT (2 * 1024 * 1024)
 #endif
 
 int WavFile::bufferChunkSize_ = -1;
 bool WavFile::initChunkSize_ = true;
-unsigned char WavFile::readBuffer_[512];
+bool WavFile::useMipmaps_ = false;
+// Word aligned so conversion kernels can work on 32 bit words
+unsigned char WavFile::readBuffer_[512] __attribute__((aligned(4)));
 
 short Swap16(short from) {
 #ifdef __ppc__
@@ -42,18 +44,120 @@ int Swap32(int from) {
 #endif
 }
 
+// Triangular dither noise in 1/256th of a 16 bit step. A plain LCG is
+// plenty for this and cheap on the M0+
+static unsigned int ditherSeed = 0x1234567;
+
+static inline int dither() {
+  ditherSeed = ditherSeed * 1664525 + 1013904223;
+  return int((ditherSeed >> 24) & 0xFF) - int((ditherSeed >> 16) & 0xFF);
+}
+
+// Reduces a 24 bit value to 16 bit with dither
+static inline short reduce24(int value) {
+  value = (value + dither() + 128) >> 8;
+  if (value > 32767) {
+    value = 32767;
+  } else if (value < -32768) {
+    value = -32768;
+  }
+  return short(value);
+}
+
+// Conversion kernels: 'count' samples are converted in place to 16 bit. For
+// the formats bigger than 16 bits, the output never overtakes the input so we
+// can go forward and work a word at a time
+
+static void convert8(unsigned char *buffer, int count) {
+  short *dst = (short *)buffer;
+  for (int i = count - 1; i >= 0; i--) {
+    dst[i] = (buffer[i] - 128) * 256;
+  }
+}
+
+static void convert16(unsigned char *buffer, int count) {
+  short *dst = (short *)buffer;
+  for (int i = 0; i < count; i++) {
+    dst[i] = Swap16(dst[i]);
+  }
+}
+
+static void convert24(unsigned char *buffer, int count) {
+  int i = 0;
+#ifndef __ppc__
+  // Four samples are packed in three words
+  const unsigned int *src = (const unsigned int *)buffer;
+  unsigned int *dst = (unsigned int *)buffer;
+  for (; i + 4 <= count; i += 4) {
+    unsigned int w0 = src[0];
+    unsigned int w1 = src[1];
+    unsigned int w2 = src[2];
+    src += 3;
+    short s0 = reduce24(int(w0 << 8) >> 8);
+    short s1 = reduce24(int((w0 >> 24) << 8 | (w1 << 16)) >> 8);
+    short s2 = reduce24(int((w1 >> 16) << 8 | (w2 << 24)) >> 8);
+    short s3 = reduce24(int(w2) >> 8);
+    *dst++ = (unsigned short)s0 | ((unsigned int)(unsigned short)s1 << 16);
+    *dst++ = (unsigned short)s2 | ((unsigned int)(unsigned short)s3 << 16);
+  }
+#endif
+  short *dst16 = (short *)buffer;
+  for (; i < count; i++) {
+    unsigned char *src8 = buffer + 3 * i;
+    int value = src8[0] << 8 | src8[1] << 16 | src8[2] << 24;
+    dst16[i] = reduce24(value >> 8);
+  }
+}
+
+static void convert32(unsigned char *buffer, int count) {
+  const int *src = (const int *)buffer;
+  short *dst = (short *)buffer;
+  for (int i = 0; i < count; i++) {
+    dst[i] = reduce24(Swap32(src[i]) >> 8);
+  }
+}
+
+static void convertFloat(unsigned char *buffer, int count) {
+  const int *src = (const int *)buffer;
+  short *dst = (short *)buffer;
+  for (int i = 0; i < count; i++) {
+    int word = Swap32(src[i]);
+    float value;
+    memcpy(&value, &word, 4);
+    value *= 8388608.0f;
+    if (value > 8388607.0f) {
+      value = 8388607.0f;
+    } else if (value < -8388608.0f) {
+      value = -8388608.0f;
+    }
+    dst[i] = reduce24(int(value));
+  }
+}
+
 WavFile::WavFile(I_File *file) {
   if (initChunkSize_) {
     const char *size = Config::GetInstance()->GetValue("SAMPLELOADCHUNKSIZE");
     if (size) {
       bufferChunkSize_ = atoi(size);
     }
+    const char *mipmaps = Config::GetInstance()->GetValue("SAMPLEMIPMAPS");
+    useMipmaps_ = (mipmaps && !strcmp(mipmaps, "YES"));
     initChunkSize_ = false;
   }
   samples_ = 0;
+#ifndef LOAD_IN_FLASH
+  memory_ = 0;
+#endif
+  for (int i = 0; i < MAX_MIPMAP_LEVELS; i++) {
+    mipmaps_[i] = 0;
+  }
+  mipmapLevels_ = 1;
+  peaks_ = 0;
   size_ = 0;
   readBufferSize_ = 0;
   sampleBufferSize_ = 0;
+  bytePerSample_ = 2;
+  isFloat_ = false;
   file_ = file;
 };
 
@@ -63,7 +167,7 @@ WavFile::~WavFile() {
     delete file_;
   }
 #ifndef LOAD_IN_FLASH
-  SAFE_FREE(samples_) ;
+  SAFE_FREE(memory_);
 #endif
 };
 
@@ -154,12 +258,6 @@ WavFile *WavFile::Open(const char *path) {
   memcpy(&comp, wav->readBuffer_, 2);
   comp = Swap16(comp);
 
-  if (comp != 1) {
-    Trace::Error("Unsupported compression");
-    delete wav;
-    return 0;
-  }
-
   // Read NumChannels (mono/Stereo)
 
   unsigned short nChannels;
@@ -184,13 +282,36 @@ WavFile *WavFile::Open(const char *path) {
   memcpy(&bitPerSample, wav->readBuffer_, 2);
   bitPerSample = Swap16(bitPerSample);
 
-  if ((bitPerSample != 16) && (bitPerSample != 8)) {
-    Trace::Error("Only 8/16 bit supported");
+  // Extensible headers store the actual format in the sub format GUID,
+  // after cbSize, valid bits and channel mask
+
+  if ((comp == WAVE_FORMAT_EXTENSIBLE) && (offset >= 24)) {
+    wav->readBlock(position + 8, 2);
+    memcpy(&comp, wav->readBuffer_, 2);
+    comp = Swap16(comp);
+  }
+
+  if ((comp != WAVE_FORMAT_PCM) && (comp != WAVE_FORMAT_IEEE_FLOAT)) {
+    Trace::Error("Unsupported compression");
+    delete wav;
+    return 0;
+  }
+
+  if (comp == WAVE_FORMAT_IEEE_FLOAT) {
+    if (bitPerSample != 32) {
+      Trace::Error("Only 32 bit float supported");
+      delete wav;
+      return 0;
+    }
+  } else if ((bitPerSample != 8) && (bitPerSample != 16) &&
+             (bitPerSample != 24) && (bitPerSample != 32)) {
+    Trace::Error("Only 8/16/24/32 bit supported");
     delete wav;
     return 0;
   };
   bitPerSample /= 8;
   wav->bytePerSample_ = bitPerSample;
+  wav->isFloat_ = (comp == WAVE_FORMAT_IEEE_FLOAT);
 
   // some bad files have bigger chunks
 
@@ -241,10 +362,27 @@ int WavFile::GetChannelCount(int note) { return channelCount_; };
 
 int WavFile::GetSampleRate(int note) { return sampleRate_; };
 
+int WavFile::GetMipmapLevels(int note) { return mipmapLevels_; };
+
+void *WavFile::GetMipmapBuffer(int note, int level) {
+  return (level == 0) ? samples_ : mipmaps_[level];
+};
+
+const signed char *WavFile::GetPeaks(int level) {
+  if (!peaks_) {
+    return 0;
+  }
+  signed char *peaks = peaks_;
+  for (int l = 0; l < level; l++) {
+    peaks += 2 * (PEAK_COUNT >> l);
+  }
+  return peaks;
+};
+
 long WavFile::readBlock(long start, long size) {
   // Read buffer is a fixed size, nothing should be requested bigger than this
   // TODO: remove size option and work with what we have
-  assert((unsigned long)size < FLASH_PAGE_SIZE);
+  assert((unsigned long)size <= sizeof(readBuffer_));
   if (size > readBufferSize_) {
     readBufferSize_ = size;
   }
@@ -254,11 +392,11 @@ long WavFile::readBlock(long start, long size) {
 };
 
 bool WavFile::GetBuffer(long start, long size) {
-  // TODO: Many of the calculations in this function don't make any
-  // sense anymore, refactor
-  // 64 bits is the maximum size we can read without overflowing
-  // readBuffer_ in the worst case scenario
-  assert((unsigned long)size < FLASH_PAGE_SIZE / 2);
+  // Samples are converted in place so both the file data and its 16 bit
+  // version need to fit in the read buffer. 64 stereo frames is the most we
+  // can do with 32 bit files
+  assert(size * channelCount_ * (bytePerSample_ > 2 ? bytePerSample_ : 2) <=
+         (long)sizeof(readBuffer_));
   samples_ = (short *)readBuffer_;
 
   // compute the file buffer size we need to read
@@ -271,15 +409,12 @@ bool WavFile::GetBuffer(long start, long size) {
 
   int count = bufferSize;
   int offset = 0;
-  char *ptr = (char *)samples_;
-  int readSize = (bufferChunkSize_ > 0) ? bufferChunkSize_
-                 : count > 4096         ? 4096
-                                        : count;
+  int readSize = (bufferChunkSize_ > 0) ? bufferChunkSize_ : count;
 
   while (count > 0) {
     readSize = (count > readSize) ? readSize : count;
-    readBlock(bufferStart, readSize);
-    memcpy(ptr + offset, readBuffer_, readSize);
+    file_->Seek(bufferStart, SEEK_SET);
+    file_->Read(readBuffer_ + offset, readSize, 1);
     bufferStart += readSize;
     count -= readSize;
     offset += readSize;
@@ -287,26 +422,125 @@ bool WavFile::GetBuffer(long start, long size) {
       TimeService::GetInstance()->Sleep(1);
   }
 
-  // expand 8 bit data if needed
+  convertSamples(readBuffer_, size * channelCount_);
+  return true;
+};
 
-  unsigned char *src = (unsigned char *)samples_;
-  short *dst = samples_;
-  for (int i = size - 1; i >= 0; i--) {
-    if (bytePerSample_ == 1) {
-      dst[i] = (src[i] - 128) * 256;
-    } else {
-      *dst = Swap16(*dst);
-      dst++;
-      if (channelCount_ > 1) {
-        *dst = Swap16(*dst);
-        dst++;
-      }
+void WavFile::convertSamples(unsigned char *buffer, int count) {
+  ConvertSamples(buffer, count, bytePerSample_, isFloat_);
+}
+
+void WavFile::ConvertSamples(unsigned char *buffer, int count,
+                             int bytePerSample, bool isFloat) {
+  if (isFloat) {
+    convertFloat(buffer, count);
+    return;
+  }
+  switch (bytePerSample) {
+  case 1:
+    convert8(buffer, count);
+    break;
+  case 2:
+    convert16(buffer, count);
+    break;
+  case 3:
+    convert24(buffer, count);
+    break;
+  case 4:
+    convert32(buffer, count);
+    break;
+  }
+}
+
+#ifndef LOAD_IN_FLASH
+// Loads the whole sample in a buffer of its own. The file is read and
+// converted one read buffer at a time, the same way it goes to flash
+
+bool WavFile::LoadInMemory() {
+
+  sampleBufferSize_ = 2 * channelCount_ * size_;
+  memory_ = (short *)SYS_MALLOC(sampleBufferSize_);
+  if (!memory_) {
+    Trace::Error("Not enough memory to load sample (need: %i)",
+                 sampleBufferSize_);
+    return false;
+  }
+
+  int frameSize = channelCount_ * bytePerSample_;
+  int chunkFrames = sizeof(readBuffer_) /
+                    (channelCount_ * (bytePerSample_ > 2 ? bytePerSample_ : 2));
+
+  for (int frame = 0; frame < size_; frame += chunkFrames) {
+    int count = size_ - frame;
+    if (count > chunkFrames) {
+      count = chunkFrames;
     }
+    file_->Seek(dataPosition_ + frame * frameSize, SEEK_SET);
+    file_->Read(readBuffer_, count * frameSize, 1);
+    convertSamples(readBuffer_, count * channelCount_);
+    memcpy(memory_ + frame * channelCount_, readBuffer_,
+           count * channelCount_ * sizeof(short));
   }
+  samples_ = memory_;
   return true;
-};
+}
+#endif
 
 #ifdef LOAD_IN_FLASH
+// Rounds a size in bytes up to a multiple of the flash page size
+int WavFile::FlashPageSize(int size) {
+  return ((size / FLASH_PAGE_SIZE) + ((size % FLASH_PAGE_SIZE) != 0)) *
+         FLASH_PAGE_SIZE;
+}
+
+// If data doesn't fit in previously erased sectors, erase additional ones
+void WavFile::EraseFlash(int &flashEraseOffset, int flashWriteOffset,
+                         int size) {
+  if (size > (flashEraseOffset - flashWriteOffset)) {
+    int additionalData = size - flashEraseOffset + flashWriteOffset;
+    int sectorsToErase = ((additionalData / FLASH_SECTOR_SIZE) +
+                          ((additionalData % FLASH_SECTOR_SIZE) != 0)) *
+                         FLASH_SECTOR_SIZE;
+    Trace::Debug("About to erase %i sectors in flash region 0x%X - 0x%X",
+                 sectorsToErase, flashEraseOffset,
+                 flashEraseOffset + sectorsToErase);
+    // Erase required number of sectors
+    flash_range_erase(flashEraseOffset, sectorsToErase);
+    // Move erase pointer to new position
+    flashEraseOffset += sectorsToErase;
+  }
+}
+
+// Half band filter used to build mipmaps, taps sum up to 32
+static const int halfBand[] = {-1, 0, 9, 16, 9, 0, -1};
+
+// Computes 'count' frames of the half rate version of 'src' starting at
+// frame 'first' of the result
+static void decimate(const short *src, int srcSize, int channelCount,
+                     short *dst, int first, int count) {
+  for (int i = first; i < first + count; i++) {
+    for (int c = 0; c < channelCount; c++) {
+      int acc = 0;
+      for (int k = 0; k < 7; k++) {
+        int pos = 2 * i + k - 3;
+        if (pos < 0) {
+          pos = 0;
+        } else if (pos >= srcSize) {
+          pos = srcSize - 1;
+        }
+        acc += halfBand[k] * src[pos * channelCount + c];
+      }
+      acc >>= 5;
+      if (acc > 32767) {
+        acc = 32767;
+      } else if (acc < -32768) {
+        acc = -32768;
+      }
+      *dst++ = short(acc);
+    }
+  }
+}
+
 bool WavFile::LoadInFlash(int &flashEraseOffset, int &flashWriteOffset) {
 
   // Size needed in flash before accounting for page size
@@ -314,8 +548,7 @@ bool WavFile::LoadInFlash(int &flashEraseOffset, int &flashWriteOffset) {
   // Store the size of samples
   sampleBufferSize_ = FlashBaseBufferSize;
   // Size actually occupied in flash
-  int FlashPageBufferSize =
-    ((FlashBaseBufferSize / FLASH_PAGE_SIZE) + ((FlashBaseBufferSize % FLASH_PAGE_SIZE) != 0)) * FLASH_PAGE_SIZE;
+  int FlashPageBufferSize = FlashPageSize(FlashBaseBufferSize);
 
   if (flashWriteOffset + FlashPageBufferSize > FLASH_LIMIT) {
     Trace::Error("Sample doesn't fit in available Flash (need: %i - avail: %i)", FlashPageBufferSize, FLASH_LIMIT - flashWriteOffset);
@@ -332,78 +565,177 @@ bool WavFile::LoadInFlash(int &flashEraseOffset, int &flashWriteOffset) {
 
   // If data doesn't fit in previously erased page, we'll have to erase
   // additional ones
-  if (FlashPageBufferSize > (flashEraseOffset - flashWriteOffset)) {
-    int additionalData =
-        FlashPageBufferSize - flashEraseOffset +
-      flashWriteOffset;
-    int sectorsToErase =
-      ((additionalData / FLASH_SECTOR_SIZE) + ((additionalData % FLASH_SECTOR_SIZE) != 0)) * FLASH_SECTOR_SIZE;
-    Trace::Debug("About to erase %i sectors in flash region 0x%X - 0x%X",
-                 sectorsToErase, flashEraseOffset,
-                 flashEraseOffset + sectorsToErase);
-    // Erase required number of sectors
-    flash_range_erase(flashEraseOffset, sectorsToErase);
-    // Move erase pointer to new position
-    flashEraseOffset += sectorsToErase;
+  EraseFlash(flashEraseOffset, flashWriteOffset, FlashPageBufferSize);
+
+  // Convert a flash page worth of frames at a time. The file data for it
+  // is at most twice as big (32 bit), which still fits the read buffer
+  int pageFrames = FLASH_PAGE_SIZE / (2 * channelCount_);
+  int frameSize = channelCount_ * bytePerSample_;
+
+  // Peaks are gathered while the data goes through so the sample never
+  // needs to be scanned again. If there's no memory left we do without
+  signed char *peaks =
+      (size_ > 0) ? (signed char *)SYS_MALLOC(2 * PEAK_COUNT) : 0;
+  if (peaks) {
+    for (int i = 0; i < PEAK_COUNT; i++) {
+      peaks[2 * i] = 127;
+      peaks[2 * i + 1] = -128;
+    }
   }
 
-  // Actual buffer needed to read whole file (may be lower than
-  // FlashBaseBufferSize if it's an 8bit sample)
-  int bufferSize = size_ * channelCount_ * bytePerSample_;
-  // Where the data starts in the WAV (after header)
-  int bufferStart = dataPosition_;
-
-  // Read the buffer but in small chunk to let the system breathe
-  // if the files are big
-  uint count = bufferSize;
-  uint offset = 0;
-  uint readSize = count > FLASH_PAGE_SIZE ? FLASH_PAGE_SIZE : count;
+  for (int frame = 0; frame < size_; frame += pageFrames) {
+    int count = size_ - frame;
+    if (count > pageFrames) {
+      count = pageFrames;
+    }
+    file_->Seek(dataPosition_ + frame * frameSize, SEEK_SET);
+    file_->Read(readBuffer_, count * frameSize, 1);
 
-  while (count > 0) {
-    readSize = (count > readSize) ? readSize : count;
-    
-    file_->Seek(bufferStart, SEEK_SET);
-    file_->Read(readBuffer_, readSize, 1);
-
-    // Have to expand 8 bit data (if needed) before writing to flash
-    unsigned char *src = (unsigned char *)readBuffer_;
-    short *dst = (short *)readBuffer_;
-    for (int i = readSize - 1; i >= 0; i--) {
-      if (bytePerSample_ == 1) {
-        dst[i] = (src[i] - 128) * 256;
-      } else {
-        *dst = Swap16(*dst);
-        dst++;
-        if (channelCount_ > 1) {
-          *dst = Swap16(*dst);
-          dst++;
-        }
-      }
+    convertSamples(readBuffer_, count * channelCount_);
+    if (peaks) {
+      accumulatePeaks(peaks, (short *)readBuffer_, frame, count);
     }
 
-    // We need to write double the bytes if we needed to expand to 16 bit
-    // Write size will be either 256 (which is the flash page size) or 512
-    int writeSize = (bytePerSample_ == 1) ? readSize * 2 : readSize;
-    // Adjust to page size
-    writeSize = ((writeSize / FLASH_PAGE_SIZE) +
-                 ((writeSize % FLASH_PAGE_SIZE) != 0)) * FLASH_PAGE_SIZE;
-
-    // There will be trash at the end, but sampleBufferSize_ gives me the
-    // bounds
-    Trace::Debug("About to write %i sectors in flash region 0x%X - 0x%X", writeSize,
-                 flashWriteOffset + offset,
-                 flashWriteOffset + offset + writeSize);
-      flash_range_program(flashWriteOffset + offset, (uint8_t *)readBuffer_,
-                          writeSize);
-      bufferStart += readSize;
-      count -= readSize;
-      flashWriteOffset += writeSize;
+    // There will be trash at the end of the last page, but
+    // sampleBufferSize_ gives me the bounds
+    Trace::Debug("About to write %i bytes in flash region 0x%X - 0x%X",
+                 FLASH_PAGE_SIZE, flashWriteOffset,
+                 flashWriteOffset + FLASH_PAGE_SIZE);
+    flash_range_program(flashWriteOffset, (uint8_t *)readBuffer_,
+                        FLASH_PAGE_SIZE);
+    flashWriteOffset += FLASH_PAGE_SIZE;
+  }
+
+  if (useMipmaps_) {
+    buildMipmaps(flashEraseOffset, flashWriteOffset);
+  }
+
+  if (peaks) {
+    buildPeaks(peaks, flashEraseOffset, flashWriteOffset);
+    SAFE_FREE(peaks);
   }
 
   // Lastly we restore the IRQs
   restore_interrupts(irqs);
   return true;
 };
+
+// Builds half rate versions of the sample right after it in flash, each
+// level being filtered down from the previous one. Mipmaps are optional, if
+// we run out of flash the sample just uses the levels that fit
+void WavFile::buildMipmaps(int &flashEraseOffset, int &flashWriteOffset) {
+
+  // Frames that fit in a flash page, that's what we compute at once
+  int pageFrames = FLASH_PAGE_SIZE / (2 * channelCount_);
+
+  mipmapLevels_ = 1;
+  for (int level = 1; level < MAX_MIPMAP_LEVELS; level++) {
+    int srcSize = size_ >> (level - 1);
+    int levelSize = size_ >> level;
+    if (levelSize < MIN_MIPMAP_SIZE) {
+      break;
+    }
+    int levelBufferSize = FlashPageSize(2 * channelCount_ * levelSize);
+    if (flashWriteOffset + levelBufferSize > FLASH_LIMIT) {
+      Trace::Log("WAV", "No flash left for mipmap level %d", level);
+      break;
+    }
+    EraseFlash(flashEraseOffset, flashWriteOffset, levelBufferSize);
+
+    const short *src = (level == 1) ? samples_ : mipmaps_[level - 1];
+    mipmaps_[level] = (short *)(XIP_BASE + flashWriteOffset);
+
+    for (int first = 0; first < levelSize; first += pageFrames) {
+      int count = levelSize - first;
+      if (count > pageFrames) {
+        count = pageFrames;
+      }
+      decimate(src, srcSize, channelCount_, (short *)readBuffer_, first,
+               count);
+      flash_range_program(flashWriteOffset, (uint8_t *)readBuffer_,
+                          FLASH_PAGE_SIZE);
+      flashWriteOffset += FLASH_PAGE_SIZE;
+    }
+    mipmapLevels_ = level + 1;
+  }
+}
+
+// Updates the finest peak level with 'count' converted frames starting at
+// frame 'first' of the sample
+void WavFile::accumulatePeaks(signed char *peaks, const short *src, int first,
+                              int count) {
+  int bucket = int((long long)first * PEAK_COUNT / size_);
+  int next = int(((long long)(bucket + 1) * size_ + PEAK_COUNT - 1) /
+                 PEAK_COUNT);
+  signed char *peak = peaks + 2 * bucket;
+  for (int i = first; i < first + count; i++) {
+    while (i >= next) {
+      bucket++;
+      peak += 2;
+      next = int(((long long)(bucket + 1) * size_ + PEAK_COUNT - 1) /
+                 PEAK_COUNT);
+    }
+    for (int c = 0; c < channelCount_; c++) {
+      signed char v = (*src++) >> 8;
+      if (v < peak[0]) {
+        peak[0] = v;
+      }
+      if (v > peak[1]) {
+        peak[1] = v;
+      }
+    }
+  }
+}
+
+// Writes the peak cache after the sample in flash. Level 0 comes from the
+// peaks gathered at load time, each following level merges pairs of the
+// previous one. Like mipmaps, the cache is optional
+void WavFile::buildPeaks(signed char *peaks, int &flashEraseOffset,
+                         int &flashWriteOffset) {
+
+  // Samples shorter than PEAK_COUNT leave empty buckets, repeat the
+  // previous one
+  for (int i = 0; i < PEAK_COUNT; i++) {
+    if (peaks[2 * i] > peaks[2 * i + 1]) {
+      peaks[2 * i] = (i > 0) ? peaks[2 * i - 2] : 0;
+      peaks[2 * i + 1] = (i > 0) ? peaks[2 * i - 1] : 0;
+    }
+  }
+
+  // Level 0 fills whole pages, the other levels share the next ones
+  int levelSize = 2 * PEAK_COUNT;
+  int restSize = 0;
+  for (int level = 1; level < PEAK_LEVELS; level++) {
+    restSize += 2 * (PEAK_COUNT >> level);
+  }
+  int peakBufferSize = FlashPageSize(levelSize) + FlashPageSize(restSize);
+  if (flashWriteOffset + peakBufferSize > FLASH_LIMIT) {
+    Trace::Log("WAV", "No flash left for peak cache");
+    return;
+  }
+  EraseFlash(flashEraseOffset, flashWriteOffset, peakBufferSize);
+  peaks_ = (signed char *)(XIP_BASE + flashWriteOffset);
+
+  flash_range_program(flashWriteOffset, (uint8_t *)peaks,
+                      FlashPageSize(levelSize));
+  flashWriteOffset += FlashPageSize(levelSize);
+
+  const signed char *src = peaks;
+  signed char *dst = (signed char *)readBuffer_;
+  for (int level = 1; level < PEAK_LEVELS; level++) {
+    int count = PEAK_COUNT >> level;
+    for (int i = 0; i < count; i++) {
+      const signed char *a = src + 4 * i;
+      dst[2 * i] = (a[0] < a[2]) ? a[0] : a[2];
+      dst[2 * i + 1] = (a[1] > a[3]) ? a[1] : a[3];
+    }
+    src = dst;
+    dst += 2 * count;
+  }
+  flash_range_program(flashWriteOffset, (uint8_t *)readBuffer_,
+                      FlashPageSize(restSize));
+  flashWriteOffset += FlashPageSize(restSize);
+}
 #endif
 
 void WavFile::Close() {
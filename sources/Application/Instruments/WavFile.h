@@ -5,6 +5,19 @@
 #include "SoundSource.h"
 #include "System/FileSystem/FileSystem.h"
 
+#define MAX_MIPMAP_LEVELS 3 // full, half and quarter rate
+#define MIN_MIPMAP_SIZE 64  // don't bother with mipmaps under this size
+
+#ifdef LOAD_IN_FLASH
+// Raspberry pi pico has 2MB of Flash
+#define FLASH_LIMIT (2 * 1024 * 1024)
+#endif
+
+// fmt chunk format codes we know about
+#define WAVE_FORMAT_PCM 0x0001
+#define WAVE_FORMAT_IEEE_FLOAT 0x0003
+#define WAVE_FORMAT_EXTENSIBLE 0xFFFE
+
 class WavFile : public SoundSource {
 
 protected: // Factory - see Load method
@@ -18,15 +31,36 @@ public:
   virtual int GetSampleRate(int note);
   virtual int GetChannelCount(int note);
   virtual int GetRootNote(int note);
+  virtual int GetMipmapLevels(int note);
+  virtual void *GetMipmapBuffer(int note, int level);
+  virtual const signed char *GetPeaks(int level);
   bool GetBuffer(long start, long sampleCount); // values in smples
+#ifndef LOAD_IN_FLASH
+  bool LoadInMemory();
+#endif
 #ifdef LOAD_IN_FLASH
   bool LoadInFlash(int &flashEraseOffset, int &flashWriteOffset);
+  // Helpers shared with other sources storing samples in flash
+  static int FlashPageSize(int size);
+  static void EraseFlash(int &flashEraseOffset, int flashWriteOffset,
+                         int size);
 #endif
   void Close();
   virtual bool IsMulti() { return false; };
+  // Converts 'count' samples of the given file format in place to 16 bit
+  static void ConvertSamples(unsigned char *buffer, int count,
+                             int bytePerSample, bool isFloat);
 
 protected:
   long readBlock(long position, long count);
+  void convertSamples(unsigned char *buffer, int count);
+#ifdef LOAD_IN_FLASH
+  void buildMipmaps(int &flashEraseOffset, int &flashWriteOffset);
+  void accumulatePeaks(signed char *peaks, const short *src, int first,
+                       int count);
+  void buildPeaks(signed char *peaks, int &flashEraseOffset,
+                  int &flashWriteOffset);
+#endif
 
 private:
   I_File *file_;       // File
@@ -36,11 +70,19 @@ private:
   int size_;          // number of samples
   int sampleRate_;    // sample rate
   int channelCount_;  // mono / stereo
-  int bytePerSample_; // original file is in 8/16bit
+  int bytePerSample_; // original file is in 8/16/24/32bit
+  bool isFloat_;      // original file is in IEEE float
   int dataPosition_;  // offset in file to get to data
+  short *mipmaps_[MAX_MIPMAP_LEVELS]; // band limited versions of samples_
+  int mipmapLevels_;
+  signed char *peaks_; // peak cache, all levels one after the other
+#ifndef LOAD_IN_FLASH
+  short *memory_; // whole sample, owned (samples_ can point to readBuffer_)
+#endif
 
   static int bufferChunkSize_;
   static bool initChunkSize_;
+  static bool useMipmaps_;
   static unsigned char readBuffer_[512];
 };
 #endif
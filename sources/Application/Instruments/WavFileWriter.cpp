@@ -1,8 +1,19 @@
 #include "WavFileWriter.h"
 #include "System/Console/Trace.h"
 
-WavFileWriter::WavFileWriter(const char *path)
-  : sampleCount_(0), buffer_(0), bufferSize_(0), file_(0) {
+// Size of the header written below, also skipped in reference renders
+
+#define WAV_HEADER_SIZE 44
+
+// FNV-1a
+
+#define CHECKSUM_SEED 0x811C9DC5
+#define CHECKSUM_PRIME 0x01000193
+
+WavFileWriter::WavFileWriter(const char *path, int channelCount)
+    : channelCount_(channelCount), sampleCount_(0), buffer_(0), bufferSize_(0),
+      file_(0), checksum_(CHECKSUM_SEED), reference_(0), refBuffer_(0),
+      refBufferSize_(0), hasReference_(false), maxDifference_(0) {
   Path filePath(path);
   file_ = FileSystem::GetInstance()->Open(filePath.GetPath().c_str(), "wb");
   if (file_) {
@@ -28,15 +39,15 @@ WavFileWriter::WavFileWriter(const char *path)
     unsigned short ushort;
     ushort = Swap16(1); // compression
     file_->Write(&ushort, 1, 2);
-    ushort = Swap16(2); // nChannels
+    ushort = Swap16(channelCount_); // nChannels
     file_->Write(&ushort, 1, 2);
     unsigned int sampleRate = Swap32(44100);
     file_->Write(&sampleRate, 1, 4);
 
-    unsigned int byteRate = Swap32(4 * 44100);
+    unsigned int byteRate = Swap32(2 * channelCount_ * 44100);
     file_->Write(&byteRate, 1, 4);
 
-    ushort = Swap16(4); //  blockalign
+    ushort = Swap16(2 * channelCount_); //  blockalign
     file_->Write(&ushort, 1, 2);
 
     ushort = Swap16(16); // bitPerSample
@@ -54,6 +65,45 @@ WavFileWriter::WavFileWriter(const char *path)
 
 WavFileWriter::~WavFileWriter() { Close(); }
 
+void WavFileWriter::SetReference(const char *path) {
+  Path refPath(path);
+  reference_ = FileSystem::GetInstance()->Open(refPath.GetPath().c_str(), "rb");
+  if (reference_) {
+    reference_->Seek(WAV_HEADER_SIZE, SEEK_SET);
+    hasReference_ = true;
+  }
+}
+
+void WavFileWriter::track(short *data, int count) {
+
+  for (int i = 0; i < count; i++) {
+    unsigned short v = (unsigned short)data[i];
+    checksum_ = (checksum_ ^ (v & 0xFF)) * CHECKSUM_PRIME;
+    checksum_ = (checksum_ ^ (v >> 8)) * CHECKSUM_PRIME;
+  }
+
+  if (!reference_)
+    return;
+
+  if (count > refBufferSize_) {
+    SAFE_FREE(refBuffer_);
+    refBuffer_ = (short *)malloc(count * sizeof(short));
+    refBufferSize_ = count;
+  }
+  int read = refBuffer_ ? reference_->Read(refBuffer_, 1, count * 2) / 2 : 0;
+
+  // A reference that runs short counts as the largest possible difference
+
+  if (read < count) {
+    maxDifference_ = 65535;
+  }
+  for (int i = 0; i < read; i++) {
+    int d = data[i] - refBuffer_[i];
+    d = (d < 0) ? -d : d;
+    maxDifference_ = (d > maxDifference_) ? d : maxDifference_;
+  }
+}
+
 void WavFileWriter::AddBuffer(fixed *bufferIn, int size) {
 
   if (!file_)
@@ -88,6 +138,17 @@ void WavFileWriter::AddBuffer(fixed *bufferIn, int size) {
     *s++ = short(fp2i(v));
   };
   file_->Write(buffer_, 2, size * 2);
+  track(buffer_, size * 2);
+  sampleCount_ += size;
+};
+
+void WavFileWriter::AddBuffer(short *buffer, int size) {
+
+  if (!file_)
+    return;
+
+  file_->Write(buffer, 2, size * channelCount_);
+  track(buffer, size * channelCount_);
   sampleCount_ += size;
 };
 
@@ -102,12 +163,22 @@ void WavFileWriter::Close() {
   file_->Write(&len, 4, 1);
 
   file_->Seek(40, SEEK_SET);
-  sampleCount_ = Swap32(sampleCount_ * 4);
-  file_->Write(&sampleCount_, 4, 1);
+  unsigned int dataSize = Swap32(sampleCount_ * 2 * channelCount_);
+  file_->Write(&dataSize, 4, 1);
 
   file_->Seek(0, SEEK_END);
 
   file_->Close();
   SAFE_DELETE(file_);
   SAFE_FREE(buffer_);
+
+  if (reference_) {
+    if (reference_->GetC() != EOF) {
+      maxDifference_ = 65535; // reference is longer
+    }
+    reference_->Close();
+    SAFE_DELETE(reference_);
+  }
+  SAFE_FREE(refBuffer_);
+  refBufferSize_ = 0;
 };
@@ -6,15 +6,36 @@
 
 class WavFileWriter {
 public:
-  WavFileWriter(const char *path);
+  WavFileWriter(const char *path, int channelCount = 2);
   ~WavFileWriter();
   void AddBuffer(fixed *, int size); // size in samples
+  void AddBuffer(short *, int size); // size in samples
   void Close();
 
+  // Everything written is also hashed and, when a reference render is set,
+  // compared sample by sample against it so two renders of the same project
+  // can be checked against each other without keeping both around
+
+  void SetReference(const char *path);
+  unsigned int GetChecksum() { return checksum_; };
+  int GetSampleCount() { return sampleCount_; };
+  bool HasReference() { return hasReference_; };
+  int GetMaxDifference() { return maxDifference_; };
+
+protected:
+  void track(short *data, int count);
+
 private:
+  int channelCount_;
   int sampleCount_;
   short *buffer_;
   int bufferSize_;
   I_File *file_;
+  unsigned int checksum_;
+  I_File *reference_;
+  short *refBuffer_;
+  int refBufferSize_;
+  bool hasReference_;
+  int maxDifference_;
 };
 #endif
@@ -0,0 +1,198 @@
+#include "WavResampler.h"
+#include "WavFileWriter.h"
+#include "Application/Model/Config.h"
+#include "System/Console/Trace.h"
+#include "System/System/System.h"
+#include <math.h>
+#include <string.h>
+
+// Number of input frames we keep around to feed the filter
+#define RESAMPLE_WINDOW_FRAMES 256
+// Frames read from the source at once (bounded by WavFile's read buffer)
+#define RESAMPLE_READ_FRAMES 64
+// Frames written to the destination at once
+#define RESAMPLE_WRITE_FRAMES 128
+
+// Filter coefficients scale
+#define RESAMPLE_COEF_SHIFT 14
+
+bool WavResampler::enabled_ = false;
+bool WavResampler::initEnabled_ = true;
+
+WavResampler::WavResampler(WavFile *source) {
+  source_ = source;
+  sourceRate_ = source->GetSampleRate(-1);
+  sourceSize_ = source->GetSize(-1);
+  channelCount_ = source->GetChannelCount(-1);
+  filter_ = 0;
+  window_ = 0;
+  windowStart_ = 0;
+}
+
+WavResampler::~WavResampler() {
+  SAFE_FREE(filter_);
+  SAFE_FREE(window_);
+}
+
+bool WavResampler::IsEnabled() {
+  if (initEnabled_) {
+    const char *value = Config::GetInstance()->GetValue("SAMPLERESAMPLE");
+    enabled_ = (value && !strcmp(value, "YES"));
+    initEnabled_ = false;
+  }
+  return enabled_;
+}
+
+bool WavResampler::NeedsResampling(WavFile *wav) {
+  return IsEnabled() && (wav->GetSampleRate(-1) != RESAMPLE_RATE);
+}
+
+std::string WavResampler::GetCachePath(const char *path) {
+  std::string cachePath = path;
+  cachePath += RESAMPLE_CACHE_EXT;
+  return cachePath;
+}
+
+int WavResampler::GetResampledSize(WavFile *wav) {
+  return int((long long)wav->GetSize(-1) * RESAMPLE_RATE /
+             wav->GetSampleRate(-1));
+}
+
+// Blackman windowed sinc. When going down in rate, the cutoff is lowered to
+// the destination nyquist so we don't alias
+void WavResampler::buildFilter() {
+  float cutoff = 0.95f;
+  if (sourceRate_ > RESAMPLE_RATE) {
+    cutoff *= float(RESAMPLE_RATE) / float(sourceRate_);
+  }
+  const float pi = 3.14159265358979f;
+  int center = RESAMPLE_TAPS / 2 - 1;
+
+  for (int phase = 0; phase < RESAMPLE_PHASES; phase++) {
+    float frac = float(phase) / RESAMPLE_PHASES;
+    float coefs[RESAMPLE_TAPS];
+    float sum = 0;
+    for (int k = 0; k < RESAMPLE_TAPS; k++) {
+      float d = float(k - center) - frac;
+      float x = cutoff * d;
+      float sinc = (x == 0) ? 1.0f : sinf(pi * x) / (pi * x);
+      float w = (d + RESAMPLE_TAPS / 2) / RESAMPLE_TAPS;
+      float window = 0.42f - 0.5f * cosf(2 * pi * w) + 0.08f * cosf(4 * pi * w);
+      coefs[k] = sinc * window;
+      sum += coefs[k];
+    }
+    int *row = filter_ + phase * RESAMPLE_TAPS;
+    for (int k = 0; k < RESAMPLE_TAPS; k++) {
+      row[k] = int(coefs[k] / sum * (1 << RESAMPLE_COEF_SHIFT));
+    }
+  }
+}
+
+// Loads the window with source frames starting at 'first'. Frames outside
+// of the sample are silent
+void WavResampler::fillWindow(int first) {
+
+  // Keep what we already have in common with the new window
+
+  int keep = windowStart_ + RESAMPLE_WINDOW_FRAMES - first;
+  if ((keep > 0) && (first > windowStart_)) {
+    memmove(window_, window_ + (first - windowStart_) * channelCount_,
+            keep * channelCount_ * sizeof(short));
+  } else {
+    keep = 0;
+  }
+  windowStart_ = first;
+
+  int frame = first + keep;
+  int end = first + RESAMPLE_WINDOW_FRAMES;
+  while (frame < end) {
+    short *dst = window_ + (frame - first) * channelCount_;
+    if ((frame < 0) || (frame >= sourceSize_)) {
+      memset(dst, 0, channelCount_ * sizeof(short));
+      frame++;
+      continue;
+    }
+    int count = end - frame;
+    if (count > RESAMPLE_READ_FRAMES) {
+      count = RESAMPLE_READ_FRAMES;
+    }
+    if (frame + count > sourceSize_) {
+      count = sourceSize_ - frame;
+    }
+    source_->GetBuffer(frame, count);
+    memcpy(dst, source_->GetSampleBuffer(-1),
+           count * channelCount_ * sizeof(short));
+    frame += count;
+  }
+}
+
+bool WavResampler::Run(const char *path) {
+
+  filter_ = (int *)SYS_MALLOC(RESAMPLE_PHASES * RESAMPLE_TAPS * sizeof(int));
+  window_ = (short *)SYS_MALLOC(RESAMPLE_WINDOW_FRAMES * channelCount_ *
+                                sizeof(short));
+  if (!filter_ || !window_) {
+    Trace::Error("Not enough memory to resample");
+    return false;
+  }
+  buildFilter();
+
+  WavFileWriter writer(path, channelCount_);
+  short output[RESAMPLE_WRITE_FRAMES * 2];
+  int outputCount = 0;
+
+  int center = RESAMPLE_TAPS / 2 - 1;
+  int destSize = GetResampledSize(source_);
+
+  // Input position is tracked as an integer frame plus a remainder in
+  // 1/RESAMPLE_RATE units so it never drifts
+
+  int frame = 0;
+  int remainder = 0;
+  // Start from a window that has nothing in common with the first one so
+  // no frame is kept from the freshly allocated buffer
+
+  windowStart_ = -center - RESAMPLE_WINDOW_FRAMES;
+  fillWindow(-center);
+
+  for (int i = 0; i < destSize; i++) {
+    int first = frame - center;
+    if (first + RESAMPLE_TAPS > windowStart_ + RESAMPLE_WINDOW_FRAMES) {
+      fillWindow(first);
+    }
+    int phase = (remainder << RESAMPLE_PHASE_BITS) / RESAMPLE_RATE;
+    const int *coefs = filter_ + phase * RESAMPLE_TAPS;
+    const short *src = window_ + (first - windowStart_) * channelCount_;
+
+    for (int c = 0; c < channelCount_; c++) {
+      int acc = 0;
+      const short *s = src + c;
+      for (int k = 0; k < RESAMPLE_TAPS; k++) {
+        acc += *s * coefs[k];
+        s += channelCount_;
+      }
+      acc >>= RESAMPLE_COEF_SHIFT;
+      if (acc > 32767) {
+        acc = 32767;
+      } else if (acc < -32768) {
+        acc = -32768;
+      }
+      output[outputCount * channelCount_ + c] = short(acc);
+    }
+    if (++outputCount == RESAMPLE_WRITE_FRAMES) {
+      writer.AddBuffer(output, outputCount);
+      outputCount = 0;
+    }
+
+    remainder += sourceRate_;
+    while (remainder >= RESAMPLE_RATE) {
+      remainder -= RESAMPLE_RATE;
+      frame++;
+    }
+  }
+  if (outputCount) {
+    writer.AddBuffer(output, outputCount);
+  }
+  writer.Close();
+  return true;
+}
@@ -0,0 +1,46 @@
+#ifndef _WAV_RESAMPLER_H_
+#define _WAV_RESAMPLER_H_
+
+#include "WavFile.h"
+#include <string>
+
+// Converts samples to the engine rate (44.1Khz) with a polyphase windowed
+// sinc filter. The result is cached as a 16 bit wav next to the original
+// sample so the conversion only happens once.
+
+#define RESAMPLE_RATE 44100
+#define RESAMPLE_TAPS 16
+#define RESAMPLE_PHASE_BITS 5
+#define RESAMPLE_PHASES (1 << RESAMPLE_PHASE_BITS)
+#define RESAMPLE_CACHE_EXT ".44k"
+
+class WavResampler {
+public:
+  WavResampler(WavFile *source);
+  ~WavResampler();
+
+  // Writes the resampled data as a wav file at path
+  bool Run(const char *path);
+
+  static bool IsEnabled();
+  static bool NeedsResampling(WavFile *wav);
+  static std::string GetCachePath(const char *path);
+  static int GetResampledSize(WavFile *wav); // in frames
+
+private:
+  void buildFilter();
+  void fillWindow(int first);
+
+  WavFile *source_;
+  int sourceRate_;
+  int sourceSize_;
+  int channelCount_;
+  int *filter_;  // RESAMPLE_PHASES rows of RESAMPLE_TAPS coefficients
+  short *window_; // input frames currently available
+  int windowStart_;
+
+  static bool enabled_;
+  static bool initEnabled_;
+};
+
+#endif
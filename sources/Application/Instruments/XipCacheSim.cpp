@@ -0,0 +1,62 @@
+#include "XipCacheSim.h"
+#include "Application/Model/Config.h"
+#include "System/Console/Trace.h"
+#include <stdint.h>
+#include <string.h>
+
+#define XIP_CACHE_LINE_SIZE (1 << XIP_CACHE_LINE_SHIFT)
+
+XipCacheSim::XipCacheSim()
+    : enabled_(false), accesses_(0), misses_(0), flashBytes_(0), samples_(0) {
+#ifndef PICOBUILD
+  const char *sim = Config::GetInstance()->GetValue("CACHESIM");
+  enabled_ = (sim && !strcmp(sim, "YES"));
+#endif
+  memset(tags_, 0xFF, sizeof(tags_));
+  memset(lru_, 0, sizeof(lru_));
+}
+
+void XipCacheSim::Read(const void *addr, int size) {
+  if (!enabled_ || size <= 0) {
+    return;
+  }
+  uintptr_t first = ((uintptr_t)addr) >> XIP_CACHE_LINE_SHIFT;
+  uintptr_t last = ((uintptr_t)addr + size - 1) >> XIP_CACHE_LINE_SHIFT;
+
+  for (uintptr_t line = first; line <= last; line++) {
+    int set = line % XIP_CACHE_SETS;
+    unsigned int tag = (unsigned int)(line / XIP_CACHE_SETS);
+    accesses_++;
+    if (tags_[set][0] == tag) {
+      lru_[set] = 1;
+    } else if (tags_[set][1] == tag) {
+      lru_[set] = 0;
+    } else {
+      misses_++;
+      flashBytes_ += XIP_CACHE_LINE_SIZE;
+      int way = lru_[set];
+      tags_[set][way] = tag;
+      lru_[set] = way ^ 1;
+    }
+  }
+}
+
+void XipCacheSim::ReadUncached(int size) {
+  if (enabled_) {
+    flashBytes_ += size;
+  }
+}
+
+void XipCacheSim::EndBuffer(int sampleCount) {
+  if (!enabled_) {
+    return;
+  }
+  samples_ += sampleCount;
+  if (samples_ >= 44100) {
+    int rate = (accesses_ > 0) ? int(misses_ * 100 / accesses_) : 0;
+    Trace::Log("CACHESIM", "%lu misses/s (%d%% of %lu lines), %lu KB/s flash",
+               misses_, rate, accesses_, flashBytes_ / 1024);
+    samples_ -= 44100;
+    accesses_ = misses_ = flashBytes_ = 0;
+  }
+}
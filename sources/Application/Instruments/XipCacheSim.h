@@ -0,0 +1,42 @@
+#ifndef _XIP_CACHE_SIM_H_
+#define _XIP_CACHE_SIM_H_
+
+#include "Foundation/T_Singleton.h"
+
+// Model of the RP2040 XIP cache (16KB, 2 way set associative, 8 byte lines)
+// fed with the sample reads of the render kernels, so sample reader
+// strategies can be compared on the desktop build. Every rendered second
+// the number of line misses and the amount of data read from flash, cached
+// or not, is logged. Enabled with CACHESIM=YES in the config, desktop only.
+// Reads are accounted per block at line granularity, code and tables are
+// not modelled
+
+#define XIP_CACHE_LINE_SHIFT 3
+#define XIP_CACHE_SETS 1024
+#define XIP_CACHE_WAYS 2
+
+class XipCacheSim : public T_Singleton<XipCacheSim> {
+public:
+  XipCacheSim();
+
+  bool IsEnabled() { return enabled_; };
+
+  // Cached read of every line of [addr, addr+size[
+  void Read(const void *addr, int size);
+  // Flash read that bypasses the cache (DMA from the non cached alias)
+  void ReadUncached(int size);
+
+  // Called once per rendered buffer
+  void EndBuffer(int sampleCount);
+
+private:
+  bool enabled_;
+  unsigned int tags_[XIP_CACHE_SETS][XIP_CACHE_WAYS];
+  unsigned char lru_[XIP_CACHE_SETS]; // way to replace next
+  unsigned long accesses_;
+  unsigned long misses_;
+  unsigned long flashBytes_;
+  int samples_;
+};
+
+#endif
@@ -2,10 +2,16 @@
 #include "Application/Audio/DummyAudioOut.h"
 #include "Application/Model/Config.h"
 #include "Application/Model/Mixer.h"
+#include "Application/Player/RenderBudget.h"
 #include "Services/Audio/Audio.h"
 #include "Services/Audio/AudioDriver.h"
 #include "Services/Midi/MidiService.h"
 #include "System/Console/Trace.h"
+#include "System/System/System.h"
+
+#ifndef PICOBUILD
+#include "Application/Instruments/XipCacheSim.h"
+#endif
 
 MixerService::MixerService() : out_(0), sync_(0) {
   mode_ = MSM_AUDIO;
@@ -24,6 +30,10 @@ MixerService::MixerService() : out_(0), sync_(0) {
       mode_ = MSM_FILESPLITRT;
     };
   };
+  const char *check = Config::GetInstance()->GetValue("RENDERCHECK");
+  if (check) {
+    AudioMixer::SetRenderCheck(atoi(check));
+  }
 };
 
 MixerService::~MixerService(){};
@@ -51,6 +61,18 @@ bool MixerService::Init() {
     master_.Insert(bus_[i]);
   }
 
+  // The send effects come after the buses so that all channels have sent
+  // their share by the time they render
+
+  int fxMemory = SENDFX_DEFAULT_MEMORY;
+  const char *memory = Config::GetInstance()->GetValue("FXMEMORY");
+  if (memory) {
+    fxMemory = atoi(memory);
+  }
+  if ((fxMemory > 0) && sendFx_.Init(fxMemory * 1024)) {
+    master_.Insert(sendFx_);
+  }
+
   if (out_) {
 
     result = out_->Init();
@@ -78,7 +100,7 @@ bool MixerService::Init() {
   }
 
 #ifndef PICOBUILD
-  sync_ = SDL_CreateMutex();
+  sync_ = new std::mutex();
 #else
   mutex_init(sync_);
 #endif
@@ -118,9 +140,10 @@ void MixerService::Close() {
   for (int i = 0; i < MAX_BUS_COUNT; i++) {
     bus_[i].Empty();
   }
+  sendFx_.Close();
   out_ = 0;
 #ifndef PICOBUILD
-  SDL_DestroyMutex(sync_);
+  delete sync_;
   sync_ = 0;
 #endif
 };
@@ -144,17 +167,35 @@ void MixerService::Stop() {
 
 MixBus *MixerService::GetMixBus(int i) { return &(bus_[i]); };
 
+SendFx *MixerService::GetSendFx() { return &sendFx_; };
+
 void MixerService::Update(Observable &o, I_ObservableData *d) {
 
   AudioDriver::Event *event = (AudioDriver::Event *)d;
   if (event->type_ == AudioDriver::Event::ADET_BUFFERNEEDED) {
     Lock();
+#ifndef AUDIO_BLOCK_SIZE
     SetChanged();
     NotifyObservers();
-
+#endif
+    System *system = System::GetInstance();
+    unsigned long start = system->GetMicros();
     out_->Trigger();
+    int sampleCount = out_->GetSampleCount();
+    RenderBudget::GetInstance()->EndBuffer(system->GetMicros() - start,
+                                           sampleCount);
+#ifndef PICOBUILD
+    XipCacheSim::GetInstance()->EndBuffer(sampleCount);
+#endif
     Unlock();
   }
+#ifdef AUDIO_BLOCK_SIZE
+  // The output starts slices itself while rendering a block, lock is held
+  if (event->type_ == AudioDriver::Event::ADET_SLICE) {
+    SetChanged();
+    NotifyObservers();
+  }
+#endif
 }
 
 bool MixerService::Clipped() { return out_->Clipped(); };
@@ -165,6 +206,7 @@ void MixerService::SetMasterVolume(int vol) {
   for (int i = 0; i < SONG_CHANNEL_COUNT; i++) {
     bus_[i].SetVolume(masterVolume);
   }
+  sendFx_.SetVolume(masterVolume);
 };
 
 int MixerService::GetPlayedBufferPercentage() {
@@ -215,7 +257,7 @@ AudioOut *MixerService::GetAudioOut() { return out_; };
 void MixerService::Lock() {
   if (sync_)
 #ifndef PICOBUILD
-    SDL_LockMutex(sync_);
+    sync_->lock();
 #else
     mutex_enter_blocking(sync_);
 #endif
@@ -224,7 +266,7 @@ void MixerService::Lock() {
 void MixerService::Unlock() {
   if (sync_)
 #ifndef PICOBUILD
-    SDL_UnlockMutex(sync_);
+    sync_->unlock();
 #else
     mutex_exit(sync_);
 #endif
@@ -5,10 +5,11 @@
 #include "Foundation/Observable.h"
 #include "Foundation/T_Singleton.h"
 #include "MixBus.h"
+#include "SendFx.h"
 #include "Services/Audio/AudioMixer.h"
 #include "Services/Audio/AudioOut.h"
 #ifndef PICOBUILD
-#include "SDL/SDL.h"
+#include <mutex>
 #else
 #include "pico/mutex.h"
 #endif
@@ -39,6 +40,7 @@ public:
   void Stop();
 
   MixBus *GetMixBus(int i);
+  SendFx *GetSendFx();
 
   virtual void Update(Observable &o, I_ObservableData *d);
 
@@ -63,9 +65,10 @@ private:
   AudioOut *out_;
   MixBus master_;
   MixBus bus_[MAX_BUS_COUNT];
+  SendFx sendFx_;
   MixerServiceMode mode_;
 #ifndef PICOBUILD
-  SDL_mutex *sync_;
+  std::mutex *sync_;
 #else
   mutex_t *sync_;
 #endif
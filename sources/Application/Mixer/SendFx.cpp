@@ -0,0 +1,235 @@
+#include "SendFx.h"
+#include "System/Console/Trace.h"
+#include "System/System/System.h"
+#include <string.h>
+
+// Schroeder style reverb: parallel combs with damping in their feedback,
+// followed by two allpasses per side. Lengths are the Freeverb ones halved
+// for the half rate, the right side allpasses are slightly longer to
+// decorrelate both sides
+
+static const int combLength[SENDFX_COMBS] = {558, 594, 638, 678};
+static const int allpassLength[2][SENDFX_ALLPASSES] = {{278, 220},
+                                                       {290, 232}};
+
+#define SENDFX_ROOM 215       // comb feedback (/256)
+#define SENDFX_DAMP 51        // comb damping (/256)
+#define SENDFX_SILENCE 4      // return level considered silent
+#define SENDFX_MIN_DELAY 1024 // smallest delay line worth running
+
+static inline int clip16(int v) {
+  return (v > 32767) ? 32767 : ((v < -32768) ? -32768 : v);
+}
+
+// Feedback paths round towards zero, flooring would keep small limit cycles
+// going forever
+
+static inline int decay(int v, int amount) { return (v * amount) / 256; }
+
+SendFx::SendFx()
+    : arena_(0), arenaSize_(0), arenaUsed_(0), send_(0), sent_(false),
+      sleeping_(true), quiet_(0), delayLength_(1), feedback_(0), reverb_(0),
+      volume_(i2fp(1)) {
+  phase_ = held_ = 0;
+  last_[0] = last_[1] = 0;
+  current_[0] = current_[1] = 0;
+}
+
+SendFx::~SendFx() { Close(); }
+
+short *SendFx::carve(int size) {
+  if (arenaUsed_ + size * (int)sizeof(short) > arenaSize_) {
+    return 0;
+  }
+  short *result = (short *)(arena_ + arenaUsed_);
+  arenaUsed_ += size * sizeof(short);
+  return result;
+}
+
+void SendFx::initLine(line &l, int size) {
+  l.buffer_ = carve(size);
+  l.size_ = size;
+  l.position_ = 0;
+}
+
+bool SendFx::Init(int memory) {
+
+  // The send buffer, reverb and delay lines are all carved from a single
+  // arena, the delay gets whatever is left
+
+  int reverbSize = 0;
+  for (int i = 0; i < SENDFX_COMBS; i++) {
+    reverbSize += combLength[i];
+  }
+  for (int i = 0; i < SENDFX_ALLPASSES; i++) {
+    reverbSize += allpassLength[0][i] + allpassLength[1][i];
+  }
+  int sendSize = MAX_SAMPLE_COUNT * sizeof(int);
+  int delaySize =
+      (memory - sendSize - reverbSize * (int)sizeof(short)) / sizeof(short);
+  if (delaySize < SENDFX_MIN_DELAY) {
+    Trace::Error("Send effects need more than %d bytes", memory);
+    return false;
+  }
+
+  arena_ = (char *)SYS_MALLOC(memory);
+  if (!arena_) {
+    Trace::Error("Not enough memory for send effects");
+    return false;
+  }
+  memset(arena_, 0, memory);
+  arenaSize_ = memory;
+  arenaUsed_ = sendSize;
+  send_ = (int *)arena_;
+
+  for (int i = 0; i < SENDFX_COMBS; i++) {
+    initLine(comb_[i], combLength[i]);
+    combStore_[i] = 0;
+  }
+  for (int side = 0; side < 2; side++) {
+    for (int i = 0; i < SENDFX_ALLPASSES; i++) {
+      initLine(allpass_[side][i], allpassLength[side][i]);
+    }
+  }
+  initLine(delay_, delaySize);
+
+  Trace::Log("SENDFX", "%d bytes, %d ms of delay", memory,
+             delaySize * 2 * 1000 / 44100);
+  sleeping_ = true;
+  return true;
+}
+
+void SendFx::Close() {
+  SAFE_FREE(arena_);
+  arenaSize_ = arenaUsed_ = 0;
+  send_ = 0;
+}
+
+void SendFx::SetParameters(int delay, int feedback, int reverb) {
+  if (!arena_) {
+    return;
+  }
+  delay /= 2;
+  delay = (delay < 1) ? 1 : delay;
+  delayLength_ = (delay >= delay_.size_) ? delay_.size_ - 1 : delay;
+  feedback_ = feedback;
+  reverb_ = reverb;
+}
+
+void SendFx::SetVolume(fixed volume) { volume_ = volume; }
+
+AUDIO_FUNC void SendFx::Send(fixed *buffer, int samplecount, int level) {
+  if (!send_ || (level == 0)) {
+    return;
+  }
+  fixed *src = buffer;
+  int *dst = send_;
+  if (!sent_) {
+    for (int i = 0; i < samplecount; i++) {
+      *dst++ = ((fp2i(src[0]) + fp2i(src[1])) >> 1) * level;
+      src += 2;
+    }
+  } else {
+    for (int i = 0; i < samplecount; i++) {
+      *dst++ += ((fp2i(src[0]) + fp2i(src[1])) >> 1) * level;
+      src += 2;
+    }
+  }
+  sent_ = true;
+  if (sleeping_) {
+    sleeping_ = false;
+    quiet_ = 0;
+  }
+}
+
+AUDIO_FUNC int SendFx::processDelay(int input) {
+  short *buffer = delay_.buffer_;
+  int position = delay_.position_;
+  int read = position - delayLength_;
+  read = (read < 0) ? read + delay_.size_ : read;
+  int echo = buffer[read];
+  buffer[position] = clip16(input + decay(echo, feedback_));
+  delay_.position_ = (position + 1 == delay_.size_) ? 0 : position + 1;
+  return echo;
+}
+
+AUDIO_FUNC void SendFx::processReverb(int input, int &left, int &right) {
+  int sum = 0;
+  for (int i = 0; i < SENDFX_COMBS; i++) {
+    line &c = comb_[i];
+    int y = c.buffer_[c.position_];
+    combStore_[i] = y + decay(combStore_[i] - y, SENDFX_DAMP);
+    c.buffer_[c.position_] = clip16(input + decay(combStore_[i], SENDFX_ROOM));
+    c.position_ = (c.position_ + 1 == c.size_) ? 0 : c.position_ + 1;
+    sum += y;
+  }
+  sum >>= 2;
+  for (int side = 0; side < 2; side++) {
+    int v = sum;
+    for (int i = 0; i < SENDFX_ALLPASSES; i++) {
+      line &a = allpass_[side][i];
+      int b = a.buffer_[a.position_];
+      a.buffer_[a.position_] = clip16(v + b / 2);
+      a.position_ = (a.position_ + 1 == a.size_) ? 0 : a.position_ + 1;
+      v = b - v;
+    }
+    (side ? right : left) = v;
+  }
+}
+
+AUDIO_FUNC bool SendFx::Render(fixed *buffer, int samplecount) {
+
+  if (!arena_ || sleeping_) {
+    return false;
+  }
+
+  fixed *dst = buffer;
+  int *src = send_;
+
+  for (int i = 0; i < samplecount; i++) {
+    int input = sent_ ? (src[i] >> 8) : 0;
+    int left, right;
+    if (!phase_) {
+      held_ = input;
+      left = current_[0];
+      right = current_[1];
+    } else {
+
+      // Run the effects on the average of both frames
+
+      int x = clip16((held_ + input) >> 1);
+      int echo = processDelay(x);
+      int revLeft, revRight;
+      processReverb((x + echo) >> 2, revLeft, revRight);
+      last_[0] = current_[0];
+      last_[1] = current_[1];
+      current_[0] = clip16(echo + ((revLeft * reverb_) >> 8));
+      current_[1] = clip16(echo + ((revRight * reverb_) >> 8));
+      left = (last_[0] + current_[0]) >> 1;
+      right = (last_[1] + current_[1]) >> 1;
+
+      // Look at what comes out of the lines rather than at the return, a
+      // low reverb level would hide a tail that's still in them
+
+      bool silent = (x < SENDFX_SILENCE) && (x > -SENDFX_SILENCE) &&
+                    (echo < SENDFX_SILENCE) && (echo > -SENDFX_SILENCE) &&
+                    (revLeft < SENDFX_SILENCE) &&
+                    (revLeft > -SENDFX_SILENCE) &&
+                    (revRight < SENDFX_SILENCE) &&
+                    (revRight > -SENDFX_SILENCE);
+      quiet_ = silent ? quiet_ + 1 : 0;
+    }
+    phase_ ^= 1;
+    *dst++ = left * volume_;
+    *dst++ = right * volume_;
+  }
+
+  // Once the return has been silent for longer than the delay, the lines
+  // hold nothing audible anymore and we can stop until something is sent
+
+  sent_ = false;
+  if (quiet_ > delayLength_ + combLength[SENDFX_COMBS - 1]) {
+    sleeping_ = true;
+  }
+  return true;
+}
@@ -0,0 +1,80 @@
+#ifndef _SEND_FX_H_
+#define _SEND_FX_H_
+
+#include "Services/Audio/AudioDriver.h" // for MAX_SAMPLE_COUNT
+#include "Services/Audio/AudioModule.h"
+
+// Send effects shared by all channels. While they render, channels add a
+// scaled mono copy of their output to the send, and the effects return is
+// mixed in the master after the buses. The send feeds a tempo synced delay,
+// and both the send and the echoes go through a small reverb.
+// Everything runs at half rate from a single arena allocated when the mixer
+// starts, so the cost per sample is the same however many channels send,
+// and nothing runs once the tails have died out
+
+// Arena size in KB, FXMEMORY in the config overrides it
+#ifdef PICOBUILD
+#define SENDFX_DEFAULT_MEMORY 32
+#else
+#define SENDFX_DEFAULT_MEMORY 128
+#endif
+
+#define SENDFX_COMBS 4
+#define SENDFX_ALLPASSES 2
+
+class SendFx : public AudioModule {
+public:
+  SendFx();
+  virtual ~SendFx();
+
+  bool Init(int memory); // arena size in bytes
+  void Close();
+
+  // Delay time in samples, feedback and reverb level from 0 to 0xFF
+  void SetParameters(int delay, int feedback, int reverb);
+  void SetVolume(fixed volume);
+
+  // Adds a channel's output to the send, level from 0 to 0x100
+  void Send(fixed *buffer, int samplecount, int level);
+
+  virtual bool Render(fixed *buffer, int samplecount);
+
+private:
+  struct line {
+    short *buffer_;
+    int size_;
+    int position_;
+  };
+
+  short *carve(int size);
+  void initLine(line &l, int size);
+  int processDelay(int input);
+  void processReverb(int input, int &left, int &right);
+
+  char *arena_;
+  int arenaSize_;
+  int arenaUsed_;
+
+  int *send_; // mono, in samples << 8
+  bool sent_; // something was sent for the current block
+  bool sleeping_;
+  int quiet_; // half rate frames the return has been silent for
+
+  line delay_;
+  int delayLength_;
+  int feedback_;
+  line comb_[SENDFX_COMBS];
+  int combStore_[SENDFX_COMBS];
+  line allpass_[2][SENDFX_ALLPASSES];
+  int reverb_;
+  fixed volume_;
+
+  // Half rate state, the input of the first frame of a pair is held until
+  // the second one comes in, outputs are interpolated between the last two
+  // half rate frames
+  int phase_;
+  int held_;
+  int last_[2];
+  int current_[2];
+};
+#endif
@@ -1,13 +1,10 @@
 #ifndef _CHAIN_H_
 #define _CHAIN_H_
 
-#ifndef PICOBUILD
+// Chains only cost 32 bytes each, and with commands stored as one byte
+// opcodes (see MAKE_FOURCC) there is room for the full desktop range on pico
 #define CHAIN_COUNT 0xFF
 #define NO_MORE_CHAIN 0x100
-#else
-#define CHAIN_COUNT 0x80
-#define NO_MORE_CHAIN 0x81
-#endif
 
 class Chain {
 public:
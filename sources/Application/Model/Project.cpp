@@ -24,6 +24,12 @@ Project::Project() : Persistent("PROJECT"), midiDeviceList_(0), tempoNudge_(0) {
   this->Insert(wrap);
   Variable *transpose = new Variable("transpose", VAR_TRANSPOSE, 0);
   this->Insert(transpose);
+  Variable *fxDelay = new Variable("fxdelay", VAR_FXDELAY, 18);
+  this->Insert(fxDelay);
+  Variable *fxFeedback = new Variable("fxfeedback", VAR_FXFEEDBACK, 0x60);
+  this->Insert(fxFeedback);
+  Variable *fxReverb = new Variable("fxreverb", VAR_FXREVERB, 0x80);
+  this->Insert(fxReverb);
 
   // Reload the midi device list
 
@@ -90,6 +96,24 @@ int Project::GetTranspose() {
   return result;
 };
 
+int Project::GetFxDelay() {
+  Variable *v = FindVariable(VAR_FXDELAY);
+  NAssert(v);
+  return v->GetInt();
+};
+
+int Project::GetFxFeedback() {
+  Variable *v = FindVariable(VAR_FXFEEDBACK);
+  NAssert(v);
+  return v->GetInt();
+};
+
+int Project::GetFxReverb() {
+  Variable *v = FindVariable(VAR_FXREVERB);
+  NAssert(v);
+  return v->GetInt();
+};
+
 bool Project::Wrap() {
   Variable *v = FindVariable(VAR_WRAP);
   NAssert(v);
@@ -206,8 +230,8 @@ void Project::PurgeInstruments(bool removeFromDisk) {
 
   InstrumentBank *bank = GetInstrumentBank();
   for (int i = 0; i < MAX_INSTRUMENT_COUNT; i++) {
-    if (!used[i]) {
-      I_Instrument *instrument = bank->GetInstrument(i);
+    I_Instrument *instrument = bank->FindInstrument(i);
+    if ((instrument) && (!used[i])) {
       instrument->Purge();
     }
   }
@@ -226,8 +250,8 @@ void Project::PurgeInstruments(bool removeFromDisk) {
     // flag all samples actually used
 
     for (int i = 0; i < MAX_INSTRUMENT_COUNT; i++) {
-      I_Instrument *instrument = bank->GetInstrument(i);
-      if (instrument->GetType() == IT_SAMPLE) {
+      I_Instrument *instrument = bank->FindInstrument(i);
+      if ((instrument) && (instrument->GetType() == IT_SAMPLE)) {
         SampleInstrument *si = (SampleInstrument *)instrument;
         int index = si->GetSampleIndex();
         if (index >= 0)
@@ -13,6 +13,9 @@
 #define VAR_WRAP MAKE_FOURCC('W', 'R', 'A', 'P')
 #define VAR_MIDIDEVICE MAKE_FOURCC('M', 'I', 'D', 'I')
 #define VAR_TRANSPOSE MAKE_FOURCC('T', 'R', 'S', 'P')
+#define VAR_FXDELAY MAKE_FOURCC('F', 'X', 'D', 'T')
+#define VAR_FXFEEDBACK MAKE_FOURCC('F', 'X', 'F', 'B')
+#define VAR_FXREVERB MAKE_FOURCC('F', 'X', 'R', 'V')
 
 #define PROJECT_NUMBER "1.0"
 #define PROJECT_RELEASE "r"
@@ -35,6 +38,9 @@ public:
   void NudgeTempo(int value);
   int GetTempo(); // Takes nudging into account
   int GetTranspose();
+  int GetFxDelay(); // in ticks
+  int GetFxFeedback();
+  int GetFxReverb();
 
   void Trigger();
 
@@ -86,7 +86,7 @@ void Song::RestoreContent(PersistencyDocument *doc) {
   unsigned char *data = data_;
   for (int i = 0; i < SONG_ROW_COUNT * SONG_CHANNEL_COUNT; i++) {
     if (*data != 0xFF) {
-      if (*data < 0x80) {
+      if (*data < CHAIN_COUNT) {
         chain_->SetUsed(*data);
       }
     }
@@ -15,7 +15,7 @@
 #define SONG_CHANNEL_COUNT 8
 #define SONG_ROW_COUNT 128
 
-#define MAX_SAMPLEINSTRUMENT_COUNT 0x10
+#define MAX_SAMPLEINSTRUMENT_COUNT 0x40
 #define MAX_MIDIINSTRUMENT_COUNT 0x10
 #endif
 
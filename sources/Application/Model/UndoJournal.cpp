@@ -0,0 +1,209 @@
+#include "UndoJournal.h"
+#include "System/Console/Trace.h"
+#include <string.h>
+
+// A delta is the address of the run, its length and the xor-ed bytes
+
+#define DELTA_HEADER (int(sizeof(unsigned char *)) + 1)
+
+UndoJournal::UndoJournal() { Clear(); };
+
+UndoJournal::~UndoJournal(){};
+
+void UndoJournal::Clear() {
+  regionCount_ = 0;
+  scratchUsed_ = 0;
+  overflow_ = false;
+  head_ = 0;
+  cursor_ = 0;
+  top_ = 0;
+  write_ = 0;
+};
+
+// Saves a copy of a region that the current edit may modify. A region that
+// covers earlier ones takes over their saved bytes since they hold the
+// original content
+
+void UndoJournal::Watch(void *data, int len) {
+  unsigned char *bytes = (unsigned char *)data;
+  for (int i = 0; i < regionCount_; i++) {
+    Region &r = region_[i];
+    if ((bytes >= r.data_) && (bytes + len <= r.data_ + r.len_)) {
+      return;
+    }
+  }
+  if ((regionCount_ == JOURNAL_MAX_REGIONS) ||
+      (scratchUsed_ + len > JOURNAL_WATCH_SIZE)) {
+    overflow_ = true;
+    return;
+  }
+  unsigned char *copy = scratch_ + scratchUsed_;
+  memcpy(copy, bytes, len);
+
+  int i = 0;
+  while (i < regionCount_) {
+    Region &r = region_[i];
+    if ((r.data_ >= bytes + len) || (r.data_ + r.len_ <= bytes)) {
+      i++;
+      continue;
+    }
+    if ((r.data_ < bytes) || (r.data_ + r.len_ > bytes + len)) {
+      // Partial overlaps aren't used by any editor
+      overflow_ = true;
+      return;
+    }
+    memcpy(copy + (r.data_ - bytes), scratch_ + r.offset_, r.len_);
+    region_[i] = region_[--regionCount_];
+  }
+
+  Region &r = region_[regionCount_++];
+  r.data_ = bytes;
+  r.len_ = len;
+  r.offset_ = scratchUsed_;
+  scratchUsed_ += len;
+};
+
+void UndoJournal::Commit() {
+
+  if (regionCount_ == 0) {
+    return;
+  }
+
+  int size = overflow_ ? JOURNAL_SIZE : diff(false);
+
+  if (size > JOURNAL_SIZE - 4) {
+    // Older entries can't be replayed over an edit we couldn't record
+    Trace::Log("JOURNAL", "Edit too large to be undone, history cleared");
+    Clear();
+    return;
+  }
+
+  if (size > 0) {
+    // A new edit replaces whatever could be redone
+    top_ = cursor_;
+    while (top_ + size + 4 - head_ > JOURNAL_SIZE) {
+      dropOldest();
+    }
+    write_ = top_;
+    putSize(write_, size);
+    write_ += 2;
+    diff(true);
+    putSize(write_, size);
+    write_ += 2;
+    cursor_ = top_ = write_;
+
+    if (head_ >= JOURNAL_SIZE) {
+      head_ -= JOURNAL_SIZE;
+      cursor_ -= JOURNAL_SIZE;
+      top_ -= JOURNAL_SIZE;
+    }
+  }
+  regionCount_ = 0;
+  scratchUsed_ = 0;
+};
+
+bool UndoJournal::Undo() {
+  regionCount_ = 0;
+  scratchUsed_ = 0;
+  overflow_ = false;
+
+  if (cursor_ == head_) {
+    return false;
+  }
+  int size = getSize(cursor_ - 2);
+  cursor_ -= size + 4;
+  apply(cursor_ + 2, size);
+  return true;
+};
+
+bool UndoJournal::Redo() {
+  regionCount_ = 0;
+  scratchUsed_ = 0;
+  overflow_ = false;
+
+  if (cursor_ == top_) {
+    return false;
+  }
+  int size = getSize(cursor_);
+  apply(cursor_ + 2, size);
+  cursor_ += size + 4;
+  return true;
+};
+
+// Walks the changed runs of the watched regions and returns the size of
+// their deltas, writing them to the ring if asked to
+
+int UndoJournal::diff(bool write) {
+  int size = 0;
+  for (int r = 0; r < regionCount_; r++) {
+    unsigned char *data = region_[r].data_;
+    unsigned char *saved = scratch_ + region_[r].offset_;
+    int len = region_[r].len_;
+    int i = 0;
+    while (i < len) {
+      if (data[i] == saved[i]) {
+        i++;
+        continue;
+      }
+      // Unchanged gaps shorter than a header are cheaper to keep in the run
+      int end = i + 1;
+      for (int j = end; (j < len) && (j - i < 0xFF) && (j - end < DELTA_HEADER);
+           j++) {
+        if (data[j] != saved[j]) {
+          end = j + 1;
+        }
+      }
+      size += DELTA_HEADER + end - i;
+      if (write) {
+        unsigned char *address = data + i;
+        unsigned char bytes[sizeof(unsigned char *)];
+        memcpy(bytes, &address, sizeof(unsigned char *));
+        for (unsigned int k = 0; k < sizeof(unsigned char *); k++) {
+          putByte(bytes[k]);
+        }
+        putByte(end - i);
+        for (int k = i; k < end; k++) {
+          putByte(data[k] ^ saved[k]);
+        }
+      }
+      i = end;
+    }
+  }
+  return size;
+};
+
+void UndoJournal::apply(int start, int size) {
+  int index = start;
+  while (index < start + size) {
+    unsigned char *address;
+    unsigned char bytes[sizeof(unsigned char *)];
+    for (unsigned int k = 0; k < sizeof(unsigned char *); k++) {
+      bytes[k] = getByte(index++);
+    }
+    memcpy(&address, bytes, sizeof(unsigned char *));
+    int len = getByte(index++);
+    for (int k = 0; k < len; k++) {
+      address[k] ^= getByte(index++);
+    }
+  }
+};
+
+void UndoJournal::putByte(unsigned char b) {
+  ring_[write_ & (JOURNAL_SIZE - 1)] = b;
+  write_++;
+};
+
+unsigned char UndoJournal::getByte(int index) {
+  return ring_[index & (JOURNAL_SIZE - 1)];
+};
+
+void UndoJournal::putSize(int index, int size) {
+  ring_[index & (JOURNAL_SIZE - 1)] = size & 0xFF;
+  ring_[(index + 1) & (JOURNAL_SIZE - 1)] = size >> 8;
+};
+
+int UndoJournal::getSize(int index) {
+  return getByte(index) | (getByte(index + 1) << 8);
+};
+
+void UndoJournal::dropOldest() { head_ += getSize(head_) + 4; };
@@ -0,0 +1,68 @@
+#ifndef _UNDO_JOURNAL_H_
+#define _UNDO_JOURNAL_H_
+
+#include "Application/Model/Song.h"
+#include "Foundation/T_Singleton.h"
+
+// Size of the history ring and of the scratch copy taken while an edit is
+// pending. The scratch has to hold the largest region an editor watches,
+// which is the song rows shifted by a cut or paste
+
+#ifndef PICOBUILD
+#define JOURNAL_SIZE 4096
+#else
+#define JOURNAL_SIZE 2048
+#endif
+#define JOURNAL_WATCH_SIZE (SONG_ROW_COUNT * SONG_CHANNEL_COUNT + 0x40)
+#define JOURNAL_MAX_REGIONS 8
+
+// Undo history for the song, chain, phrase, table and groove editors.
+//
+// Before editing, a view Watch()es the bytes it may modify. Once the button
+// press has been processed Commit() compares them with their saved copy and
+// stores the changed runs as a single entry, xor-ed with their old value so
+// the same delta serves both undo and redo. Entries live in a fixed ring and
+// the oldest ones are dropped when it fills up
+
+class UndoJournal : public T_Singleton<UndoJournal> {
+public:
+  UndoJournal();
+  ~UndoJournal();
+  void Clear();
+  void Watch(void *data, int len);
+  void Commit();
+  bool Undo();
+  bool Redo();
+
+protected:
+  int diff(bool write);
+  void apply(int start, int size);
+  void putByte(unsigned char b);
+  unsigned char getByte(int index);
+  void putSize(int index, int size);
+  int getSize(int index);
+  void dropOldest();
+
+private:
+  struct Region {
+    unsigned char *data_;
+    int len_;
+    int offset_; // position of the saved copy in scratch_
+  };
+
+  Region region_[JOURNAL_MAX_REGIONS];
+  int regionCount_;
+  int scratchUsed_;
+  bool overflow_;
+  unsigned char scratch_[JOURNAL_WATCH_SIZE];
+
+  // Ring positions keep growing and are wrapped on access: entries from
+  // head_ to cursor_ can be undone, from cursor_ to top_ redone
+  unsigned char ring_[JOURNAL_SIZE];
+  int head_;
+  int cursor_;
+  int top_;
+  int write_;
+};
+
+#endif
@@ -473,6 +473,8 @@ void Player::QueueChannel(int i, QueueingMode mode, unsigned char position,
 
 void Player::Update(Observable &o, I_ObservableData *d) {
 
+  PlayerChannel::StartSlice();
+
   // Make sure sync's ok
 
   MidiService::GetInstance()->Trigger();
@@ -670,6 +672,10 @@ bool Player::ProcessChannelCommand(int channel, FourCC cmd, ushort param) {
       gr->SetGroove(channel, param);
     }
   } break;
+  case I_CMD_SEND:
+    param = param & 0xFF;
+    mixer_->SetChannelSend(channel, param + (param >> 7));
+    return true;
   case I_CMD_STOP: {
     switch (GetSequencerMode()) {
     case SM_SONG:
@@ -811,14 +817,21 @@ void Player::playCursorPosition(int channel) {
 
       I_Instrument *instrument;
       if (instr != 0xFF) {
-        instrument = bank->GetInstrument(instr);
+        instrument = bank->FindInstrument(instr);
         newInstrument = true;
       } else {
         instrument = mixer_->GetLastInstrument(channel);
       }
 
+      if ((instrument == 0) && (instr == 0xFF)) {
+        instrument = bank->FindInstrument(0);
+      }
+
+      // We're on the audio core and can't create instruments, slots that
+      // don't exist yet are empty
+
       if (instrument == 0) {
-        instrument = bank->GetInstrument(0);
+        instrument = bank->GetEmptyInstrument();
       }
 
       if (instrument != 0) {
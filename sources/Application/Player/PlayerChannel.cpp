@@ -2,14 +2,19 @@
 #include "PlayerChannel.h"
 #include "Application/Mixer/MixerService.h"
 #include "Application/Model/Mixer.h"
+#include "Application/Player/RenderBudget.h"
 #include "Application/Player/SyncMaster.h"
 
+unsigned int PlayerChannel::slice_ = 0;
+
 PlayerChannel::PlayerChannel(int index) {
   index_ = index;
   instr_ = 0;
   muted_ = false;
   mixBus_ = 0;
   busIndex_ = -1;
+  sendLevel_ = 0;
+  renderedSlice_ = 0;
 }
 
 PlayerChannel::~PlayerChannel() {}
@@ -35,16 +40,27 @@ void PlayerChannel::StopInstrument() {
   instr_ = 0;
 };
 
-bool PlayerChannel::Render(fixed *buffer, int samplecount) {
+AUDIO_FUNC bool PlayerChannel::Render(fixed *buffer, int samplecount) {
   if (instr_) {
-    bool tableSlice = SyncMaster::GetInstance()->TableSlice();
-    bool status = instr_->Render(index_, buffer, samplecount, tableSlice);
+    bool updateTick = (renderedSlice_ != slice_) &&
+                      SyncMaster::GetInstance()->TableSlice();
+    renderedSlice_ = slice_;
+    RenderBudget *budget = RenderBudget::GetInstance();
+    budget->StartVoice(index_);
+    bool status = instr_->Render(index_, buffer, samplecount, updateTick);
+    budget->StopVoice(index_);
+    if (status && !muted_ && sendLevel_) {
+      MixerService::GetInstance()->GetSendFx()->Send(buffer, samplecount,
+                                                     sendLevel_);
+    }
     return ((status) && (!muted_));
   } else {
     return false;
   }
 };
 
+void PlayerChannel::StartSlice() { slice_++; }
+
 I_Instrument *PlayerChannel::GetInstrument() { return instr_; };
 
 void PlayerChannel::SetMute(bool muted) { muted_ = muted; }
@@ -65,10 +81,13 @@ void PlayerChannel::SetMixBus(int i) {
   }
 };
 
+void PlayerChannel::SetSend(int level) { sendLevel_ = level; }
+
 void PlayerChannel::Reset() {
   if (mixBus_) {
     mixBus_->Remove(*this);
   }
   muted_ = false;
+  sendLevel_ = 0;
   busIndex_ = -1;
 };
\ No newline at end of file
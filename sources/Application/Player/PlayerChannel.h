@@ -18,14 +18,23 @@ public:
   void SetMute(bool muted);
   bool IsMuted();
   void SetMixBus(int i);
+  void SetSend(int level); // 0 to 0x100
   void Reset();
 
+  // Called by the player when a new slice starts. A slice can be rendered in
+  // several pieces, the instrument tick only runs on the first one
+  static void StartSlice();
+
 private:
   int index_;
   I_Instrument *instr_;
   bool muted_;
   int busIndex_;
   MixBus *mixBus_;
+  int sendLevel_;
+  unsigned int renderedSlice_;
+
+  static unsigned int slice_;
 };
 
 #endif
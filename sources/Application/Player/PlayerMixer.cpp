@@ -6,6 +6,7 @@
 #include "Application/Utils/char.h"
 #include "Application/Utils/fixed.h"
 #include "Services/Midi/MidiService.h"
+#include "RenderBudget.h"
 #include "SyncMaster.h"
 #include "System/Console/Trace.h"
 #include "System/System/System.h"
@@ -21,6 +22,9 @@ PlayerMixer::PlayerMixer() {
   for (int i = 0; i < SONG_CHANNEL_COUNT; i++) {
     channel_[i] = new PlayerChannel(i);
   }
+
+  // Make sure the budget is created here rather than from the audio thread
+  RenderBudget::GetInstance()->Reset();
 }
 
 bool PlayerMixer::Init(Project *project) {
@@ -109,6 +113,10 @@ void PlayerMixer::Update(Observable &o, I_ObservableData *d) {
   //     out_->SetMasterVolume(project_->GetMasterVolume()) ;
   MixerService *ms = MixerService::GetInstance();
   ms->SetMasterVolume(project_->GetMasterVolume());
+  int delay = int(project_->GetFxDelay() *
+                  SyncMaster::GetInstance()->GetPlaySampleCount());
+  ms->GetSendFx()->SetParameters(delay, project_->GetFxFeedback(),
+                                 project_->GetFxReverb());
   clipped_ = ms->Clipped();
 };
 
@@ -141,6 +149,10 @@ bool PlayerMixer::IsChannelMuted(int channel) {
   return channel_[channel]->IsMuted();
 }
 
+void PlayerMixer::SetChannelSend(int channel, int level) {
+  channel_[channel]->SetSend(level);
+}
+
 void PlayerMixer::StartStreaming(const Path &path) {
   fileStreamer_.Start(path);
 };
@@ -148,6 +160,9 @@ void PlayerMixer::StartStreaming(const Path &path) {
 void PlayerMixer::StopStreaming() { fileStreamer_.Stop(); };
 
 void PlayerMixer::OnPlayerStart() {
+  for (int i = 0; i < SONG_CHANNEL_COUNT; i++) {
+    channel_[i]->SetSend(0);
+  }
   MixerService *ms = MixerService::GetInstance();
   ms->OnPlayerStart();
 }
@@ -54,6 +54,8 @@ public:
   void SetChannelMute(int channel, bool mute);
   bool IsChannelMuted(int channel);
 
+  void SetChannelSend(int channel, int level);
+
   const char *GetPlayedNote(int channel);
   const char *GetPlayedOctive(int channel);
 
@@ -0,0 +1,93 @@
+#include "RenderBudget.h"
+#include "Services/Audio/AudioMixer.h"
+#include "System/System/System.h"
+
+RenderBudget::RenderBudget() { Reset(); }
+
+void RenderBudget::Reset() {
+  for (int i = 0; i < SONG_CHANNEL_COUNT; i++) {
+    qualityCap_[i] = RB_QUALITY_MAX;
+    voiceStart_[i] = 0;
+    voiceTime_[i] = 0;
+    lastVoiceTime_[i] = 0;
+  }
+  meterTotal_ = AudioMixer::GetMeterTime();
+  meterTime_ = 0;
+  load_ = 0;
+  stableCount_ = 0;
+}
+
+AUDIO_FUNC void RenderBudget::StartVoice(int voice) {
+  voiceStart_[voice] = System::GetInstance()->GetMicros();
+}
+
+AUDIO_FUNC void RenderBudget::StopVoice(int voice) {
+  voiceTime_[voice] += System::GetInstance()->GetMicros() - voiceStart_[voice];
+}
+
+void RenderBudget::EndBuffer(unsigned long renderTime, int sampleCount) {
+
+  // Time it takes to play the buffer at 44.1Khz
+
+  unsigned long playTime = (unsigned long)sampleCount * 1000000 / 44100;
+  if (playTime == 0) {
+    return;
+  }
+  load_ = renderTime * 100 / playTime;
+
+  if (load_ > RB_LOAD_HIGH) {
+    downgradeVoice();
+    stableCount_ = 0;
+  } else if (load_ < RB_LOAD_LOW) {
+    if (++stableCount_ >= RB_STABLE_BUFFERS) {
+      upgradeVoice();
+      stableCount_ = 0;
+    }
+  } else {
+    stableCount_ = 0;
+  }
+
+  for (int i = 0; i < SONG_CHANNEL_COUNT; i++) {
+    lastVoiceTime_[i] = voiceTime_[i];
+    voiceTime_[i] = 0;
+  }
+  unsigned long meterTotal = AudioMixer::GetMeterTime();
+  meterTime_ = meterTotal - meterTotal_;
+  meterTotal_ = meterTotal;
+}
+
+void RenderBudget::downgradeVoice() {
+
+  // Pick the most expensive voice we can still degrade
+
+  int worst = -1;
+  for (int i = 0; i < SONG_CHANNEL_COUNT; i++) {
+    if (qualityCap_[i] > RB_QUALITY_MIN) {
+      if ((worst < 0) || (voiceTime_[i] > voiceTime_[worst])) {
+        worst = i;
+      }
+    }
+  }
+  if (worst >= 0) {
+    qualityCap_[worst]--;
+  }
+}
+
+void RenderBudget::upgradeVoice() {
+  for (int i = 0; i < SONG_CHANNEL_COUNT; i++) {
+    if (qualityCap_[i] < RB_QUALITY_MAX) {
+      qualityCap_[i]++;
+      return;
+    }
+  }
+}
+
+int RenderBudget::GetQualityCap(int voice) { return qualityCap_[voice]; }
+
+int RenderBudget::GetLoad() { return load_; }
+
+unsigned long RenderBudget::GetVoiceTime(int voice) {
+  return lastVoiceTime_[voice];
+}
+
+unsigned long RenderBudget::GetMeterTime() { return meterTime_; }
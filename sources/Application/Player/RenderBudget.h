@@ -0,0 +1,54 @@
+#ifndef _RENDER_BUDGET_H_
+#define _RENDER_BUDGET_H_
+
+#include "Application/Model/Song.h"
+#include "Foundation/T_Singleton.h"
+
+// Keeps track of how long each voice takes to render compared to the time the
+// audio buffer takes to play. When the render time gets close to the deadline,
+// the most expensive voice gets its quality cap lowered so that it uses a
+// cheaper kernel. Caps are raised back one at a time once things are stable.
+
+// Quality levels voices can be capped to
+#define RB_QUALITY_MIN 1 // never degrade below linear interpolation
+#define RB_QUALITY_MAX 3
+
+// Load thresholds (in percent of the buffer play time)
+#define RB_LOAD_HIGH 85
+#define RB_LOAD_LOW 60
+
+// Number of consecutive low load buffers before we upgrade a voice
+#define RB_STABLE_BUFFERS 16
+
+class RenderBudget : public T_Singleton<RenderBudget> {
+public:
+  RenderBudget();
+  void Reset();
+
+  // Per voice profiling, called around each voice render
+  void StartVoice(int voice);
+  void StopVoice(int voice);
+
+  // Called once the whole buffer has been rendered
+  void EndBuffer(unsigned long renderTime, int sampleCount); // time in us
+
+  int GetQualityCap(int voice);
+  int GetLoad();                       // in percent
+  unsigned long GetVoiceTime(int voice); // in us, last rendered buffer
+  unsigned long GetMeterTime();          // in us, last rendered buffer
+
+private:
+  void downgradeVoice();
+  void upgradeVoice();
+
+  int qualityCap_[SONG_CHANNEL_COUNT];
+  unsigned long voiceStart_[SONG_CHANNEL_COUNT];
+  unsigned long voiceTime_[SONG_CHANNEL_COUNT];
+  unsigned long lastVoiceTime_[SONG_CHANNEL_COUNT];
+  unsigned long meterTotal_; // mixer metering time at the last buffer end
+  unsigned long meterTime_;
+  int load_;
+  int stableCount_;
+};
+
+#endif
@@ -277,6 +277,27 @@ inline void fourCC2char(const FourCC f, char *s) {
   case 69:
     strcpy(s, "WRAP");
     break;
+  case 70:
+    strcpy(s, "SND"); // SEND
+    break;
+  case 71:
+    strcpy(s, "FXDT");
+    break;
+  case 72:
+    strcpy(s, "FXFB");
+    break;
+  case 73:
+    strcpy(s, "FXRV");
+    break;
+  case 74:
+    strcpy(s, "ENV"); // ENVL
+    break;
+  case 75:
+    strcpy(s, "LFO");
+    break;
+  case 76:
+    strcpy(s, "EMD"); // EMOD
+    break;
   }
 };
 #endif
@@ -0,0 +1,108 @@
+// Software model of the RP2040 SIO interpolators
+
+#include "interp.h"
+
+#ifndef PICOBUILD
+
+interp_hw_t interpModel[2] = {
+    {{0, 0}, {0, 0, 0}, {31u << INTERP_CTRL_MASK_MSB_LSB,
+                         31u << INTERP_CTRL_MASK_MSB_LSB}},
+    {{0, 0}, {0, 0, 0}, {31u << INTERP_CTRL_MASK_MSB_LSB,
+                         31u << INTERP_CTRL_MASK_MSB_LSB}}};
+
+// Shift, mask and sign extension of one lane. The shift is a plain right
+// shift: kernels only use masks that keep bits which would be the same if it
+// were a rotate
+
+static uint32_t shiftAndMask(interp_hw_t *interp, int lane) {
+  uint32_t ctrl = interp->ctrl[lane];
+  uint32_t input = (ctrl & INTERP_CTRL_CROSS_INPUT) ? interp->accum[1 - lane]
+                                                     : interp->accum[lane];
+  int shift = (ctrl >> INTERP_CTRL_SHIFT_LSB) & 0x1F;
+  int lsb = (ctrl >> INTERP_CTRL_MASK_LSB_LSB) & 0x1F;
+  int msb = (ctrl >> INTERP_CTRL_MASK_MSB_LSB) & 0x1F;
+
+  uint32_t mask = (0xFFFFFFFFu >> (31 - msb)) & (0xFFFFFFFFu << lsb);
+  uint32_t value = (input >> shift) & mask;
+  if ((ctrl & INTERP_CTRL_SIGNED) && (msb < 31) && (value & (1u << msb))) {
+    value |= 0xFFFFFFFFu << (msb + 1);
+  }
+  return value;
+}
+
+static void computeResults(interp_hw_t *interp, uint32_t result[3]) {
+  uint32_t sm0 = shiftAndMask(interp, 0);
+  uint32_t sm1 = shiftAndMask(interp, 1);
+  uint32_t ctrl0 = interp->ctrl[0];
+  uint32_t ctrl1 = interp->ctrl[1];
+
+  result[0] =
+      interp->base[0] + ((ctrl0 & INTERP_CTRL_ADD_RAW) ? interp->accum[0] : sm0);
+  result[1] =
+      interp->base[1] + ((ctrl1 & INTERP_CTRL_ADD_RAW) ? interp->accum[1] : sm1);
+  result[2] = interp->base[2] + sm0 + sm1;
+
+  if ((interp == interp0) && (ctrl0 & INTERP_CTRL_BLEND)) {
+
+    // Lane 1 blends between base 0 and base 1 using the 8 low bits of its
+    // shift and mask value, lane 0 returns those bits and the full result
+    // leaves lane 1 out
+
+    long long alpha = sm1 & 0xFF;
+    long long b0, b1;
+    if (ctrl1 & INTERP_CTRL_SIGNED) {
+      b0 = (int32_t)interp->base[0];
+      b1 = (int32_t)interp->base[1];
+    } else {
+      b0 = interp->base[0];
+      b1 = interp->base[1];
+    }
+    result[1] = (uint32_t)(b0 + (((b1 - b0) * alpha) >> 8));
+    result[0] = (uint32_t)alpha;
+    result[2] = interp->base[2] + sm0;
+  }
+
+  if ((interp == interp1) && (ctrl0 & INTERP_CTRL_CLAMP)) {
+
+    // Lane 0 clamps its shift and mask value between base 0 and base 1
+
+    if (ctrl0 & INTERP_CTRL_SIGNED) {
+      int32_t v = (int32_t)sm0;
+      v = (v < (int32_t)interp->base[0]) ? (int32_t)interp->base[0] : v;
+      v = (v > (int32_t)interp->base[1]) ? (int32_t)interp->base[1] : v;
+      result[0] = (uint32_t)v;
+    } else {
+      uint32_t v = sm0;
+      v = (v < interp->base[0]) ? interp->base[0] : v;
+      v = (v > interp->base[1]) ? interp->base[1] : v;
+      result[0] = v;
+    }
+  }
+}
+
+// FORCE_MSB is only applied to what's read, not to what's fed back
+
+static void forceBits(interp_hw_t *interp, uint32_t result[3]) {
+  for (int lane = 0; lane < 2; lane++) {
+    uint32_t force = (interp->ctrl[lane] >> INTERP_CTRL_FORCE_MSB_LSB) & 3;
+    result[lane] |= force << 28;
+  }
+}
+
+void interp_model_results(interp_hw_t *interp, uint32_t result[3]) {
+  computeResults(interp, result);
+  forceBits(interp, result);
+}
+
+// Popping any result writes both lane results back to the accumulators
+
+void interp_model_pop(interp_hw_t *interp, uint32_t result[3]) {
+  computeResults(interp, result);
+  interp->accum[0] = (interp->ctrl[0] & INTERP_CTRL_CROSS_RESULT) ? result[1]
+                                                                   : result[0];
+  interp->accum[1] = (interp->ctrl[1] & INTERP_CTRL_CROSS_RESULT) ? result[0]
+                                                                   : result[1];
+  forceBits(interp, result);
+}
+
+#endif
@@ -0,0 +1,156 @@
+// RP2040 SIO interpolators
+
+#ifndef _INTERP_H
+#define _INTERP_H
+
+#ifdef PICOBUILD
+
+#include "hardware/interp.h"
+
+#else
+
+// Software model of the interpolator registers, following the RP2040
+// datasheet (2.3.1.6), behind the same calls as the SDK's hardware/interp.h
+// so kernels written for the hardware build and run unchanged on the host.
+// There is one pair of interpolators for the whole process where the pico
+// has one per core, so only the audio thread may use them
+
+#include <stdint.h>
+
+typedef unsigned int uint;
+
+typedef struct {
+  uint32_t accum[2];
+  uint32_t base[3];
+  uint32_t ctrl[2];
+} interp_hw_t;
+
+typedef struct {
+  uint32_t ctrl;
+} interp_config;
+
+extern interp_hw_t interpModel[2];
+
+#define interp0 (&interpModel[0])
+#define interp1 (&interpModel[1])
+
+// Lane control bits, as in SIO_INTERPx_CTRL_LANEy
+
+#define INTERP_CTRL_SHIFT_LSB 0
+#define INTERP_CTRL_MASK_LSB_LSB 5
+#define INTERP_CTRL_MASK_MSB_LSB 10
+#define INTERP_CTRL_SIGNED (1u << 15)
+#define INTERP_CTRL_CROSS_INPUT (1u << 16)
+#define INTERP_CTRL_CROSS_RESULT (1u << 17)
+#define INTERP_CTRL_ADD_RAW (1u << 18)
+#define INTERP_CTRL_FORCE_MSB_LSB 19
+#define INTERP_CTRL_BLEND (1u << 21) // interp0 lane 0 only
+#define INTERP_CTRL_CLAMP (1u << 22) // interp1 lane 0 only
+
+static inline interp_config interp_default_config() {
+  interp_config c;
+  c.ctrl = 31u << INTERP_CTRL_MASK_MSB_LSB;
+  return c;
+}
+
+static inline void interp_config_set_shift(interp_config *c, uint shift) {
+  c->ctrl = (c->ctrl & ~(0x1Fu << INTERP_CTRL_SHIFT_LSB)) |
+            (shift << INTERP_CTRL_SHIFT_LSB);
+}
+
+static inline void interp_config_set_mask(interp_config *c, uint mask_lsb,
+                                          uint mask_msb) {
+  c->ctrl = (c->ctrl & ~(0x3FFu << INTERP_CTRL_MASK_LSB_LSB)) |
+            (mask_lsb << INTERP_CTRL_MASK_LSB_LSB) |
+            (mask_msb << INTERP_CTRL_MASK_MSB_LSB);
+}
+
+static inline void interp_config_set_flag(interp_config *c, uint32_t flag,
+                                          bool set) {
+  c->ctrl = set ? (c->ctrl | flag) : (c->ctrl & ~flag);
+}
+
+static inline void interp_config_set_signed(interp_config *c, bool _signed) {
+  interp_config_set_flag(c, INTERP_CTRL_SIGNED, _signed);
+}
+
+static inline void interp_config_set_cross_input(interp_config *c,
+                                                 bool cross_input) {
+  interp_config_set_flag(c, INTERP_CTRL_CROSS_INPUT, cross_input);
+}
+
+static inline void interp_config_set_cross_result(interp_config *c,
+                                                  bool cross_result) {
+  interp_config_set_flag(c, INTERP_CTRL_CROSS_RESULT, cross_result);
+}
+
+static inline void interp_config_set_add_raw(interp_config *c, bool add_raw) {
+  interp_config_set_flag(c, INTERP_CTRL_ADD_RAW, add_raw);
+}
+
+static inline void interp_config_set_blend(interp_config *c, bool blend) {
+  interp_config_set_flag(c, INTERP_CTRL_BLEND, blend);
+}
+
+static inline void interp_config_set_clamp(interp_config *c, bool clamp) {
+  interp_config_set_flag(c, INTERP_CTRL_CLAMP, clamp);
+}
+
+static inline void interp_config_set_force_bits(interp_config *c, uint bits) {
+  c->ctrl = (c->ctrl & ~(3u << INTERP_CTRL_FORCE_MSB_LSB)) |
+            (bits << INTERP_CTRL_FORCE_MSB_LSB);
+}
+
+static inline void interp_set_config(interp_hw_t *interp, uint lane,
+                                     interp_config *config) {
+  interp->ctrl[lane] = config->ctrl;
+}
+
+static inline void interp_set_base(interp_hw_t *interp, uint lane,
+                                   uint32_t val) {
+  interp->base[lane] = val;
+}
+
+static inline uint32_t interp_get_base(interp_hw_t *interp, uint lane) {
+  return interp->base[lane];
+}
+
+static inline void interp_set_accumulator(interp_hw_t *interp, uint lane,
+                                          uint32_t val) {
+  interp->accum[lane] = val;
+}
+
+static inline uint32_t interp_get_accumulator(interp_hw_t *interp,
+                                              uint lane) {
+  return interp->accum[lane];
+}
+
+// Computes the three results the hardware presents on the bus
+
+void interp_model_results(interp_hw_t *interp, uint32_t result[3]);
+void interp_model_pop(interp_hw_t *interp, uint32_t result[3]);
+
+static inline uint32_t interp_peek_lane_result(interp_hw_t *interp,
+                                               uint lane) {
+  uint32_t result[3];
+  interp_model_results(interp, result);
+  return result[lane];
+}
+
+static inline uint32_t interp_pop_lane_result(interp_hw_t *interp, uint lane) {
+  uint32_t result[3];
+  interp_model_pop(interp, result);
+  return result[lane];
+}
+
+static inline uint32_t interp_peek_full_result(interp_hw_t *interp) {
+  return interp_peek_lane_result(interp, 2);
+}
+
+static inline uint32_t interp_pop_full_result(interp_hw_t *interp) {
+  return interp_pop_lane_result(interp, 2);
+}
+
+#endif // PICOBUILD
+
+#endif /*_INTERP_H*/
@@ -1,5 +1,6 @@
 #include "View.h"
 #include "Application/AppWindow.h"
+#include "Application/Model/UndoJournal.h"
 #include "Application/Player/Player.h"
 #include "Application/Utils/char.h"
 #include "ModalView.h"
@@ -220,3 +221,15 @@ void View::DrawString(int x, int y, const char *txt, GUITextProperties &props) {
         GUIPoint pos(x, y);
         w_.DrawString(txt, pos, props);
 };
+
+void View::undoEdit() {
+  if (UndoJournal::GetInstance()->Undo()) {
+    isDirty_ = true;
+  }
+};
+
+void View::redoEdit() {
+  if (UndoJournal::GetInstance()->Redo()) {
+    isDirty_ = true;
+  }
+};
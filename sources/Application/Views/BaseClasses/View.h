@@ -130,6 +130,9 @@ protected:
   void drawMap();
   void drawNotes();
 
+  void undoEdit();
+  void redoEdit();
+
 public: // temp hack for modl windo constructors
   GUIWindow &w_;
   ViewData *viewData_;
@@ -1,4 +1,5 @@
 #include "ChainView.h"
+#include "Application/Model/UndoJournal.h"
 #include "Application/Utils/char.h"
 #include "System/Console/Trace.h"
 #include "UIController.h"
@@ -385,6 +386,13 @@ void ChainView::ProcessButtonMask(unsigned short mask, bool pressed) {
     return;
   };
 
+  // Edits never leave the current chain
+
+  Chain *chain = viewData_->song_->chain_;
+  UndoJournal *journal = UndoJournal::GetInstance();
+  journal->Watch(chain->data_ + 16 * viewData_->currentChain_, 16);
+  journal->Watch(chain->transpose_ + 16 * viewData_->currentChain_, 16);
+
   if (viewMode_ == VM_NEW) {
     if (mask == EPBM_A) {
       unsigned short next = viewData_->song_->phrase_->GetNext();
@@ -506,7 +514,10 @@ void ChainView::processNormalButtonMask(unsigned short mask) {
       } else {
         // L Modifier
         if (mask & EPBM_L) {
-
+          if (mask & EPBM_LEFT)
+            undoEdit();
+          if (mask & EPBM_RIGHT)
+            redoEdit();
         } else {
           // NO modifier
           if (mask & EPBM_DOWN)
@@ -1,6 +1,7 @@
 
 #include "GrooveView.h"
 #include "Application/Model/Groove.h"
+#include "Application/Model/UndoJournal.h"
 #include "Application/Utils/char.h"
 
 GrooveView::GrooveView(GUIWindow &w, ViewData *viewData) : View(w, viewData) {
@@ -66,6 +67,9 @@ void GrooveView::ProcessButtonMask(unsigned short mask, bool pressed) {
   if (!pressed)
     return;
 
+  UndoJournal::GetInstance()->Watch(
+      Groove::GetInstance()->GetGrooveData(viewData_->currentGroove_), 16);
+
   Player *player = Player::GetInstance();
 
   if (mask & EPBM_B) {
@@ -118,6 +122,12 @@ void GrooveView::ProcessButtonMask(unsigned short mask, bool pressed) {
                                 viewData_->chainRow_);
         }
 
+      } else if (mask & EPBM_L) {
+        // L Modifier
+        if (mask & EPBM_LEFT)
+          undoEdit();
+        if (mask & EPBM_RIGHT)
+          redoEdit();
       } else {
         // No modifier
         if (mask & EPBM_DOWN)
@@ -9,6 +9,7 @@
 #include "BaseClasses/UIStaticField.h"
 #include "ModalDialogs/ImportSampleDialog.h"
 #include "ModalDialogs/PagedImportSampleDialog.h"
+#include "ModalDialogs/SampleWaveDialog.h"
 #include "ModalDialogs/MessageBox.h"
 #include "System/System/System.h"
 
@@ -166,7 +167,8 @@ void InstrumentView::fillSampleParameters() {
 #endif
   position._y += 2;
   v = instrument->FindVariable(SIP_INTERPOLATION);
-  f1 = new UIIntVarField(position, *v, "interpolation: %s", 0, 1, 1, 1);
+  f1 = new UIIntVarField(position, *v, "interpolation: %s", 0,
+                         SIIP_LAST - 1, 1, 1);
   T_SimpleList<UIField>::Insert(f1);
 
   position._y += 1;
@@ -241,7 +243,19 @@ void InstrumentView::fillMidiParameters() {
   T_SimpleList<UIField>::Insert(f1);
 };
 
+// Scrolling through the sample field only changes the variable, the
+// instrument loads its sample once we're done with it
+
+void InstrumentView::commitSample() {
+  if (getInstrumentType() == IT_SAMPLE) {
+    int i = viewData_->currentInstrument_;
+    InstrumentBank *bank = viewData_->project_->GetInstrumentBank();
+    ((SampleInstrument *)bank->GetInstrument(i))->LoadSource();
+  }
+};
+
 void InstrumentView::warpToNext(int offset) {
+  commitSample();
   int instrument = viewData_->currentInstrument_ + offset;
   if (instrument >= MAX_INSTRUMENT_COUNT) {
     instrument = instrument - MAX_INSTRUMENT_COUNT;
@@ -290,6 +304,17 @@ void InstrumentView::ProcessButtonMask(unsigned short mask, bool pressed) {
         }
         break;
       }
+      case SIP_START:
+      case SIP_LOOPSTART:
+      case SIP_END: {
+        int i = viewData_->currentInstrument_;
+        InstrumentBank *bank = viewData_->project_->GetInstrumentBank();
+        I_Instrument *instr = bank->GetInstrument(i);
+        SampleWaveDialog *swd =
+            new SampleWaveDialog(*this, (SampleInstrument *)instr, v.GetID());
+        DoModal(swd);
+        break;
+      }
       case SIP_TABLE: {
         int next = TableHolder::GetInstance()->GetNext();
         if (next != NO_MORE_TABLE) {
@@ -374,7 +399,8 @@ void InstrumentView::ProcessButtonMask(unsigned short mask, bool pressed) {
     if (mask == EPBM_A) {
       FourCC varID = ((UIIntVarField *)GetFocus())->GetVariableID();
       if ((varID == SIP_TABLE) || (varID == MIP_TABLE) ||
-          (varID == SIP_SAMPLE)) {
+          (varID == SIP_SAMPLE) || (varID == SIP_START) ||
+          (varID == SIP_LOOPSTART) || (varID == SIP_END)) {
         viewMode_ = VM_NEW;
       };
     } else {
@@ -435,6 +461,9 @@ void InstrumentView::ProcessButtonMask(unsigned short mask, bool pressed) {
   if (field) {
     lastFocusID_ = field->GetVariableID();
   }
+  if (!field || (lastFocusID_ != SIP_SAMPLE) || (mask & EPBM_R)) {
+    commitSample();
+  }
 };
 
 void InstrumentView::DrawView() {
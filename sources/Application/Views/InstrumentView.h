@@ -18,6 +18,7 @@ public:
 protected:
   void warpToNext(int offset);
   void onInstrumentChange();
+  void commitSample();
   void fillSampleParameters();
   void fillMidiParameters();
   InstrumentType getInstrumentType();
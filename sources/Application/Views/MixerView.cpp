@@ -0,0 +1,182 @@
+#include "MixerView.h"
+#include "Application/Mixer/MixerService.h"
+#include "Application/Model/Mixer.h"
+#include "Application/Player/Player.h"
+
+#define METER_WIDTH 12 // cells, 6dB each
+#define SCOPE_HEIGHT 8
+
+MixerView::MixerView(GUIWindow &w, ViewData *viewData) : View(w, viewData) {}
+
+MixerView::~MixerView() {}
+
+// Convert a 0..32767 level to a number of cells, one per bit (~6dB)
+
+static int levelToCells(int level) {
+  int bits = 0;
+  while (level) {
+    bits++;
+    level >>= 1;
+  }
+  int cells = bits - (15 - METER_WIDTH);
+  return (cells < 0) ? 0 : cells;
+}
+
+// RMS level is drawn as a bar, peak as a marker past it
+
+static void fillMeter(char *buffer, int rms, int peak) {
+  int rmsCells = levelToCells(rms);
+  int peakCells = levelToCells(peak);
+  for (int i = 0; i < METER_WIDTH; i++) {
+    if (i < rmsCells) {
+      buffer[i] = '=';
+    } else if (i == peakCells - 1) {
+      buffer[i] = '|';
+    } else {
+      buffer[i] = '.';
+    }
+  }
+  buffer[METER_WIDTH] = 0;
+}
+
+void MixerView::switchView(ViewType vt) {
+  AudioMixer::EnableMetering(false);
+  ViewEvent ve(VET_SWITCH_VIEW, &vt);
+  SetChanged();
+  NotifyObservers(&ve);
+}
+
+void MixerView::ProcessButtonMask(unsigned short mask, bool pressed) {
+
+  if (!pressed)
+    return;
+
+  if (mask & EPBM_R) {
+    if (mask & EPBM_UP) {
+      switchView(VT_SONG);
+    }
+  } else {
+    if (mask & EPBM_START) {
+      Player *player = Player::GetInstance();
+      player->OnSongStartButton(0, SONG_CHANNEL_COUNT - 1, false, false);
+    }
+  }
+};
+
+void MixerView::DrawView() {
+
+  Clear();
+
+  GUITextProperties props;
+  GUIPoint pos = GetTitlePosition();
+
+  SetColor(CD_NORMAL);
+  DrawString(pos._x, pos._y, "Mixer", props);
+
+  // Channel labels
+
+  SetColor(CD_HILITE1);
+  GUIPoint anchor = GetAnchor();
+  char buffer[4];
+  pos = anchor;
+  pos._x -= 3;
+  for (int i = 0; i < SONG_CHANNEL_COUNT; i++) {
+    sprintf(buffer, "%d", i + 1);
+    DrawString(pos._x, pos._y, buffer, props);
+    pos._y++;
+  }
+  pos._y++;
+  DrawString(pos._x, pos._y, "M", props);
+
+  drawMeters();
+  drawScope();
+};
+
+void MixerView::drawMeters() {
+
+  GUITextProperties props;
+  GUIPoint pos = GetAnchor();
+  char buffer[METER_WIDTH + 1];
+
+  SetColor(CD_NORMAL);
+
+  MixerService *ms = MixerService::GetInstance();
+  Mixer *mixer = Mixer::GetInstance();
+
+  for (int i = 0; i < SONG_CHANNEL_COUNT + 1; i++) {
+    AudioMixer *bus;
+    if (i < SONG_CHANNEL_COUNT) {
+      bus = ms->GetMixBus(mixer->GetBus(i));
+    } else {
+      bus = ms->GetAudioOut();
+      pos._y++;
+    }
+    if (!bus) {
+      continue;
+    }
+    fillMeter(buffer, bus->GetRms(0), bus->GetPeak(0));
+    DrawString(pos._x, pos._y, buffer, props);
+    fillMeter(buffer, bus->GetRms(1), bus->GetPeak(1));
+    DrawString(pos._x + METER_WIDTH + 1, pos._y, buffer, props);
+    pos._y++;
+  }
+
+  Player *player = Player::GetInstance();
+  pos = GetTitlePosition();
+  pos._x = 26;
+  DrawString(pos._x, pos._y, player->Clipped() ? "clip" : "----", props);
+
+  // Audio buffer depth and underrun/overrun counters under the scope
+
+  AudioOut *out = ms->GetAudioOut();
+  if (out) {
+    char line[SCOPE_SIZE + 1];
+    snprintf(line, sizeof(line), "buf %2d  under %4d  over %4d",
+             out->GetBufferDepth(), out->GetUnderrunCount() % 10000,
+             out->GetOverrunCount() % 10000);
+    pos = GetAnchor();
+    pos._x = 0;
+    pos._y += SONG_CHANNEL_COUNT + 3 + SCOPE_HEIGHT;
+    DrawString(pos._x, pos._y, line, props);
+  }
+};
+
+void MixerView::drawScope() {
+
+  GUITextProperties props;
+  GUIPoint pos = GetAnchor();
+  pos._x = 0;
+  pos._y += SONG_CHANNEL_COUNT + 3;
+
+  short scope[SCOPE_SIZE];
+  AudioOut *out = MixerService::GetInstance()->GetAudioOut();
+  if (out) {
+    out->GetScope(scope);
+  } else {
+    memset(scope, 0, sizeof(scope));
+  }
+
+  // Each point lands on one of SCOPE_HEIGHT rows, top being positive
+
+  unsigned char rows[SCOPE_SIZE];
+  for (int i = 0; i < SCOPE_SIZE; i++) {
+    rows[i] = ((32767 - scope[i]) * SCOPE_HEIGHT) >> 16;
+  }
+
+  SetColor(CD_HILITE2);
+  char line[SCOPE_SIZE + 1];
+  line[SCOPE_SIZE] = 0;
+  for (int r = 0; r < SCOPE_HEIGHT; r++) {
+    for (int i = 0; i < SCOPE_SIZE; i++) {
+      line[i] = (rows[i] == r) ? '*' : ' ';
+    }
+    DrawString(pos._x, pos._y + r, line, props);
+  }
+};
+
+void MixerView::OnPlayerUpdate(PlayerEventType, unsigned int tick) {
+  drawMeters();
+  drawScope();
+};
+
+void MixerView::OnFocus() { AudioMixer::EnableMetering(true); };
@@ -0,0 +1,23 @@
+#ifndef _MIXER_VIEW_H_
+#define _MIXER_VIEW_H_
+
+#include "BaseClasses/View.h"
+#include "ViewData.h"
+
+// Displays channel and master levels along with a scope of the master output
+
+class MixerView : public View {
+public:
+  MixerView(GUIWindow &w, ViewData *viewData);
+  ~MixerView();
+  virtual void ProcessButtonMask(unsigned short mask, bool pressed);
+  virtual void DrawView();
+  virtual void OnPlayerUpdate(PlayerEventType, unsigned int tick = 0);
+  virtual void OnFocus();
+
+protected:
+  void drawMeters();
+  void drawScope();
+  void switchView(ViewType vt);
+};
+#endif
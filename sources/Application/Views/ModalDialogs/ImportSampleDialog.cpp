@@ -1,7 +1,9 @@
 #include "ImportSampleDialog.h"
 #include "Application/Instruments/SampleInstrument.h"
 #include "Application/Instruments/SamplePool.h"
+#ifdef PICOBUILD
 #include "pico/multicore.h"
+#endif
 #include <memory>
 
 #define LIST_SIZE 15
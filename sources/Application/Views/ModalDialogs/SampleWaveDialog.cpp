@@ -0,0 +1,182 @@
+#include "SampleWaveDialog.h"
+#include "Application/Instruments/SamplePool.h"
+
+#define WAVE_WIDTH 28
+#define WAVE_HEIGHT 8
+
+SampleWaveDialog::SampleWaveDialog(View &view, SampleInstrument *instrument,
+                                   FourCC edited)
+    : ModalView(view) {
+  int index = instrument->GetSampleIndex();
+  source_ = (index >= 0) ? SamplePool::GetInstance()->GetSource(index) : 0;
+  size_ = source_ ? source_->GetSize(-1) : 0;
+  start_ = instrument->FindVariable(SIP_START);
+  loopStart_ = instrument->FindVariable(SIP_LOOPSTART);
+  end_ = instrument->FindVariable(SIP_END);
+  edited_ = instrument->FindVariable(edited);
+  zoom_ = 0;
+  offset_ = 0;
+}
+
+SampleWaveDialog::~SampleWaveDialog() {}
+
+int SampleWaveDialog::frameToBucket(int frame) {
+  return int((long long)frame * PEAK_COUNT / size_);
+}
+
+// Returns -1 if the bucket isn't visible
+
+int SampleWaveDialog::bucketToColumn(int bucket) {
+  int span = PEAK_COUNT >> zoom_;
+  if ((bucket < offset_) || (bucket >= offset_ + span)) {
+    return -1;
+  }
+  return (bucket - offset_) * WAVE_WIDTH / span;
+}
+
+void SampleWaveDialog::scrollToPoint() {
+  int span = PEAK_COUNT >> zoom_;
+  int bucket = frameToBucket(edited_->GetInt());
+  if ((bucket < offset_) || (bucket >= offset_ + span)) {
+    offset_ = bucket - span / 2;
+  }
+  if (offset_ > PEAK_COUNT - span) {
+    offset_ = PEAK_COUNT - span;
+  }
+  if (offset_ < 0) {
+    offset_ = 0;
+  }
+  // Keep the view on bucket boundaries of the level being drawn
+  offset_ &= ~((1 << (PEAK_LEVELS - 1 - zoom_)) - 1);
+}
+
+void SampleWaveDialog::setZoom(int zoom) {
+  if ((zoom < 0) || (zoom >= PEAK_LEVELS)) {
+    return;
+  }
+  zoom_ = zoom;
+  offset_ = frameToBucket(edited_->GetInt()) - (PEAK_COUNT >> zoom_) / 2;
+  scrollToPoint();
+  isDirty_ = true;
+}
+
+void SampleWaveDialog::movePoint(int frames) {
+  int value = edited_->GetInt() + frames;
+  if (value < 0) {
+    value = 0;
+  }
+  if (value > size_ - 1) {
+    value = size_ - 1;
+  }
+  edited_->SetInt(value);
+  scrollToPoint();
+  isDirty_ = true;
+}
+
+void SampleWaveDialog::DrawView() {
+
+  SetWindow(WAVE_WIDTH, WAVE_HEIGHT + 3);
+
+  GUITextProperties props;
+  SetColor(CD_NORMAL);
+
+  const signed char *peaks = 0;
+  int level = PEAK_LEVELS - 1 - zoom_;
+  if (source_ && (size_ > 0) && edited_) {
+    peaks = source_->GetPeaks(level);
+  }
+  if (!peaks) {
+    DrawString(0, 0, "No waveform available", props);
+    return;
+  }
+
+  char line[WAVE_WIDTH + 1];
+  sprintf(line, "%s: %7.7X x%d", edited_->GetName(), edited_->GetInt(),
+          1 << zoom_);
+  DrawString(0, 0, line, props);
+
+  // Columns map onto the buckets of the level with as many buckets as the
+  // visible span, merging one or two of them each
+
+  int count = PEAK_COUNT >> (PEAK_LEVELS - 1);
+  int first = offset_ >> level;
+  unsigned char top[WAVE_WIDTH];
+  unsigned char bottom[WAVE_WIDTH];
+  for (int c = 0; c < WAVE_WIDTH; c++) {
+    int b0 = first + c * count / WAVE_WIDTH;
+    int b1 = first + (c + 1) * count / WAVE_WIDTH;
+    if (b1 <= b0) {
+      b1 = b0 + 1;
+    }
+    int lo = 127;
+    int hi = -128;
+    for (int b = b0; b < b1; b++) {
+      lo = (peaks[2 * b] < lo) ? peaks[2 * b] : lo;
+      hi = (peaks[2 * b + 1] > hi) ? peaks[2 * b + 1] : hi;
+    }
+    top[c] = ((127 - hi) * WAVE_HEIGHT) >> 8;
+    bottom[c] = ((127 - lo) * WAVE_HEIGHT) >> 8;
+  }
+
+  SetColor(CD_HILITE2);
+  line[WAVE_WIDTH] = 0;
+  for (int r = 0; r < WAVE_HEIGHT; r++) {
+    for (int c = 0; c < WAVE_WIDTH; c++) {
+      line[c] = ((r >= top[c]) && (r <= bottom[c])) ? '|' : ' ';
+    }
+    DrawString(0, r + 2, line, props);
+  }
+
+  // Start and loop markers under the waveform
+
+  memset(line, ' ', WAVE_WIDTH);
+  Variable *markers[3] = {start_, loopStart_, end_};
+  const char marker[3] = {'S', 'L', 'E'};
+  for (int i = 0; i < 3; i++) {
+    int column = bucketToColumn(frameToBucket(markers[i]->GetInt()));
+    if (column >= 0) {
+      line[column] = marker[i];
+    }
+  }
+  SetColor(CD_NORMAL);
+  DrawString(0, WAVE_HEIGHT + 2, line, props);
+};
+
+void SampleWaveDialog::OnPlayerUpdate(PlayerEventType,
+                                      unsigned int currentTick){};
+
+void SampleWaveDialog::OnFocus() { scrollToPoint(); };
+
+void SampleWaveDialog::ProcessButtonMask(unsigned short mask, bool pressed) {
+
+  if (!pressed)
+    return;
+
+  if ((mask & EPBM_A) || (mask & EPBM_B)) {
+    EndModal(0);
+    return;
+  }
+  if ((size_ <= 0) || (!edited_)) {
+    return;
+  }
+
+  // A column worth of frames, or a single frame with L held
+
+  int step = int((long long)size_ * (PEAK_COUNT >> zoom_) / PEAK_COUNT /
+                 WAVE_WIDTH);
+  if ((step < 1) || (mask & EPBM_L)) {
+    step = 1;
+  }
+  if (mask & EPBM_LEFT) {
+    movePoint(-step);
+  }
+  if (mask & EPBM_RIGHT) {
+    movePoint(step);
+  }
+  if (mask & EPBM_UP) {
+    setZoom(zoom_ + 1);
+  }
+  if (mask & EPBM_DOWN) {
+    setZoom(zoom_ - 1);
+  }
+};
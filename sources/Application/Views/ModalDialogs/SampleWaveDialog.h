@@ -0,0 +1,39 @@
+#ifndef _SAMPLE_WAVE_DIALOG_H_
+#define _SAMPLE_WAVE_DIALOG_H_
+
+#include "Application/Instruments/SampleInstrument.h"
+#include "Application/Views/BaseClasses/ModalView.h"
+
+// Shows the waveform of an instrument's sample along with its start and loop
+// points, and lets one of the points be moved. Everything is drawn from the
+// sample's peak cache so zooming and scrolling don't touch the sample data
+
+class SampleWaveDialog : public ModalView {
+public:
+  SampleWaveDialog(View &view, SampleInstrument *instrument, FourCC edited);
+  virtual ~SampleWaveDialog();
+
+  virtual void DrawView();
+  virtual void OnPlayerUpdate(PlayerEventType, unsigned int currentTick);
+  virtual void OnFocus();
+  virtual void ProcessButtonMask(unsigned short mask, bool pressed);
+
+protected:
+  int frameToBucket(int frame);
+  int bucketToColumn(int bucket);
+  void movePoint(int frames);
+  void setZoom(int zoom);
+  void scrollToPoint();
+
+private:
+  SoundSource *source_;
+  int size_;
+  Variable *start_;
+  Variable *loopStart_;
+  Variable *end_;
+  Variable *edited_;
+  int zoom_;   // 0 shows the whole sample, each step doubles
+  int offset_; // first visible bucket of the finest level
+};
+
+#endif
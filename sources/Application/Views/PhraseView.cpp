@@ -1,6 +1,7 @@
 #include "PhraseView.h"
 #include "Application/Instruments/CommandList.h"
 #include "Application/Model/Table.h"
+#include "Application/Model/UndoJournal.h"
 #include "Application/Utils/char.h"
 #include "System/Console/Trace.h"
 #include "UIController.h"
@@ -651,6 +652,17 @@ void PhraseView::ProcessButtonMask(unsigned short mask, bool pressed) {
     return;
   };
 
+  // Edits never leave the current phrase
+
+  int offset = 16 * viewData_->currentPhrase_;
+  UndoJournal *journal = UndoJournal::GetInstance();
+  journal->Watch(phrase_->note_ + offset, 16);
+  journal->Watch(phrase_->instr_ + offset, 16);
+  journal->Watch(phrase_->cmd1_ + offset, 16 * sizeof(FourCC));
+  journal->Watch(phrase_->param1_ + offset, 16 * sizeof(ushort));
+  journal->Watch(phrase_->cmd2_ + offset, 16 * sizeof(FourCC));
+  journal->Watch(phrase_->param2_ + offset, 16 * sizeof(ushort));
+
   if (viewMode_ == VM_NEW) {
     if (mask == EPBM_A) {
 
@@ -883,7 +895,10 @@ void PhraseView::processNormalButtonMask(unsigned short mask) {
       } else {
         // L Modifier
         if (mask & EPBM_L) {
-
+          if (mask & EPBM_LEFT)
+            undoEdit();
+          if (mask & EPBM_RIGHT)
+            redoEdit();
         } else {
           // No modifier
 
@@ -1097,7 +1112,10 @@ void PhraseView::DrawView() {
         GUIPoint location = GetTitlePosition();
         location._x += 12;
         InstrumentBank *bank = viewData_->project_->GetInstrumentBank();
-        I_Instrument *instr = bank->GetInstrument(d);
+        I_Instrument *instr = bank->FindInstrument(d);
+        if (!instr) {
+          instr = bank->GetEmptyInstrument();
+        }
         instrLine += instr->GetName();
         DrawString(location._x, location._y, instrLine.c_str(), props);
       }
@@ -6,8 +6,10 @@
 #include "BaseClasses/UITempoField.h"
 #include "Services/Midi/MidiService.h"
 #include "System/System/System.h"
+#ifdef PICOBUILD
 #include "hardware/watchdog.h"
 #include "pico/bootrom.h"
+#endif
 
 #define ACTION_PURGE MAKE_FOURCC('P', 'U', 'R', 'G')
 #define ACTION_SAVE MAKE_FOURCC('S', 'A', 'V', 'E')
@@ -23,15 +25,19 @@ static void LoadCallback(View &v, ModalView &dialog) {
   if (dialog.GetReturnCode() == MBL_YES) {
     // TODO: Remove this hack. Due to memory leaks and other problems
     // instead of going back, we perform a software reset
+#ifdef PICOBUILD
     watchdog_reboot(0,0,0);
+#endif
     ((ProjectView &)v).OnLoadProject();
   }
 };
 
 static void BootselCallback(View &v, ModalView &dialog) {
+#ifdef PICOBUILD
   if (dialog.GetReturnCode() == MBL_YES) {
     reset_usb_boot(0, 0);
   }
+#endif
 };
 
 #ifndef NO_EXIT
@@ -73,6 +79,21 @@ ProjectView::ProjectView(GUIWindow &w, ViewData *data) : FieldView(w, data) {
       new UIIntVarField(position, *v, "transpose: %3.2d", -48, 48, 0x1, 0xC);
   T_SimpleList<UIField>::Insert(f2);
 
+  v = project_->FindVariable(VAR_FXDELAY);
+  position._y += 1;
+  f2 = new UIIntVarField(position, *v, "fx delay: %d", 1, 96, 1, 6);
+  T_SimpleList<UIField>::Insert(f2);
+
+  v = project_->FindVariable(VAR_FXFEEDBACK);
+  position._y += 1;
+  f2 = new UIIntVarField(position, *v, "fx feedback: %2.2X", 0, 0xFF, 1, 0x10);
+  T_SimpleList<UIField>::Insert(f2);
+
+  v = project_->FindVariable(VAR_FXREVERB);
+  position._y += 1;
+  f2 = new UIIntVarField(position, *v, "fx reverb: %2.2X", 0, 0xFF, 1, 0x10);
+  T_SimpleList<UIField>::Insert(f2);
+
   position._y += 2;
   UIActionField *a1 =
       new UIActionField("Compact Sequencer", ACTION_PURGE, position);
@@ -1,4 +1,5 @@
 #include "SongView.h"
+#include "Application/Model/UndoJournal.h"
 #include "Application/Player/Player.h"
 #include "Application/Utils/char.h"
 #include "System/Console/Trace.h"
@@ -119,6 +120,7 @@ void SongView::pasteLast() {
 
   unsigned char *c = viewData_->GetCurrentSongPointer();
   if (*c == 0xFF) {
+    UndoJournal::GetInstance()->Watch(c, 1);
     *c = lastChain_;
     viewData_->song_->chain_->SetUsed(*c);
     isDirty_ = true;
@@ -266,8 +268,12 @@ void SongView::cutSelection() {
 
   // now move all rows up for cut
 
-  unsigned char *dst = viewData_->song_->data_ + selRect.Left() +
-                       SONG_CHANNEL_COUNT * (selRect.Top());
+  unsigned char *row =
+      viewData_->song_->data_ + SONG_CHANNEL_COUNT * selRect.Top();
+  UndoJournal::GetInstance()->Watch(
+      row, SONG_CHANNEL_COUNT * (SONG_ROW_COUNT - selRect.Top()));
+
+  unsigned char *dst = row + selRect.Left();
   unsigned char *src = dst + SONG_CHANNEL_COUNT * clipboard_.height_;
 
   int rowCount = SONG_ROW_COUNT - selRect.Bottom() - 1;
@@ -312,6 +318,13 @@ void SongView::pasteClipboard() {
   int width = clipboard_.width_;
   int height = clipboard_.height_;
 
+  // Pasting shifts everything below the cursor
+
+  int top = viewData_->songY_ + viewData_->songOffset_;
+  unsigned char *row = viewData_->song_->data_ + SONG_CHANNEL_COUNT * top;
+  UndoJournal::GetInstance()->Watch(
+      row, SONG_CHANNEL_COUNT * (SONG_ROW_COUNT - top));
+
   if (viewData_->songX_ + width > SONG_CHANNEL_COUNT) {
     width = SONG_CHANNEL_COUNT - viewData_->songX_;
   }
@@ -652,6 +665,10 @@ void SongView::processNormalButtonMask(unsigned int mask) {
             jumpToNextSection(1);
           if (mask & EPBM_UP)
             jumpToNextSection(-1);
+          if (mask & EPBM_LEFT)
+            undoEdit();
+          if (mask & EPBM_RIGHT)
+            redoEdit();
           if (mask & EPBM_START)
             startCurrentRow();
         } else {
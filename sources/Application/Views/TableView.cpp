@@ -1,5 +1,6 @@
 #include "TableView.h"
 #include "Application/Instruments/CommandList.h"
+#include "Application/Model/UndoJournal.h"
 #include "Application/Player/TablePlayback.h"
 #include "Application/Utils/char.h"
 
@@ -487,6 +488,12 @@ void TableView::ProcessButtonMask(unsigned short mask, bool pressed) {
   if (!pressed) {
     return;
   }
+
+  // Edits never leave the current table
+
+  Table &table = TableHolder::GetInstance()->GetTable(viewData_->currentTable_);
+  UndoJournal::GetInstance()->Watch(&table, sizeof(Table));
+
   if (viewMode_ == VM_SELECTION) {
     if (!clipboard_.active_) {
       clipboard_.active_ = true;
@@ -570,7 +577,11 @@ void TableView::processNormalButtonMask(unsigned short mask) {
 
       } else {
         // L MOdifier
-        if (mask & EPBM_R) {
+        if (mask & EPBM_L) {
+          if (mask & EPBM_LEFT)
+            undoEdit();
+          if (mask & EPBM_RIGHT)
+            redoEdit();
         } else {
 
           // No modifier
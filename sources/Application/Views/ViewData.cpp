@@ -1,4 +1,5 @@
 #include "ViewData.h"
+#include "Application/Model/UndoJournal.h"
 #include "BaseClasses/View.h"
 
 ViewData::ViewData(Project *project) {
@@ -17,6 +18,8 @@ ViewData::ViewData(Project *project) {
   currentGroove_ = 0;
   mixerCol_ = 0;
   mixerRow_ = 0;
+  // History refers to the data of the previous project
+  UndoJournal::GetInstance()->Clear();
 };
 
 ViewData::~ViewData() { delete project_; };
@@ -24,6 +27,7 @@ ViewData::~ViewData() { delete project_; };
 unsigned char ViewData::UpdateSongChain(int offset) {
   unsigned char *c =
       song_->data_ + songX_ + SONG_CHANNEL_COUNT * (songOffset_ + songY_);
+  UndoJournal::GetInstance()->Watch(c, 1);
   updateData(c, offset, CHAIN_COUNT - 1, false);
   return *c;
 }
@@ -31,6 +35,7 @@ unsigned char ViewData::UpdateSongChain(int offset) {
 void ViewData::SetSongChain(unsigned char value) {
   unsigned char *c =
       song_->data_ + songX_ + SONG_CHANNEL_COUNT * (songOffset_ + songY_);
+  UndoJournal::GetInstance()->Watch(c, 1);
   *c = value;
 }
 
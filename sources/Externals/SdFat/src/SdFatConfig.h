@@ -49,7 +49,11 @@
 #define SPI_DRIVER_SELECT 3
 #define SD_CHIP_SELECT_MODE 2
 #define ENABLE_DEDICATED_SPI 1
+#ifdef SD_SDIO
+#define HAS_SDIO_CLASS 1
+#else
 #define HAS_SDIO_CLASS 0
+#endif
 #define SS 0
 #define USE_LFN_HASH  # to avoid use of arduino millis()
 
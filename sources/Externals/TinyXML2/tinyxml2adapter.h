@@ -13,6 +13,9 @@
 #ifdef __APPLE__
 #define fseeko(a, b, c) a->Seek(b, c)
 #define ftello(a) a->Tell()
+#elif defined(__unix__) && defined(__x86_64__)
+#define fseeko64(a, b, c) a->Seek(b, c)
+#define ftello64(a) a->Tell()
 #else
 #define fseek(a, b, c) a->Seek(b, c)
 #define ftell(a) a->Tell()
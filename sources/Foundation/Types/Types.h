@@ -235,6 +235,27 @@ inline constexpr FourCC MAKE_FOURCC(char ch0, char ch1, char ch2, char ch3) {
   case 'W' | 'R' << 8 | 'A' << 16 | 'P' << 24:
     return 69;
     break;
+  case 'S' | 'E' << 8 | 'N' << 16 | 'D' << 24:
+    return 70;
+    break;
+  case 'F' | 'X' << 8 | 'D' << 16 | 'T' << 24:
+    return 71;
+    break;
+  case 'F' | 'X' << 8 | 'F' << 16 | 'B' << 24:
+    return 72;
+    break;
+  case 'F' | 'X' << 8 | 'R' << 16 | 'V' << 24:
+    return 73;
+    break;
+  case 'E' | 'N' << 8 | 'V' << 16 | 'L' << 24:
+    return 74;
+    break;
+  case 'L' | 'F' << 8 | 'O' << 16 | ' ' << 24:
+    return 75;
+    break;
+  case 'E' | 'M' << 8 | 'O' << 16 | 'D' << 24:
+    return 76;
+    break;
   default:
     return 255;
   }
@@ -20,6 +20,14 @@ bool AudioDriver::Init() {
   };
   isPlaying_ = false;
 
+  requested_ = delivered_ = 0;
+  depth_ = (SOUND_BUFFER_COUNT + AUDIO_DEPTH_MIN) / 2;
+  underruns_ = overruns_ = 0;
+  overrunsSeen_ = 0;
+  starved_ = false;
+  lowWater_ = depth_;
+  window_ = 0;
+
   return InitDriver();
 }
 
@@ -45,17 +53,21 @@ void AudioDriver::Stop() {
 void AudioDriver::AddBuffer(short *buffer, int samplecount) {
   int len = samplecount * 2 * sizeof(short);
 
-  if (!isPlaying_)
+  if (!isPlaying_) {
+    delivered_++;
     return;
+  }
 
   if (len > SOUND_BUFFER_MAX) {
     Trace::Error("Alert: buffer size exceeded");
   }
 
+  // The ring is full: the renderer is ahead of what we want queued, so drop
+  // the buffer. adaptDepth sees the overrun and brings the depth down
+
   if (!pool_[poolQueuePosition_].empty_) {
-    NInvalid;
-    Trace::Error("Audio overrun, please report");
-    pool_[poolQueuePosition_].empty_ = true;
+    overruns_++;
+    delivered_++;
     return;
   }
 
@@ -64,6 +76,54 @@ void AudioDriver::AddBuffer(short *buffer, int samplecount) {
   pool_[poolQueuePosition_].empty_ = false;
   poolQueuePosition_ = (poolQueuePosition_ + 1) % SOUND_BUFFER_COUNT;
   hasData_ = true;
+  delivered_++;
+}
+
+// Grow the depth once per gap, and shrink it after an overrun or when the
+// number of ready buffers never went below two during a whole window. This
+// is the only place depth_ changes, so the renderer core never writes it
+
+void AudioDriver::adaptDepth(int queued) {
+  int overruns = overruns_;
+  if (overruns != overrunsSeen_) {
+    overrunsSeen_ = overruns;
+    if (depth_ > AUDIO_DEPTH_MIN) {
+      depth_--;
+    }
+  }
+  if (queued == 0) {
+    if (!starved_) {
+      underruns_++;
+      if (depth_ < SOUND_BUFFER_COUNT) {
+        depth_++;
+      }
+      starved_ = true;
+    }
+    lowWater_ = 0;
+    window_ = 0;
+    return;
+  }
+  starved_ = false;
+  if (queued < lowWater_) {
+    lowWater_ = queued;
+  }
+  if (++window_ == AUDIO_DEPTH_WINDOW) {
+    if ((lowWater_ > 1) && (depth_ > AUDIO_DEPTH_MIN)) {
+      depth_--;
+    }
+    lowWater_ = depth_;
+    window_ = 0;
+  }
+}
+
+int AudioDriver::queuedBuffers() {
+  int count = 0;
+  for (int i = 0; i < SOUND_BUFFER_COUNT; i++) {
+    if (!pool_[i].empty_) {
+      count++;
+    }
+  }
+  return count;
 }
 
 void AudioDriver::OnNewBufferNeeded() {
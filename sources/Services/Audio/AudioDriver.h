@@ -4,8 +4,22 @@
 #include "AudioSettings.h"
 #include "Foundation/Observable.h"
 
+#if defined(AUDIO_BLOCK_SIZE)
+// Fixed block mode: every buffer is exactly AUDIO_BLOCK_SIZE samples and
+// sequencer slices are scheduled inside the blocks (see AudioOutDriver)
+#if (AUDIO_BLOCK_SIZE != 64) && (AUDIO_BLOCK_SIZE != 128) &&                   \
+    (AUDIO_BLOCK_SIZE != 256)
+#error "AUDIO_BLOCK_SIZE must be 64, 128 or 256"
+#endif
 #ifndef PICOBUILD
 #define SOUND_BUFFER_COUNT 50
+#else
+#define SOUND_BUFFER_COUNT 8
+#endif
+#define SOUND_BUFFER_MAX (AUDIO_BLOCK_SIZE * 2 * int(sizeof(short)))
+#define MAX_SAMPLE_COUNT AUDIO_BLOCK_SIZE
+#elif !defined(PICOBUILD)
+#define SOUND_BUFFER_COUNT 50
 #define SOUND_BUFFER_MAX 20000
 #define MAX_SAMPLE_COUNT 5000
 #else
@@ -14,6 +28,16 @@
 #define MAX_SAMPLE_COUNT 1875
 #endif
 
+// Size of the buffer ring. The driver only keeps part of it in use (the
+// depth, counting the buffer being played), which grows after underruns and
+// shrinks back once playback has been stable for AUDIO_DEPTH_WINDOW buffers
+#ifdef AUDIO_BUFFER_COUNT
+#undef SOUND_BUFFER_COUNT
+#define SOUND_BUFFER_COUNT AUDIO_BUFFER_COUNT
+#endif
+#define AUDIO_DEPTH_MIN 2
+#define AUDIO_DEPTH_WINDOW 1024
+
 struct AudioBufferData {
   char buffer_[MAX_SAMPLE_COUNT * 2 * sizeof(short)];
   int size_ ;
@@ -26,7 +50,7 @@ class AudioDriver : public Observable {
 public:
   class Event : public I_ObservableData {
   public:
-    enum Type { ADET_DRIVERTICK, ADET_BUFFERNEEDED };
+    enum Type { ADET_DRIVERTICK, ADET_BUFFERNEEDED, ADET_SLICE };
 
     Event(Type type) { type_ = type; };
     Type type_;
@@ -57,10 +81,20 @@ public:
 
   void OnNewBufferNeeded();
 
+  // Buffer telemetry, safe to read from any core
+  int GetBufferDepth() { return depth_; };
+  int GetUnderrunCount() { return underruns_; };
+  int GetOverrunCount() { return overruns_; };
+
 protected:
   void eatBuffer(void *buffer, int size); // size in bytes
   void onAudioBufferTick();
   bool hasData();
+  // Called by the driver each time it picks the next buffer to play, with
+  // the number of buffers that were ready (0 means it played silence)
+  void adaptDepth(int queued);
+  int queuedBuffers();
+  int pendingBuffers() { return int(requested_ - delivered_); };
   AudioSettings settings_;
 
 protected:
@@ -71,5 +105,17 @@ protected:
   int bufferPos_;
   int bufferSize_;
   bool hasData_;
+
+  // Buffers asked from the renderer and buffers it handed back. Each one is
+  // only written by one side so they can be compared across cores
+  volatile unsigned int requested_;
+  volatile unsigned int delivered_;
+  volatile int depth_;
+  volatile int underruns_;
+  volatile int overruns_;
+  int overrunsSeen_; // overruns already taken into account by adaptDepth
+  bool starved_;
+  int lowWater_;
+  int window_;
 };
 #endif
@@ -1,12 +1,19 @@
 #include "AudioMixer.h"
+#include "System/Console/Trace.h"
 #include "System/System/System.h"
+#include <math.h>
 
 fixed AudioMixer::renderBuffer_[MAX_SAMPLE_COUNT * 2];
+bool AudioMixer::metering_ = false;
+unsigned long AudioMixer::meterMicros_ = 0;
+int AudioMixer::renderCheck_ = -1;
 
 AudioMixer::AudioMixer(const char *name)
     : T_SimpleList<AudioModule>(false), enableRendering_(0), writer_(0),
-      name_(name) {
+      renderMicros_(0), name_(name) {
   volume_ = (i2fp(1));
+  peak_[0] = peak_[1] = 0;
+  rms_[0] = rms_[1] = 0;
 };
 
 AudioMixer::~AudioMixer() {}
@@ -21,16 +28,52 @@ void AudioMixer::EnableRendering(bool enable) {
 
   if (enable) {
     writer_ = new WavFileWriter(renderPath_.c_str());
+    renderMicros_ = 0;
+    if (renderCheck_ >= 0) {
+      std::string refPath = renderPath_;
+      size_t ext = refPath.rfind(".wav");
+      refPath.insert((ext != std::string::npos) ? ext : refPath.size(),
+                     ".ref");
+      writer_->SetReference(refPath.c_str());
+    }
   }
 
   enableRendering_ = enable;
   if (!enable) {
     writer_->Close();
+    reportRender();
     SAFE_DELETE(writer_);
   }
 };
 
-bool AudioMixer::Render(fixed *buffer, int samplecount) {
+void AudioMixer::SetRenderCheck(int tolerance) { renderCheck_ = tolerance; }
+
+void AudioMixer::reportRender() {
+
+  Trace::Log("RENDER", "%s: %d samples in %lu ms, checksum %08X",
+             renderPath_.c_str(), writer_->GetSampleCount(),
+             renderMicros_ / 1000, writer_->GetChecksum());
+
+  if (renderCheck_ < 0)
+    return;
+
+  if (!writer_->HasReference()) {
+    Trace::Log("RENDER", "%s: no reference render to compare with",
+               renderPath_.c_str());
+  } else if (writer_->GetMaxDifference() > renderCheck_) {
+    Trace::Error("%s differs from reference (max difference %d > %d)",
+                 renderPath_.c_str(), writer_->GetMaxDifference(),
+                 renderCheck_);
+  } else {
+    Trace::Log("RENDER", "%s matches reference (max difference %d)",
+               renderPath_.c_str(), writer_->GetMaxDifference());
+  }
+}
+
+AUDIO_FUNC bool AudioMixer::Render(fixed *buffer, int samplecount) {
+
+  bool timed = enableRendering_ && writer_;
+  unsigned long start = timed ? System::GetInstance()->GetMicros() : 0;
 
   bool gotData = false;
   IteratorPtr<AudioModule> it(GetIterator());
@@ -52,15 +95,18 @@ bool AudioMixer::Render(fixed *buffer, int samplecount) {
     }
   }
 
-  //  Aplply volume
+  // Volume and metering share the last pass over the buffer. Metering time
+  // is kept so its cost shows up in the render budget
 
-  if (gotData) {
+  if (metering_) {
+    unsigned long meterStart = System::GetInstance()->GetMicros();
+    scaleAndMeter(gotData ? buffer : 0, samplecount);
+    meterMicros_ += System::GetInstance()->GetMicros() - meterStart;
+  } else if (gotData && (volume_ != i2fp(1))) {
     fixed *c = buffer;
-    if (volume_ != i2fp(1)) {
-      for (int i = 0; i < samplecount * 2; i++) {
-        fixed v = fp_mul(*c, volume_);
-        *c++ = v;
-      }
+    for (int i = 0; i < samplecount * 2; i++) {
+      fixed v = fp_mul(*c, volume_);
+      *c++ = v;
     }
   }
   if (enableRendering_ && writer_) {
@@ -69,7 +115,57 @@ bool AudioMixer::Render(fixed *buffer, int samplecount) {
     };
     writer_->AddBuffer(buffer, samplecount);
   }
+  if (timed) {
+    renderMicros_ += System::GetInstance()->GetMicros() - start;
+  }
   return gotData;
 };
 
 void AudioMixer::SetVolume(fixed volume) { volume_ = volume; }
+
+void AudioMixer::EnableMetering(bool enable) { metering_ = enable; }
+
+int AudioMixer::GetPeak(int channel) { return peak_[channel]; }
+
+int AudioMixer::GetRms(int channel) { return rms_[channel]; }
+
+unsigned long AudioMixer::GetMeterTime() { return meterMicros_; }
+
+AUDIO_FUNC void AudioMixer::scaleAndMeter(fixed *buffer, int samplecount) {
+
+  int peak[2] = {0, 0};
+  unsigned long long sum[2] = {0, 0};
+
+  // Squares are summed unscaled on 64 bits so quiet samples still count
+  // towards the RMS and loud buffers can't overflow
+
+  if (buffer) {
+    bool scale = (volume_ != i2fp(1));
+    fixed *p = buffer;
+    for (int i = 0; i < samplecount; i++) {
+      if (scale) {
+        p[0] = fp_mul(p[0], volume_);
+        p[1] = fp_mul(p[1], volume_);
+      }
+      int l = fp2i(*p++);
+      int r = fp2i(*p++);
+      l = (l < 0) ? -l : l;
+      r = (r < 0) ? -r : r;
+      l = (l > 32767) ? 32767 : l;
+      r = (r > 32767) ? 32767 : r;
+      peak[0] = (l > peak[0]) ? l : peak[0];
+      peak[1] = (r > peak[1]) ? r : peak[1];
+      sum[0] += (unsigned int)(l * l);
+      sum[1] += (unsigned int)(r * r);
+    }
+  }
+
+  // Peaks fall back slowly so short transients stay visible until the
+  // display gets to them
+
+  for (int c = 0; c < 2; c++) {
+    int decayed = peak_[c] - (peak_[c] >> 3);
+    peak_[c] = (peak[c] > decayed) ? peak[c] : decayed;
+    rms_[c] = (samplecount > 0) ? int(sqrtf(float(sum[c]) / samplecount)) : 0;
+  }
+}
@@ -16,12 +16,38 @@ public:
   void EnableRendering(bool enable);
   void SetVolume(fixed volume);
 
+  // Level metering. Peak and RMS of the last rendered buffer are published
+  // by the audio thread and can be read at any time from the UI (0..32767).
+  // Nothing is computed unless metering is enabled. The time spent metering
+  // adds up across all mixers (in us, wraps around)
+
+  static void EnableMetering(bool enable);
+  int GetPeak(int channel);
+  int GetRms(int channel);
+  static unsigned long GetMeterTime();
+
+  // When set (>=0), file renders are compared against a previous render
+  // stored next to them with a .ref.wav extension. Renders whose samples
+  // all stay within tolerance of the reference are reported as matching
+
+  static void SetRenderCheck(int tolerance);
+
+protected:
+  void scaleAndMeter(fixed *buffer, int samplecount);
+  void reportRender();
+  static bool metering_;
+  static unsigned long meterMicros_;
+  static int renderCheck_;
+
 private:
   bool enableRendering_;
   std::string renderPath_;
   WavFileWriter *writer_;
+  unsigned long renderMicros_;
   fixed volume_;
   std::string name_;
+  volatile int peak_[2];
+  volatile int rms_[2];
 
   static fixed renderBuffer_[MAX_SAMPLE_COUNT * 2];
 };
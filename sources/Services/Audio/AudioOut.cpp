@@ -1,7 +1,11 @@
 #include "AudioOut.h"
 #include "Application/Player/SyncMaster.h"
+#include <string.h>
 
-AudioOut::AudioOut() : AudioMixer("AudioOut"), sampleOffset_(0){};
+AudioOut::AudioOut() : AudioMixer("AudioOut"), sampleOffset_(0) {
+  memset(scope_, 0, sizeof(scope_));
+  scopeFront_ = 0;
+};
 
 AudioOut::~AudioOut(){};
 
@@ -10,4 +14,7 @@ int AudioOut::getPlaySampleCount() {
   int count = int(sampleOffset_);
   sampleOffset_ -= count;
   return count;
-};
\ No newline at end of file
+};
+void AudioOut::GetScope(short *dst) {
+  memcpy(dst, scope_[scopeFront_], SCOPE_SIZE * sizeof(short));
+}
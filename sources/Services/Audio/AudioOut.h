@@ -7,7 +7,9 @@
 
 class AudioDriver;
 
-#ifndef PICOBUILD
+#define SCOPE_SIZE 32
+
+#if !defined(PICOBUILD) && !defined(AUDIO_BLOCK_SIZE)
 #define MIX_BUFFER_SIZE 40000
 #else
 #define MIX_BUFFER_SIZE (MAX_SAMPLE_COUNT * 2)
@@ -28,6 +30,9 @@ public:
 
   virtual bool Clipped() = 0;
 
+  // Samples in the last buffer Trigger rendered, zero if unknown
+  virtual int GetSampleCount() { return 0; };
+
   virtual int GetPlayedBufferPercentage() = 0;
 
   virtual std::string GetAudioAPI() = 0;
@@ -38,12 +43,26 @@ public:
 
   virtual double GetStreamTime() = 0;
 
+  // Buffer queue telemetry, zero when the output has no buffer queue
+  virtual int GetBufferDepth() { return 0; };
+  virtual int GetUnderrunCount() { return 0; };
+  virtual int GetOverrunCount() { return 0; };
+
+  // Copies the last published scope trace (mono, SCOPE_SIZE points)
+  void GetScope(short *dst);
+
 protected:
   // write here the part that gets the float sample size
   // and computes accumulated integer count
 
   int getPlaySampleCount();
 
+  // Scope trace is double buffered: the audio thread fills the back buffer
+  // and flips scopeFront_ once it's complete
+
+  short scope_[2][SCOPE_SIZE];
+  volatile int scopeFront_;
+
 private:
   float sampleOffset_;
 };
@@ -26,6 +26,9 @@ void AudioOutDriver::Close() { driver_->Close(); }
 bool AudioOutDriver::Start() {
   clipped_ = false;
   sampleCount_ = 0;
+#ifdef AUDIO_BLOCK_SIZE
+  sliceRemaining_ = 0;
+#endif
   return driver_->Start();
 }
 
@@ -33,9 +36,15 @@ void AudioOutDriver::Stop() { driver_->Stop(); }
 
 bool AudioOutDriver::Clipped() { return clipped_; };
 
-void AudioOutDriver::Trigger() {
+int AudioOutDriver::GetSampleCount() { return sampleCount_; };
+
+AUDIO_FUNC void AudioOutDriver::Trigger() {
   prepareMixBuffers();
+#ifdef AUDIO_BLOCK_SIZE
+  renderBlock();
+#else
   hasSound_ = AudioMixer::Render(primarySoundBuffer_, sampleCount_);
+#endif
   clipToMix();
   driver_->AddBuffer(mixBuffer_, sampleCount_);
 }
@@ -46,16 +55,52 @@ void AudioOutDriver::Update(Observable &o, I_ObservableData *d) {
 }
 
 void AudioOutDriver::prepareMixBuffers() {
+#ifdef AUDIO_BLOCK_SIZE
+  sampleCount_ = AUDIO_BLOCK_SIZE;
+#else
   sampleCount_ = getPlaySampleCount();
+#endif
   clipped_ = false;
 };
 
-void AudioOutDriver::clipToMix() {
+#ifdef AUDIO_BLOCK_SIZE
+// Slices and blocks don't line up: whenever a slice ends inside the block,
+// observers are told to run the next one and the block is rendered in
+// pieces so every slice starts at its own sample offset
+
+AUDIO_FUNC void AudioOutDriver::renderBlock() {
+  hasSound_ = false;
+  int done = 0;
+  while (done < sampleCount_) {
+    if (sliceRemaining_ <= 0) {
+      sliceRemaining_ = getPlaySampleCount();
+      AudioDriver::Event event(AudioDriver::Event::ADET_SLICE);
+      SetChanged();
+      NotifyObservers(&event);
+    }
+    int count = MIN(sliceRemaining_, sampleCount_ - done);
+    fixed *buffer = primarySoundBuffer_ + 2 * done;
+    if (AudioMixer::Render(buffer, count)) {
+      hasSound_ = true;
+    } else {
+      SYS_MEMSET(buffer, 0, count * 2 * sizeof(fixed));
+    }
+    done += count;
+    sliceRemaining_ -= count;
+  }
+}
+#endif
+
+AUDIO_FUNC void AudioOutDriver::clipToMix() {
 
   bool interlaced = driver_->Interlaced();
 
   if (!hasSound_) {
     SYS_MEMSET(mixBuffer_, 0, sampleCount_ * 2 * sizeof(short));
+    if (metering_) {
+      SYS_MEMSET(scope_[scopeFront_ ^ 1], 0, SCOPE_SIZE * sizeof(short));
+      scopeFront_ ^= 1;
+    }
   } else {
     short *s1 = mixBuffer_;
     short *s2 = (interlaced) ? s1 + 1 : s1 + sampleCount_;
@@ -67,6 +112,17 @@ void AudioOutDriver::clipToMix() {
     fixed f_32767 = i2fp(32767);
     fixed f_m32768 = i2fp(-32768);
 
+    // Pick one point every scopeStep samples for the scope trace. When
+    // metering is off the countdown never reaches zero
+
+    int scopeStep = sampleCount_ / SCOPE_SIZE;
+    if ((!metering_) || (scopeStep == 0)) {
+      scopeStep = sampleCount_ + 1;
+    }
+    int scopeCount = scopeStep;
+    int scopePos = 0;
+    short *scope = scope_[scopeFront_ ^ 1];
+
     for (int i = 0; i < sampleCount_; i++) {
       // Left
       v = *p++;
@@ -78,7 +134,6 @@ void AudioOutDriver::clipToMix() {
         clipped_ = true;
       }
       *s1 = short(fp2i(v));
-      s1 += offset;
 
       // Right
       v = *p++;
@@ -90,8 +145,19 @@ void AudioOutDriver::clipToMix() {
         clipped_ = true;
       }
       *s2 = short(fp2i(v));
+
+      if (--scopeCount == 0) {
+        scopeCount = scopeStep;
+        if (scopePos < SCOPE_SIZE) {
+          scope[scopePos++] = short((int(*s1) + int(*s2)) >> 1);
+        }
+      }
+      s1 += offset;
       s2 += offset;
     };
+    if (scopePos == SCOPE_SIZE) {
+      scopeFront_ ^= 1;
+    }
   }
 };
 
@@ -126,3 +192,11 @@ int AudioOutDriver::GetAudioPreBufferCount() {
   return as.preBufferCount_;
 };
 double AudioOutDriver::GetStreamTime() { return driver_->GetStreamTime(); };
+
+int AudioOutDriver::GetBufferDepth() { return driver_->GetBufferDepth(); };
+
+int AudioOutDriver::GetUnderrunCount() {
+  return driver_->GetUnderrunCount();
+};
+
+int AudioOutDriver::GetOverrunCount() { return driver_->GetOverrunCount(); };
@@ -22,6 +22,8 @@ public:
 
   virtual bool Clipped();
 
+  virtual int GetSampleCount();
+
   virtual int GetPlayedBufferPercentage();
 
   AudioDriver *GetDriver();
@@ -32,11 +34,17 @@ public:
   virtual int GetAudioRequestedBufferSize();
   virtual int GetAudioPreBufferCount();
   virtual double GetStreamTime();
+  virtual int GetBufferDepth();
+  virtual int GetUnderrunCount();
+  virtual int GetOverrunCount();
 
 protected:
   virtual void Update(Observable &o, I_ObservableData *d);
 
   void prepareMixBuffers();
+#ifdef AUDIO_BLOCK_SIZE
+  void renderBlock();
+#endif
   void mixToPrimary();
   void clipToMix();
 
@@ -48,5 +56,8 @@ private:
   static fixed primarySoundBuffer_[MIX_BUFFER_SIZE];
   static short mixBuffer_[MIX_BUFFER_SIZE];
   int sampleCount_;
+#ifdef AUDIO_BLOCK_SIZE
+  int sliceRemaining_; // samples left in the current sequencer slice
+#endif
 };
 #endif
@@ -3,7 +3,7 @@
 
 #include "ControllerSource.h"
 
-#define MAX_KEY 400
+#define MAX_KEY 512
 
 class KeyboardControllerSource : public ControllerSource {
 public:
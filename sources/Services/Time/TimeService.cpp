@@ -1,7 +1,8 @@
 #include "TimeService.h"
 #include "System/System/System.h"
 #ifndef PICOBUILD
-#include "SDL/SDL.h"
+#include <chrono>
+#include <thread>
 #else
 #include "pico/stdlib.h"
 #endif
@@ -43,7 +44,7 @@ Time TimeService::GetTime() {
 
 void TimeService::Sleep(int msecs) {
 #ifndef PICOBUILD
-  SDL_Delay(msecs);
+  std::this_thread::sleep_for(std::chrono::milliseconds(msecs));
 #else
   sleep_ms(msecs);
 #endif
@@ -14,7 +14,7 @@ SysMutex::SysMutex() : mutex_(0) {}
 SysMutex::~SysMutex() {
 #ifndef PICOBUILD
   if (mutex_) {
-    SDL_DestroyMutex(mutex_);
+    delete mutex_;
     mutex_ = NULL;
   }
 #endif
@@ -23,10 +23,10 @@ SysMutex::~SysMutex() {
 bool SysMutex::Lock() {
 #ifndef PICOBUILD
   if (!mutex_) {
-    mutex_ = SDL_CreateMutex();
+    mutex_ = new std::mutex();
   }
   if (mutex_) {
-    SDL_LockMutex(mutex_);
+    mutex_->lock();
     return true;
   }
 #else
@@ -44,7 +44,7 @@ bool SysMutex::Lock() {
 void SysMutex::Unlock() {
   if (mutex_) {
 #ifndef PICOBUILD
-    SDL_UnlockMutex(mutex_);
+    mutex_->unlock();
 #else
     mutex_exit(mutex_);
 #endif
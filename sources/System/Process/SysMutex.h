@@ -8,7 +8,7 @@
  */
 
 #ifndef PICOBUILD
-#include <SDL/SDL.h>
+#include <mutex>
 #else
 #include "pico/mutex.h"
 #endif
@@ -22,7 +22,7 @@ public:
 
 private:
 #ifndef PICOBUILD
-  SDL_mutex *mutex_;
+  std::mutex *mutex_;
 #else
   mutex_t *mutex_;
 #endif
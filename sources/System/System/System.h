@@ -9,6 +9,7 @@ class System : public T_Factory<System> {
 
 public:                                 // Override in implementation
   virtual unsigned long GetClock() = 0; // millisecs
+  virtual unsigned long GetMicros() { return GetClock() * 1000; };
   virtual int GetBatteryLevel() = 0;
   virtual void *Malloc(unsigned size) = 0;
   virtual void Free(void *) = 0;
@@ -42,4 +43,18 @@ public:                                 // Override in implementation
     ptr = 0;                                                                   \
   }
 
+// With AUDIO_IN_RAM, the audio render path runs from SRAM instead of going
+// through the XIP cache it would otherwise share with flash samples.
+// AUDIO_FUNC goes in front of function definitions, AUDIO_TABLE in front of
+// the constant tables they read
+
+#if defined(PICOBUILD) && defined(AUDIO_IN_RAM)
+#include "pico/platform.h"
+#define AUDIO_FUNC __not_in_flash("audio")
+#define AUDIO_TABLE __not_in_flash("audio_tables")
+#else
+#define AUDIO_FUNC
+#define AUDIO_TABLE
+#endif
+
 #endif